@@ -0,0 +1,320 @@
+/*
+ * File:   AdaptiveWavePropagation.cpp
+ *
+ * 1D wave propagation with block-structured adaptive mesh refinement.
+ */
+
+#include "AdaptiveWavePropagation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+AdaptiveWavePropagation::AdaptiveWavePropagation(scenarios::Scenario<T> &scenario, unsigned int blockSize, unsigned int maxLevel,
+        T refineThreshold, T coarsenThreshold)
+    : m_blockSize(blockSize), m_maxLevel(maxLevel), m_rootBlocks(blockSize > 0 ? scenario.getSize() / blockSize : 0),
+      m_cellSize(scenario.getCellSize()),
+      m_refineThreshold(refineThreshold), m_coarsenThreshold(coarsenThreshold), m_finestLevel(0), m_edgeUpdates(0)
+{
+    if (blockSize == 0 || scenario.getSize() == 0 || scenario.getSize() % blockSize != 0)
+    {
+        std::cerr << "The size " << scenario.getSize() << " is not a multiple of the block size " << blockSize << std::endl;
+        m_rootBlocks = 0;
+        return;
+    }
+
+    unsigned long size = m_rootBlocks * m_blockSize;
+    m_h.resize(size + 2);
+    m_hu.resize(size + 2);
+    m_rootBathymetry.resize(size + 2);
+    scenario.fill(&m_h[0], &m_hu[0], &m_rootBathymetry[0], 0, size + 2);
+    for (unsigned long i = 0; i < m_rootBlocks; i++)
+    {
+        Block block = {0, i};
+        m_blocks.push_back(block);
+    }
+    updateGrid();
+
+    // every adaption refines by at most one level
+    for (unsigned int level = 0; level < m_maxLevel; level++)
+        if (!adapt())
+            break;
+}
+
+void AdaptiveWavePropagation::setOutflowBoundaryConditions()
+{
+    const unsigned long last = getNumberOfCells() + 1;
+    m_h[0] = m_h[1];
+    m_hu[0] = m_hu[1];
+    m_h[last] = m_h[last - 1];
+    m_hu[last] = m_hu[last - 1];
+}
+
+T AdaptiveWavePropagation::computeJump(unsigned int block) const
+{
+    const unsigned long first = 1 + (unsigned long) block * m_blockSize;
+    T jump = 0;
+    for (unsigned long i = first - 1; i < first + m_blockSize; i++)
+    {
+        // the surface instead of the height, so steps of the bathymetry at rest are not refined
+        T hLeft = m_h[i], hRight = m_h[i + 1];
+        T edgeJump = hLeft > 0 && hRight > 0 ? std::abs(hRight + m_b[i + 1] - hLeft - m_b[i]) : std::abs(hRight - hLeft);
+        T hMax = std::max(hLeft, hRight);
+        if (hMax > 0)
+            edgeJump += std::abs(m_hu[i + 1] - m_hu[i]) / std::sqrt((T) g * hMax);
+        jump = std::max(jump, edgeJump);
+    }
+    return jump;
+}
+
+bool AdaptiveWavePropagation::adapt()
+{
+    setOutflowBoundaryConditions();
+    const unsigned int numberOfBlocks = m_blocks.size();
+    std::vector<T> jumps(numberOfBlocks);
+    std::vector<unsigned int> targets(numberOfBlocks);
+    for (unsigned int k = 0; k < numberOfBlocks; k++)
+    {
+        unsigned int level = m_blocks[k].level;
+        jumps[k] = computeJump(k);
+        targets[k] = level;
+        if (jumps[k] > m_refineThreshold && level < m_maxLevel)
+            targets[k] = level + 1;
+        else if (jumps[k] < m_coarsenThreshold && level > 0)
+            targets[k] = level - 1;
+    }
+    // a buffer of one block around a front, which is refined at least one level per adaption as well
+    for (unsigned int k = 0; k < numberOfBlocks; k++)
+    {
+        if (jumps[k] <= m_refineThreshold)
+            continue;
+        if (k > 0)
+            targets[k - 1] = std::max(targets[k - 1], std::min(targets[k], m_blocks[k - 1].level + 1));
+        if (k + 1 < numberOfBlocks)
+            targets[k + 1] = std::max(targets[k + 1], std::min(targets[k], m_blocks[k + 1].level + 1));
+    }
+
+    std::vector<Block> blocks;
+    std::vector<T> h(1), hu(1);
+    blocks.reserve(2 * numberOfBlocks);
+    h.reserve(2 * m_h.size());
+    hu.reserve(2 * m_h.size());
+    bool changed = false;
+    for (unsigned int k = 0; k < numberOfBlocks;)
+    {
+        const Block &block = m_blocks[k];
+        const unsigned long first = 1 + (unsigned long) k * m_blockSize;
+        // two siblings are merged if both want to and their new level fits to the neighbours
+        if (targets[k] < block.level && block.index % 2 == 0 && k + 1 < numberOfBlocks && m_blocks[k + 1].level == block.level
+                && targets[k + 1] < block.level && (k == 0 || targets[k - 1] <= block.level)
+                && (k + 2 >= numberOfBlocks || targets[k + 2] <= block.level))
+        {
+            Block merged = {block.level - 1, block.index / 2};
+            blocks.push_back(merged);
+            for (unsigned long i = first; i < first + 2 * m_blockSize; i += 2)
+            {
+                h.push_back((T) 0.5 * (m_h[i] + m_h[i + 1]));
+                hu.push_back((T) 0.5 * (m_hu[i] + m_hu[i + 1]));
+            }
+            changed = true;
+            k += 2;
+        }
+        else
+        {
+            blocks.push_back(block);
+            h.insert(h.end(), m_h.begin() + first, m_h.begin() + first + m_blockSize);
+            hu.insert(hu.end(), m_hu.begin() + first, m_hu.begin() + first + m_blockSize);
+            if (targets[k] > block.level)
+            {
+                split(blocks, h, hu, blocks.size() - 1);
+                changed = true;
+            }
+            k++;
+        }
+    }
+    if (!changed)
+        return false;
+
+    // neighbouring blocks differ by at most one level, the coarser one is split until they do
+    for (bool balanced = false; !balanced;)
+    {
+        balanced = true;
+        for (unsigned int k = 0; k + 1 < blocks.size(); k++)
+        {
+            if (blocks[k].level > blocks[k + 1].level + 1)
+                split(blocks, h, hu, k + 1);
+            else if (blocks[k + 1].level > blocks[k].level + 1)
+                split(blocks, h, hu, k);
+            else
+                continue;
+            balanced = false;
+        }
+    }
+
+    h.push_back(0);
+    hu.push_back(0);
+    m_blocks.swap(blocks);
+    m_h.swap(h);
+    m_hu.swap(hu);
+    updateGrid();
+    return true;
+}
+
+void AdaptiveWavePropagation::split(std::vector<Block> &blocks, std::vector<T> &h, std::vector<T> &hu, unsigned int block) const
+{
+    Block left = {blocks[block].level + 1, 2 * blocks[block].index};
+    Block right = {left.level, left.index + 1};
+    blocks[block] = left;
+    blocks.insert(blocks.begin() + block + 1, right);
+
+    // every cell is replaced by two cells with the same values
+    const unsigned long first = 1 + (unsigned long) block * m_blockSize;
+    std::vector<T> hFine(2 * m_blockSize), huFine(2 * m_blockSize);
+    for (unsigned long i = 0; i < 2 * m_blockSize; i++)
+    {
+        hFine[i] = h[first + i / 2];
+        huFine[i] = hu[first + i / 2];
+    }
+    std::copy(hFine.begin(), hFine.begin() + m_blockSize, h.begin() + first);
+    std::copy(huFine.begin(), huFine.begin() + m_blockSize, hu.begin() + first);
+    h.insert(h.begin() + first + m_blockSize, hFine.begin() + m_blockSize, hFine.end());
+    hu.insert(hu.begin() + first + m_blockSize, huFine.begin() + m_blockSize, huFine.end());
+}
+
+void AdaptiveWavePropagation::updateGrid()
+{
+    const unsigned long size = getNumberOfCells();
+    m_b.resize(size + 2);
+    m_inverseCellSizes.resize(size + 2);
+    m_finestLevel = 0;
+    for (unsigned int k = 0; k < m_blocks.size(); k++)
+    {
+        const Block &block = m_blocks[k];
+        const T inverseCellSize = (T) (1ul << block.level) / m_cellSize;
+        for (unsigned long j = 0; j < m_blockSize; j++)
+        {
+            // the cell of level 0 which contains the refined cell
+            unsigned long root = ((block.index * m_blockSize + j) >> block.level);
+            m_b[1 + k * m_blockSize + j] = m_rootBathymetry[1 + root];
+            m_inverseCellSizes[1 + k * m_blockSize + j] = inverseCellSize;
+        }
+        m_finestLevel = std::max(m_finestLevel, block.level);
+    }
+    m_b[0] = m_rootBathymetry[0];
+    m_b[size + 1] = m_rootBathymetry.back();
+    m_inverseCellSizes[0] = m_inverseCellSizes[1];
+    m_inverseCellSizes[size + 1] = m_inverseCellSizes[size];
+
+    m_hNetUpdatesLeft.resize(size + 1);
+    m_hNetUpdatesRight.resize(size + 1);
+    m_huNetUpdatesLeft.resize(size + 1);
+    m_huNetUpdatesRight.resize(size + 1);
+
+    // an edge belongs to the finer of its two cells
+    m_runs.clear();
+    for (unsigned long i = 0; i <= size; i++)
+    {
+        unsigned int leftLevel = m_blocks[i > 0 ? (i - 1) / m_blockSize : 0].level;
+        unsigned int rightLevel = m_blocks[i < size ? i / m_blockSize : m_blocks.size() - 1].level;
+        unsigned int level = std::max(leftLevel, rightLevel);
+        if (m_runs.empty() || m_runs.back().level != level)
+        {
+            Run run = {i, i + 1, level};
+            m_runs.push_back(run);
+        }
+        else
+            m_runs.back().end = i + 1;
+    }
+}
+
+T AdaptiveWavePropagation::simulateMacroStep()
+{
+    if (!isValid())
+        return 0;
+    adapt();
+    setOutflowBoundaryConditions();
+    const unsigned long size = getNumberOfCells();
+    T maxEdgeSpeed;
+    m_solver.computeNetUpdates(&m_h[0], &m_hu[0], &m_b[0], 0, size + 1, &m_hNetUpdatesLeft[0], &m_hNetUpdatesRight[0],
+            &m_huNetUpdatesLeft[0], &m_huNetUpdatesRight[0], maxEdgeSpeed);
+    if (maxEdgeSpeed == 0)
+        return 0;
+
+    // the time step of level 0, level l is advanced 2^l times with dt / 2^l
+    T dt = 0.4 * m_cellSize / maxEdgeSpeed;
+    unsigned int subSteps = 1u << m_finestLevel;
+    for (unsigned int subStep = 0; subStep < subSteps; subStep++)
+    {
+        // all active edges are computed from the same state before any cell is updated,
+        // in the first sub step all edges are active and were computed with the time step
+        if (subStep > 0)
+        {
+            setOutflowBoundaryConditions();
+            for (unsigned int r = 0; r < m_runs.size(); r++)
+            {
+                const Run &run = m_runs[r];
+                if (subStep % (1u << (m_finestLevel - run.level)) != 0)
+                    continue;
+                m_solver.computeNetUpdates(&m_h[0], &m_hu[0], &m_b[0], run.begin, run.end, &m_hNetUpdatesLeft[0], &m_hNetUpdatesRight[0],
+                        &m_huNetUpdatesLeft[0], &m_huNetUpdatesRight[0], maxEdgeSpeed);
+            }
+        }
+
+        // both cells of an edge receive its net updates with the time step of the edge and their own size
+        for (unsigned int r = 0; r < m_runs.size(); r++)
+        {
+            const Run &run = m_runs[r];
+            if (subStep % (1u << (m_finestLevel - run.level)) != 0)
+                continue;
+            T edgeTimeStep = dt / (T) (1u << run.level);
+            const T *inverseCellSizes = &m_inverseCellSizes[0];
+            for (unsigned long i = run.begin; i < run.end; i++)
+            {
+                m_h[i] -= edgeTimeStep * inverseCellSizes[i] * m_hNetUpdatesLeft[i];
+                m_hu[i] -= edgeTimeStep * inverseCellSizes[i] * m_huNetUpdatesLeft[i];
+            }
+            for (unsigned long i = run.begin; i < run.end; i++)
+            {
+                m_h[i + 1] -= edgeTimeStep * inverseCellSizes[i + 1] * m_hNetUpdatesRight[i];
+                m_hu[i + 1] -= edgeTimeStep * inverseCellSizes[i + 1] * m_huNetUpdatesRight[i];
+            }
+            m_edgeUpdates += run.end - run.begin;
+        }
+    }
+
+    return dt;
+}
+
+double AdaptiveWavePropagation::getMass() const
+{
+    double mass = 0;
+    for (unsigned long i = 1; i <= getNumberOfCells(); i++)
+        mass += m_h[i] / m_inverseCellSizes[i];
+    return mass;
+}
+
+void AdaptiveWavePropagation::sample(unsigned long size, T *h, T *hu) const
+{
+    if (!isValid())
+    {
+        std::fill(h, h + size, (T) 0);
+        std::fill(hu, hu + size, (T) 0);
+        return;
+    }
+    // positions in units of the cells of level 0
+    const double length = (double) m_rootBlocks * m_blockSize;
+    unsigned int k = 0;
+    for (unsigned long u = 0; u < size; u++)
+    {
+        double x = (u + 0.5) * length / size;
+        // the blocks are sorted by their position
+        while (k + 1 < m_blocks.size()
+                && (double) m_blocks[k + 1].index * m_blockSize / (1ul << m_blocks[k + 1].level) <= x)
+            k++;
+        const Block &block = m_blocks[k];
+        double offset = (x - (double) block.index * m_blockSize / (1ul << block.level)) * (1ul << block.level);
+        unsigned long j = std::min<unsigned long>((unsigned long) offset, m_blockSize - 1);
+        h[u] = m_h[1 + k * m_blockSize + j];
+        hu[u] = m_hu[1 + k * m_blockSize + j];
+    }
+}
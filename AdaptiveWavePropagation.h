@@ -0,0 +1,186 @@
+/*
+ * File:   AdaptiveWavePropagation.h
+ *
+ * 1D wave propagation with block-structured adaptive mesh refinement.
+ */
+
+#ifndef _ADAPTIVEWAVEPROPAGATION_H
+#define	_ADAPTIVEWAVEPROPAGATION_H
+
+#include <vector>
+
+#include "types.h"
+#include "scenarios/scenario.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Refines the grid around the wave fronts and leaves the smooth parts of the domain coarse.
+ *
+ * The domain is covered by blocks of blockSize cells. A block of level l has cells of size
+ * cellSize / 2^l, refining a block replaces it by two blocks of the next level and coarsening
+ * merges two such blocks again. Neighbouring blocks differ by at most one level. The cells of all
+ * blocks are stored in one array in the order of their position, so the edges between blocks are
+ * computed like any other edge.
+ *
+ * Time stepping follows LocalTimeStepping: an edge belongs to the finer of its two cells, the
+ * edges of level l are computed with the time step dt / 2^l of their cells, where dt is the CFL time
+ * step of the unrefined grid. Both cells of an edge receive its net updates divided by their own
+ * size. A coarse cell next to a finer block thereby receives the sum of the fluxes of all fine sub
+ * steps (the flux correction at the coarse-fine interface), so the total mass is conserved.
+ *
+ * At the beginning of every macro step, the blocks are refined where the jump of the unknowns over
+ * an edge exceeds refineThreshold and coarsened where it is below coarsenThreshold. The jump is
+ * measured in metres: |(h + b)_r - (h + b)_l| + |hu_r - hu_l| / sqrt(g max(h_l, h_r)), with the
+ * heights instead of the surfaces next to dry cells. A shock keeps its jump on every level and is
+ * refined to maxLevel, a smooth wave stops at the level where the jump per cell becomes small
+ * enough. The neighbours of a refined front are refined as well, so the front cannot leave the fine
+ * blocks within one macro step. New fine cells copy the value of their coarse cell and merged cells
+ * take the mean of their fine cells, which conserves mass.
+ *
+ * The ghost cells are set to outflow boundary conditions before every sub step.
+ *
+ * The unrefined grid consists of whole blocks. A scenario whose size is not a positive multiple of
+ * blockSize is rejected instead of dropping the cells of an incomplete last block, see isValid().
+ */
+class AdaptiveWavePropagation
+{
+public:
+
+    /**
+     * Initializes the unrefined grid from a scenario and refines it up to maxLevel around the fronts.
+     *
+     * @param [in] scenario The scenario, its size must be a multiple of blockSize
+     * @param [in] blockSize The number of cells of a block
+     * @param [in] maxLevel The finest level, its cells are 2^maxLevel times smaller than the cells of the scenario
+     * @param [in] refineThreshold A block is refined if a jump in or next to it exceeds this height
+     * @param [in] coarsenThreshold Two blocks are merged if all jumps in and next to them are below this height
+     */
+    AdaptiveWavePropagation(scenarios::Scenario<T> &scenario, unsigned int blockSize = 16, unsigned int maxLevel = 3,
+            T refineThreshold = 0.05, T coarsenThreshold = 0.01);
+
+    /** @return False if the size of the scenario is not a positive multiple of blockSize */
+    bool isValid() const
+    {
+        return !m_blocks.empty();
+    }
+
+    /**
+     * Adapts the grid and advances all cells by one macro step.
+     *
+     * @return The time step of the macro step, 0 if the wave propagation is not valid or if no wave moves (all
+     *  cells are dry) and the cells stay unchanged
+     */
+    T simulateMacroStep();
+
+    /** @return The number of cells without the ghost cells */
+    unsigned long getNumberOfCells() const
+    {
+        return m_blocks.size() * m_blockSize;
+    }
+
+    /** @return The number of cells of a uniform grid with the resolution of the finest level */
+    unsigned long getNumberOfUniformCells() const
+    {
+        return m_rootBlocks * m_blockSize << m_maxLevel;
+    }
+
+    unsigned int getNumberOfBlocks() const
+    {
+        return m_blocks.size();
+    }
+
+    /** @return The finest level which occurs in the grid */
+    unsigned int getFinestLevel() const
+    {
+        return m_finestLevel;
+    }
+
+    /** @return The number of edges which were computed so far */
+    unsigned long getEdgeUpdates() const
+    {
+        return m_edgeUpdates;
+    }
+
+    /** @return The integral of h */
+    double getMass() const;
+
+    /**
+     * Samples the cells on a uniform grid, every uniform cell gets the value of the cell at its center.
+     * Without a valid grid, all values are 0.
+     *
+     * @param [in] size The number of uniform cells over the whole domain
+     * @param [out] h The heights of the uniform cells
+     * @param [out] hu The momentums of the uniform cells
+     */
+    void sample(unsigned long size, T *h, T *hu) const;
+
+private:
+
+    struct Block
+    {
+        unsigned int level;
+        /** The position of the block among the blocks of its level */
+        unsigned long index;
+    };
+
+    /**
+     * A contiguous range of edges of the same level.
+     */
+    struct Run
+    {
+        unsigned long begin;
+        unsigned long end;
+        unsigned int level;
+    };
+
+    void setOutflowBoundaryConditions();
+
+    /** @return The largest jump over the edges of a block, including the edges to its neighbours */
+    T computeJump(unsigned int block) const;
+
+    /**
+     * Refines and coarsens the blocks by at most one level.
+     *
+     * @return False if the grid did not change
+     */
+    bool adapt();
+
+    /** Splits the block at the given position into two blocks of the next level */
+    void split(std::vector<Block> &blocks, std::vector<T> &h, std::vector<T> &hu, unsigned int block) const;
+
+    /** Sets the bathymetry, the cell sizes and the runs of edges after the grid changed */
+    void updateGrid();
+
+    unsigned int m_blockSize;
+    unsigned int m_maxLevel;
+    unsigned long m_rootBlocks;
+    /** The size of the cells of level 0 */
+    T m_cellSize;
+    T m_refineThreshold;
+    T m_coarsenThreshold;
+
+    /** The bathymetry of the unrefined grid including the ghost cells */
+    std::vector<T> m_rootBathymetry;
+
+    std::vector<Block> m_blocks;
+    /** The unknowns of all blocks including one ghost cell on each side */
+    std::vector<T> m_h;
+    std::vector<T> m_hu;
+    std::vector<T> m_b;
+    /** The inverse of the size of every cell including the ghost cells */
+    std::vector<T> m_inverseCellSizes;
+
+    std::vector<T> m_hNetUpdatesLeft;
+    std::vector<T> m_hNetUpdatesRight;
+    std::vector<T> m_huNetUpdatesLeft;
+    std::vector<T> m_huNetUpdatesRight;
+
+    std::vector<Run> m_runs;
+    unsigned int m_finestLevel;
+
+    unsigned long m_edgeUpdates;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _ADAPTIVEWAVEPROPAGATION_H */
@@ -0,0 +1,85 @@
+/*
+ * File:   AdaptiveWavePropagationTest.h
+ *
+ * Tests of the adaptive mesh refinement.
+ */
+
+#ifndef _ADAPTIVEWAVEPROPAGATIONTEST_H
+#define	_ADAPTIVEWAVEPROPAGATIONTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <vector>
+#include "../scenarios/scenario.h"
+#include "../scenarios/extendeddambreak.h"
+#include "../scenarios/shockshock.h"
+#include "../AdaptiveWavePropagation.h"
+#include "../ReferenceWavePropagation.h"
+
+class AdaptiveWavePropagationTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief refinement, coarsening and the sub steps at coarse-fine interfaces conserve mass */
+    void testConservation()
+    {
+        // without inflow over the boundaries
+        scenarios::ExtendedDamBreak scenario(256, 14, 3.5, 0);
+        AdaptiveWavePropagation adaptive(scenario, 16, 3);
+        TS_ASSERT_EQUALS(adaptive.getFinestLevel(), 3u);
+        const double mass = adaptive.getMass();
+        for (int step = 0; step < 50; step++)
+        {
+            TS_ASSERT(adaptive.simulateMacroStep() > 0);
+            TS_ASSERT_DELTA(adaptive.getMass(), mass, 1e-5 * mass);
+            // only the surroundings of the two fronts are refined
+            TS_ASSERT(3 * adaptive.getNumberOfCells() < adaptive.getNumberOfUniformCells());
+        }
+        TS_ASSERT_EQUALS(adaptive.getFinestLevel(), 3u);
+    }
+
+    /** \brief a size which is not a multiple of the block size is rejected instead of being truncated */
+    void testInvalidBlockSize()
+    {
+        scenarios::ExtendedDamBreak scenario(250, 14, 3.5, 0);
+        AdaptiveWavePropagation adaptive(scenario, 16, 3);
+        TS_ASSERT(!adaptive.isValid());
+        TS_ASSERT_EQUALS(adaptive.getNumberOfCells(), 0u);
+        TS_ASSERT_EQUALS(adaptive.simulateMacroStep(), 0);
+        TS_ASSERT(!AdaptiveWavePropagation(scenario, 0).isValid());
+        TS_ASSERT(AdaptiveWavePropagation(scenario, 10).isValid());
+    }
+
+    /** \brief the refined grid is about as accurate as the uniform grid of the finest level */
+    void testAccuracy()
+    {
+        const unsigned int size = 256;
+        const unsigned int maxLevel = 3;
+        const unsigned int fineSize = size << maxLevel;
+        scenarios::ShockShock coarseScenario(size);
+        scenarios::ShockShock fineScenario(fineSize);
+        AdaptiveWavePropagation adaptive(coarseScenario, 16, maxLevel);
+        double time = 0;
+        for (int step = 0; step < 40; step++)
+            time += adaptive.simulateMacroStep();
+
+        ReferenceWavePropagation fine(fineScenario, fineSize), coarse(coarseScenario, size);
+        fine.simulateUntil(time);
+        coarse.simulateUntil(time);
+        const std::vector<T> &hFine = fine.getHeights(), &hCoarse = coarse.getHeights();
+        std::vector<T> h(fineSize), hu(fineSize);
+        adaptive.sample(fineSize, &h[0], &hu[0]);
+        double adaptiveError = 0, coarseError = 0;
+        for (unsigned int i = 0; i < fineSize; i++)
+        {
+            adaptiveError += std::abs(h[i] - hFine[i + 1]);
+            coarseError += std::abs(hCoarse[1 + (i >> maxLevel)] - hFine[i + 1]);
+        }
+        TS_ASSERT(coarseError > 0);
+        TS_ASSERT(adaptiveError < 0.1 * coarseError);
+        TS_ASSERT(2 * adaptive.getNumberOfCells() < fineSize);
+    }
+};
+
+#endif	/* _ADAPTIVEWAVEPROPAGATIONTEST_H */
@@ -0,0 +1,162 @@
+/*
+ * File:   CheckpointTest.h
+ *
+ * Tests of the checkpoint writer and reader.
+ */
+
+#ifndef _CHECKPOINTTEST_H
+#define	_CHECKPOINTTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <vector>
+#include "../solvers/FWave.hpp"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/rarerare.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../PolicyWavePropagation.h"
+#include "../io/Checkpoint.h"
+
+class CheckpointTest : public CxxTest::TestSuite
+{
+private:
+
+    /** \brief simulates the steps [state.step, lastStep) with the fused sweep and writes checkpoints */
+    void simulate(io::SimulationState &state, unsigned long lastStep, io::CheckpointWriter *writer, const scenarios::Scenario<T> &scenario)
+    {
+        solver::FWave<T> solver;
+        unsigned int size = state.cellCount - 2;
+        while (state.step < lastStep)
+        {
+            T dt = 0.4 * state.cellSize / state.maxEdgeSpeed;
+            solver.computeAndApplyNetUpdates(state.h, state.hu, 0, size, dt, state.cellSize, state.maxEdgeSpeed);
+            state.time += dt;
+            state.step++;
+            if (writer)
+                writer->checkpoint(state, scenario);
+        }
+    }
+
+public:
+
+    /** \brief interrupts a simulation after 15 of 30 steps and restarts it from the checkpoint
+     *
+     *  The restarted simulation works directly on the mapped checkpoint and has to be bit-identical
+     *  to the uninterrupted one.
+     */
+    void testRestart()
+    {
+        const unsigned int size = 1000;
+        const char *fileName = "checkpoint_test.swe";
+        scenarios::ShockShock scenario(size, 300, 50);
+        T h[size + 2], hu[size + 2], hReference[size + 2], huReference[size + 2];
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            h[i] = hReference[i] = scenario.getHeight(i);
+            hu[i] = huReference[i] = scenario.getMomentum(i);
+        }
+
+        io::SimulationState reference = {hReference, huReference, 0, size + 2, scenario.getCellSize(), 0, 0, 0};
+        io::SimulationState interrupted = {h, hu, 0, size + 2, scenario.getCellSize(), 0, 0, 0};
+        solver::FWave<T> solver;
+        T hL[size + 1], hR[size + 1], huL[size + 1], huR[size + 1];
+        solver.computeNetUpdates(h, hu, 0, 0, size + 1, hL, hR, huL, huR, reference.maxEdgeSpeed);
+        interrupted.maxEdgeSpeed = reference.maxEdgeSpeed;
+
+        simulate(reference, 30, 0, scenario);
+        io::CheckpointWriter writer(fileName, 5);
+        simulate(interrupted, 17, &writer, scenario);
+
+        io::CheckpointReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT_EQUALS(reader.getScenarioSize(), size);
+        TS_ASSERT_EQUALS(reader.getScenarioName(), "ShockShock");
+        double parameters[io::CHECKPOINT_SCENARIO_PARAMETERS];
+        TS_ASSERT_EQUALS(reader.getScenarioParameters(parameters), 2u);
+        TS_ASSERT_EQUALS(parameters[0], 300);
+        TS_ASSERT_EQUALS(parameters[1], 50);
+        // the scenario can be rebuilt from its parameters, any other scenario is detected
+        TS_ASSERT(reader.matchesScenario(scenario));
+        TS_ASSERT(reader.matchesScenario(scenarios::ShockShock(size, parameters[0], parameters[1])));
+        TS_ASSERT(!reader.matchesScenario(scenarios::ShockShock(size, 300, 40)));
+        TS_ASSERT(!reader.matchesScenario(scenarios::ShockShock(size + 1, 300, 50)));
+        TS_ASSERT(!reader.matchesScenario(scenarios::RareRare(size, 300, 50)));
+
+        io::SimulationState restarted = reader.getState();
+        TS_ASSERT_EQUALS(restarted.step, 15);
+        TS_ASSERT_EQUALS(restarted.cellCount, size + 2);
+        TS_ASSERT(restarted.b == 0);
+        simulate(restarted, 30, 0, scenario);
+
+        TS_ASSERT_EQUALS(restarted.time, reference.time);
+        TS_ASSERT_EQUALS(restarted.maxEdgeSpeed, reference.maxEdgeSpeed);
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            TS_ASSERT_EQUALS(restarted.h[i], hReference[i]);
+            TS_ASSERT_EQUALS(restarted.hu[i], huReference[i]);
+        }
+        std::remove(fileName);
+    }
+
+    /** \brief restarts a wave propagation with bathymetry from a checkpoint through simulateTimeStep()
+     *
+     *  The time, the step and the unknowns of the restored wave propagation have to be bit-identical to an
+     *  uninterrupted run.
+     */
+    void testRestorePolicyWavePropagation()
+    {
+        const unsigned int size = 3000;
+        const char *fileName = "checkpoint_test_policy.swe";
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+        scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+        std::vector<T> hReference = h, huReference = hu;
+
+        PolicyWavePropagation *reference = PolicyWavePropagation::create(&hReference[0], &huReference[0], &b[0], size,
+                scenario.getCellSize(), PolicyWavePropagation::REFLECTING);
+        for (int step = 0; step < 40; step++)
+            reference->simulateTimeStep();
+
+        PolicyWavePropagation *interrupted = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, scenario.getCellSize(),
+                PolicyWavePropagation::REFLECTING);
+        io::CheckpointWriter writer(fileName, 10);
+        for (int step = 0; step < 25; step++)
+        {
+            interrupted->simulateTimeStep();
+            io::SimulationState state = {&h[0], &hu[0], &b[0], size + 2, scenario.getCellSize(), interrupted->getTime(),
+                interrupted->getStep(), 0};
+            writer.checkpoint(state, scenario);
+        }
+        delete interrupted;
+
+        io::CheckpointReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT(reader.matchesScenario(scenario));
+        PolicyWavePropagation *restored = PolicyWavePropagation::restore(reader.getState(), PolicyWavePropagation::REFLECTING);
+        TS_ASSERT_EQUALS(restored->getStep(), 20u);
+        TS_ASSERT_EQUALS(restored->getName(), "variable/wetOnly/reflecting");
+        while (restored->getStep() < reference->getStep())
+            restored->simulateTimeStep();
+
+        TS_ASSERT_EQUALS(restored->getTime(), reference->getTime());
+        const io::SimulationState state = reader.getState();
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            TS_ASSERT_EQUALS(state.h[i], hReference[i]);
+            TS_ASSERT_EQUALS(state.hu[i], huReference[i]);
+        }
+        delete restored;
+        delete reference;
+        std::remove(fileName);
+    }
+
+    /** \brief a missing or foreign file is rejected */
+    void testInvalidFile()
+    {
+        io::CheckpointReader missing("checkpoint_test_missing.swe");
+        TS_ASSERT(!missing.isValid());
+    }
+};
+
+#endif	/* _CHECKPOINTTEST_H */
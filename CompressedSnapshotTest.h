@@ -0,0 +1,193 @@
+/*
+ * File:   CompressedSnapshotTest.h
+ *
+ * Tests of the snapshot codec and the compressed snapshot writer and reader.
+ */
+
+#ifndef _COMPRESSEDSNAPSHOTTEST_H
+#define	_COMPRESSEDSNAPSHOTTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "../io/SnapshotCodec.h"
+#include "../io/CompressedSnapshotWriter.h"
+#include "../io/CompressedSnapshotReader.h"
+
+class CompressedSnapshotTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief the entropy coder restores constant, random and skewed byte streams */
+    void testEntropyCoder()
+    {
+        const std::size_t size = 5000;
+        std::vector<unsigned char> constant(size, 7), random(size), skewed(size);
+        std::srand(1);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            random[i] = std::rand();
+            skewed[i] = std::rand() % 16 == 0 ? std::rand() : 0;
+        }
+        io::SnapshotCodec codec(false);
+        std::vector<unsigned char> encoded, decoded(size);
+        const std::vector<unsigned char> *streams[3] = {&constant, &random, &skewed};
+        for (unsigned int stream = 0; stream < 3; stream++)
+        {
+            encoded.clear();
+            codec.encodeBytes(&(*streams[stream])[0], size, encoded);
+            const unsigned char *end = io::SnapshotCodec::decodeBytes(&encoded[0], &encoded[0] + encoded.size(), size, &decoded[0]);
+            TS_ASSERT_EQUALS(end, &encoded[0] + encoded.size());
+            TS_ASSERT(decoded == *streams[stream]);
+        }
+        // the skewed stream is compressed
+        TS_ASSERT(encoded.size() < size / 2);
+        // a truncated stream is detected
+        TS_ASSERT(!io::SnapshotCodec::decodeBytes(&encoded[0], &encoded[0] + encoded.size() / 2, size, &decoded[0]));
+    }
+
+    /** \brief the lossless mode restores every bit, also across keyframes, blocks and the region of interest */
+    void testLossless()
+    {
+        const unsigned long size = 1000;
+        const char *fileName = "compressed_snapshot_test.swe";
+        std::vector<T> h(size), hu(size);
+        io::SnapshotCompression compression;
+        compression.firstCell = 100;
+        compression.endCell = 901;
+        compression.cellStride = 3;
+        compression.blockSize = 100;
+        compression.keyframeInterval = 4;
+        {
+            io::CompressedSnapshotWriter writer(fileName, size, 2.5, compression, 1, 0, 3, 2);
+            TS_ASSERT(writer.isOpen());
+            for (unsigned long step = 0; step < 10; step++)
+            {
+                fill(h, hu, step);
+                TS_ASSERT(writer.write(&h[0], &hu[0], step, 0.5 * step));
+            }
+            TS_ASSERT(writer.close());
+            TS_ASSERT_EQUALS(writer.getUncompressedBytes(), 10.0 * 2 * size * sizeof(T));
+            // only a third of the cells is stored
+            TS_ASSERT(writer.getCompressionRatio() > 2);
+        }
+
+        io::CompressedSnapshotReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT(!reader.isLossy());
+        TS_ASSERT_EQUALS(reader.getNumberOfSnapshots(), 10);
+        TS_ASSERT_EQUALS(reader.getNumberOfCells(), 267);
+        TS_ASSERT_EQUALS(reader.getNumberOfOriginalCells(), size);
+        TS_ASSERT_EQUALS(reader.getCellSize(), 2.5);
+        std::vector<T> hRead(reader.getNumberOfCells()), huRead(reader.getNumberOfCells());
+        // in order, backwards and jumping over keyframes
+        const unsigned long order[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 9, 6, 2, 7, 0};
+        for (unsigned int i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+        {
+            unsigned long snapshot = order[i];
+            TS_ASSERT(reader.read(snapshot, &hRead[0], &huRead[0]));
+            TS_ASSERT_EQUALS(reader.getStep(snapshot), snapshot);
+            fill(h, hu, snapshot);
+            for (unsigned long cell = 0; cell < reader.getNumberOfCells(); cell++)
+            {
+                TS_ASSERT_EQUALS(hRead[cell], h[100 + 3 * cell]);
+                TS_ASSERT_EQUALS(huRead[cell], hu[100 + 3 * cell]);
+            }
+        }
+        TS_ASSERT_EQUALS(reader.findSnapshot(2.2), 4);
+        std::remove(fileName);
+    }
+
+    /** \brief the lossy mode keeps the error below the tolerances */
+    void testLossy()
+    {
+        const unsigned long size = 5000;
+        const char *fileName = "compressed_snapshot_test_lossy.swe";
+        std::vector<T> h(size), hu(size);
+        io::SnapshotCompression compression;
+        compression.lossy = true;
+        compression.heightTolerance = 1e-3;
+        compression.momentumTolerance = 1e-2;
+        compression.blockSize = 2000;
+        compression.keyframeInterval = 3;
+        {
+            io::CompressedSnapshotWriter writer(fileName, size, 1, compression, 2, 0, 2, 3);
+            for (unsigned long step = 0; step < 20; step++)
+            {
+                fill(h, hu, step);
+                writer.write(&h[0], &hu[0], step, step);
+            }
+            TS_ASSERT_EQUALS(writer.getNumberOfSnapshots(), 10);
+        }
+
+        io::CompressedSnapshotReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT(reader.isLossy());
+        TS_ASSERT_EQUALS(reader.getNumberOfSnapshots(), 10);
+        std::vector<T> hRead(size), huRead(size);
+        for (unsigned long snapshot = 0; snapshot < 10; snapshot++)
+        {
+            TS_ASSERT(reader.read(snapshot, &hRead[0], &huRead[0]));
+            fill(h, hu, 2 * snapshot);
+            for (unsigned long cell = 0; cell < size; cell++)
+            {
+                TS_ASSERT_DELTA(hRead[cell], h[cell], 1e-3 + std::abs(h[cell]) * std::numeric_limits<T>::epsilon());
+                TS_ASSERT_DELTA(huRead[cell], hu[cell], 1e-2 + std::abs(hu[cell]) * std::numeric_limits<T>::epsilon());
+            }
+        }
+        std::remove(fileName);
+    }
+
+    /** \brief a lossy writer needs positive tolerances */
+    void testInvalidCompression()
+    {
+        io::SnapshotCompression compression;
+        compression.lossy = true;
+        io::CompressedSnapshotWriter writer("compressed_snapshot_test_invalid.swe", 10, 1, compression);
+        TS_ASSERT(!writer.isOpen());
+        T h[10] = {0}, hu[10] = {0};
+        TS_ASSERT(!writer.write(h, hu, 0, 0));
+    }
+
+    /** \brief a failed write closes the writer and is reported by close() */
+    void testWriteFailure()
+    {
+        // larger than the buffer of the stream, so the I/O thread already notices the failure before close()
+        const unsigned long size = 100000;
+        std::vector<T> h(size), hu(size);
+        io::CompressedSnapshotWriter writer("/dev/full", size, 1, io::SnapshotCompression());
+        TS_ASSERT(writer.isOpen());
+        for (unsigned long step = 0; step < 3; step++)
+        {
+            fill(h, hu, step);
+            writer.write(&h[0], &hu[0], step, step);
+        }
+        TS_ASSERT(!writer.close());
+        TS_ASSERT(writer.hasFailed());
+        TS_ASSERT(!writer.isOpen());
+        TS_ASSERT(!writer.write(&h[0], &hu[0], 3, 3));
+
+        io::CompressedSnapshotWriter missing("no_such_directory/compressed_snapshot_test.swe", size, 1, io::SnapshotCompression());
+        TS_ASSERT(!missing.isOpen());
+        TS_ASSERT(!missing.close());
+    }
+
+private:
+
+    /** \brief a wave which travels to the right over water at rest */
+    void fill(std::vector<T> &h, std::vector<T> &hu, unsigned long step)
+    {
+        for (unsigned long i = 0; i < h.size(); i++)
+        {
+            T x = (T) i / h.size() - 0.02 * step;
+            h[i] = 10 + 0.5 * std::exp(-200 * x * x);
+            hu[i] = std::sqrt(9.81 * 10) * (h[i] - 10);
+        }
+    }
+};
+
+#endif	/* _COMPRESSEDSNAPSHOTTEST_H */
@@ -0,0 +1,72 @@
+/*
+ * File:   Diagnostics.h
+ *
+ * Conservation and energy diagnostics which are accumulated while the unknowns are updated.
+ */
+
+#ifndef _DIAGNOSTICS_H
+#define	_DIAGNOSTICS_H
+
+#include "types.h"
+
+/**
+ * The totals and maxima over all cells (without the ghost cells) at the end of a time step.
+ */
+struct Diagnostics
+{
+    /** The simulated time at the end of the step */
+    double time;
+    /** The integral of h */
+    double mass;
+    /** The integral of hu */
+    double momentum;
+    /** The integral of the kinetic and the potential energy hu^2 / (2h) + g h^2 / 2 + g h b */
+    double energy;
+    /** The maximum of the free surface h + b over the wet cells */
+    T maxSurface;
+    /** The maximum of |hu / h| over the wet cells */
+    T maxVelocity;
+};
+
+/**
+ * Called after every time step with the diagnostics of the step.
+ *
+ * @param [in] diagnostics The diagnostics of the step
+ * @param [in] userData The pointer which was passed together with the callback
+ */
+typedef void (*DiagnosticsCallback)(const Diagnostics &diagnostics, void *userData);
+
+/**
+ * Kahan summation: the rounding error of every addition is carried over to the next one, so the
+ * error of the sum does not grow with the number of summands. The compensation is lost if the compiler
+ * may reassociate floating point additions (-ffast-math).
+ */
+class CompensatedSum
+{
+public:
+
+    CompensatedSum()
+        : m_sum(0), m_compensation(0)
+    {
+    }
+
+    void add(double value)
+    {
+        double corrected = value - m_compensation;
+        double sum = m_sum + corrected;
+        m_compensation = (sum - m_sum) - corrected;
+        m_sum = sum;
+    }
+
+    double get() const
+    {
+        return m_sum;
+    }
+
+private:
+
+    double m_sum;
+    double m_compensation;
+};
+
+#endif	/* _DIAGNOSTICS_H */
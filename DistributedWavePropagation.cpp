@@ -0,0 +1,180 @@
+/*
+ * File:   DistributedWavePropagation.cpp
+ *
+ * 1D wave propagation on a domain which is decomposed over several MPI processes.
+ */
+
+#include "DistributedWavePropagation.h"
+#include "Instrumentation.h"
+#include "Numa.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+
+/** @return The MPI data type matching T */
+MPI_Datatype mpiType()
+{
+    return sizeof(T) == sizeof(float) ? MPI_FLOAT : MPI_DOUBLE;
+}
+
+}
+
+DistributedWavePropagation::DistributedWavePropagation(scenarios::Scenario<T> &scenario, unsigned int size, MPI_Comm communicator)
+    : m_communicator(communicator), m_size(size), m_localSize(0), m_offset(0), m_cellSize(scenario.getCellSize()),
+      m_h(0), m_hu(0), m_b(0), m_bathymetry(0), m_hNetUpdatesLeft(0), m_hNetUpdatesRight(0), m_huNetUpdatesLeft(0), m_huNetUpdatesRight(0),
+      m_numberOfRequests(0)
+{
+    MPI_Comm_rank(m_communicator, &m_rank);
+    MPI_Comm_size(m_communicator, &m_numberOfRanks);
+    if (size < (unsigned int) m_numberOfRanks)
+    {
+        if (m_rank == 0)
+            std::cerr << "Cannot distribute " << size << " cells over " << m_numberOfRanks << " processes" << std::endl;
+        return;
+    }
+
+    // the first size % ranks ranks get one cell more
+    m_localSize = size / m_numberOfRanks + (m_rank < (int) (size % m_numberOfRanks) ? 1 : 0);
+    m_offset = 1 + m_rank * (size / m_numberOfRanks) + std::min<unsigned int>(m_rank, size % m_numberOfRanks);
+
+    m_h = numa::allocateField(m_localSize + 2);
+    m_hu = numa::allocateField(m_localSize + 2);
+    m_b = numa::allocateField(m_localSize + 2);
+    m_hNetUpdatesLeft = numa::allocateField(m_localSize + 1);
+    m_hNetUpdatesRight = numa::allocateField(m_localSize + 1);
+    m_huNetUpdatesLeft = numa::allocateField(m_localSize + 1);
+    m_huNetUpdatesRight = numa::allocateField(m_localSize + 1);
+    m_dryChunks.assign((m_localSize + solver::FWave<T>::EDGES_PER_CHUNK - 1) / solver::FWave<T>::EDGES_PER_CHUNK, 0);
+
+    // local cell i is the global cell m_offset + i - 1, including the ghost cells
+    scenario.fill(m_h, m_hu, m_b, m_offset - 1, m_offset + m_localSize + 1);
+    // the ghost cells have the bathymetry of the neighbouring slabs, so the edges between two ranks need no exchange of b
+    bool flat = true;
+    for (unsigned int i = 0; i < m_localSize + 2; i++)
+        flat = flat && m_b[i] == m_b[0];
+    m_bathymetry = flat ? 0 : m_b;
+    // like h and hu, the net updates are first touched in parallel with the chunks of the edge sweep
+    numa::firstTouch(m_hNetUpdatesLeft, m_localSize + 1);
+    numa::firstTouch(m_hNetUpdatesRight, m_localSize + 1);
+    numa::firstTouch(m_huNetUpdatesLeft, m_localSize + 1);
+    numa::firstTouch(m_huNetUpdatesRight, m_localSize + 1);
+}
+
+DistributedWavePropagation::~DistributedWavePropagation()
+{
+    numa::freeField(m_h);
+    numa::freeField(m_hu);
+    numa::freeField(m_b);
+    numa::freeField(m_hNetUpdatesLeft);
+    numa::freeField(m_hNetUpdatesRight);
+    numa::freeField(m_huNetUpdatesLeft);
+    numa::freeField(m_huNetUpdatesRight);
+}
+
+void DistributedWavePropagation::startHaloExchange()
+{
+    SWE_INSTRUMENT_PHASE(BOUNDARY_CONDITIONS);
+    m_numberOfRequests = 0;
+    m_sendBuffer[0] = m_h[1];
+    m_sendBuffer[1] = m_hu[1];
+    m_sendBuffer[2] = m_h[m_localSize];
+    m_sendBuffer[3] = m_hu[m_localSize];
+
+    // h and hu of a cell are sent as one message, tag 0 goes to the right, tag 1 to the left
+    if (m_rank > 0)
+    {
+        MPI_Irecv(m_receiveBuffer, 2, mpiType(), m_rank - 1, 0, m_communicator, &m_requests[m_numberOfRequests++]);
+        MPI_Isend(m_sendBuffer, 2, mpiType(), m_rank - 1, 1, m_communicator, &m_requests[m_numberOfRequests++]);
+    }
+    if (m_rank < m_numberOfRanks - 1)
+    {
+        MPI_Irecv(m_receiveBuffer + 2, 2, mpiType(), m_rank + 1, 1, m_communicator, &m_requests[m_numberOfRequests++]);
+        MPI_Isend(m_sendBuffer + 2, 2, mpiType(), m_rank + 1, 0, m_communicator, &m_requests[m_numberOfRequests++]);
+    }
+}
+
+void DistributedWavePropagation::finishHaloExchange()
+{
+    SWE_INSTRUMENT_PHASE(BOUNDARY_CONDITIONS);
+    MPI_Waitall(m_numberOfRequests, m_requests, MPI_STATUSES_IGNORE);
+
+    // ghost cells from the neighbours or outflow at the ends of the global domain
+    if (m_rank > 0)
+    {
+        m_h[0] = m_receiveBuffer[0];
+        m_hu[0] = m_receiveBuffer[1];
+    }
+    else
+    {
+        m_h[0] = m_h[1];
+        m_hu[0] = m_hu[1];
+    }
+    if (m_rank < m_numberOfRanks - 1)
+    {
+        m_h[m_localSize + 1] = m_receiveBuffer[2];
+        m_hu[m_localSize + 1] = m_receiveBuffer[3];
+    }
+    else
+    {
+        m_h[m_localSize + 1] = m_h[m_localSize];
+        m_hu[m_localSize + 1] = m_hu[m_localSize];
+    }
+}
+
+T DistributedWavePropagation::simulateTimeStep()
+{
+    if (!isValid())
+        return 0;
+    startHaloExchange();
+
+    // interior edges 1 to localSize - 1 only need local cells and overlap with the communication
+    T maxEdgeSpeed = 0;
+    if (m_localSize > 1)
+    {
+        SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+        m_solver.computeNetUpdatesParallel(m_h, m_hu, m_bathymetry, 1, m_localSize, m_hNetUpdatesLeft, m_hNetUpdatesRight,
+                m_huNetUpdatesLeft, m_huNetUpdatesRight, maxEdgeSpeed, &m_dryChunks[0]);
+    }
+
+    finishHaloExchange();
+
+    T boundaryMaxEdgeSpeed;
+    T globalMaxEdgeSpeed;
+    {
+        SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+        m_solver.computeNetUpdates(m_h, m_hu, m_bathymetry, 0, 1, m_hNetUpdatesLeft, m_hNetUpdatesRight,
+                m_huNetUpdatesLeft, m_huNetUpdatesRight, boundaryMaxEdgeSpeed);
+        maxEdgeSpeed = std::max(maxEdgeSpeed, boundaryMaxEdgeSpeed);
+        m_solver.computeNetUpdates(m_h, m_hu, m_bathymetry, m_localSize, m_localSize + 1, m_hNetUpdatesLeft, m_hNetUpdatesRight,
+                m_huNetUpdatesLeft, m_huNetUpdatesRight, boundaryMaxEdgeSpeed);
+        maxEdgeSpeed = std::max(maxEdgeSpeed, boundaryMaxEdgeSpeed);
+    }
+    {
+        // includes the wait for the slowest rank, so it is not part of the numerical fluxes
+        SWE_INSTRUMENT_PHASE(TIME_STEP_REDUCTION);
+        MPI_Allreduce(&maxEdgeSpeed, &globalMaxEdgeSpeed, 1, mpiType(), MPI_MAX, m_communicator);
+    }
+    // a domain without waves stays unchanged, an infinite time step would turn the zero net updates into NaNs
+    if (globalMaxEdgeSpeed == 0)
+    {
+        SWE_INSTRUMENT_END_STEP(0);
+        return 0;
+    }
+    T dt = 0.4 * m_cellSize / globalMaxEdgeSpeed;
+
+    {
+        SWE_INSTRUMENT_PHASE(UPDATE_UNKNOWNS);
+        T dtOverCellSize = dt / m_cellSize;
+#pragma omp parallel for schedule(static)
+        for (int i = 1; i <= (int) m_localSize; i++)
+        {
+            m_h[i] -= dtOverCellSize * (m_hNetUpdatesRight[i - 1] + m_hNetUpdatesLeft[i]);
+            m_hu[i] -= dtOverCellSize * (m_huNetUpdatesRight[i - 1] + m_huNetUpdatesLeft[i]);
+        }
+    }
+    SWE_INSTRUMENT_END_STEP(dt);
+    return dt;
+}
@@ -0,0 +1,123 @@
+/*
+ * File:   DistributedWavePropagation.h
+ *
+ * 1D wave propagation on a domain which is decomposed over several MPI processes.
+ */
+
+#ifndef _DISTRIBUTEDWAVEPROPAGATION_H
+#define	_DISTRIBUTEDWAVEPROPAGATION_H
+
+#include <mpi.h>
+#include <vector>
+
+#include "types.h"
+#include "scenarios/scenario.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Splits a 1D domain of size cells into one contiguous slab per rank.
+ *
+ * Every rank stores its cells with one ghost cell on each side, just like the arrays of the serial
+ * WavePropagation. Where the serial code sets the outflow boundary conditions, the ghost cells
+ * between two ranks are exchanged with the neighbours instead. The exchange is non-blocking: the
+ * edges which only touch local cells are computed while the messages are in flight, the two edges
+ * next to the ghost cells are computed afterwards. The global maximum edge speed, and therefore
+ * the time step, is agreed upon with an all-reduce.
+ *
+ * The bathymetry does not change, so every rank fills its slab including the two ghost cells once and
+ * never exchanges it. A slab with a constant bathymetry is computed with the flat kernels.
+ *
+ * Every rank needs at least one cell, a rank without cells would pass its ghost cells on to its
+ * neighbours as interior values. A domain with fewer cells than ranks is rejected, see isValid().
+ */
+class DistributedWavePropagation
+{
+public:
+
+    /**
+     * @param [in] scenario The scenario which provides the initial values of the global domain
+     * @param [in] size The number of cells of the global domain, at least the number of processes
+     * @param [in] communicator The processes which share the domain
+     */
+    DistributedWavePropagation(scenarios::Scenario<T> &scenario, unsigned int size, MPI_Comm communicator = MPI_COMM_WORLD);
+
+    ~DistributedWavePropagation();
+
+    /** @return False if the domain has fewer cells than there are processes, the same on all ranks */
+    bool isValid() const
+    {
+        return m_h != 0;
+    }
+
+    /**
+     * Runs one time step: halo exchange, net updates, global time step and update of the unknowns.
+     *
+     * @return The time step, 0 if the wave propagation is not valid or if no wave moves in the whole domain (all
+     * cells are dry), the unknowns are not changed then
+     */
+    T simulateTimeStep();
+
+    /** @return The number of cells owned by this rank */
+    unsigned int getLocalSize() const
+    {
+        return m_localSize;
+    }
+
+    /** @return The global position of the first cell owned by this rank */
+    unsigned int getOffset() const
+    {
+        return m_offset;
+    }
+
+    /** @return The heights of the local cells including the two ghost cells */
+    const T *getHeight() const
+    {
+        return m_h;
+    }
+
+    /** @return The momentums of the local cells including the two ghost cells */
+    const T *getMomentum() const
+    {
+        return m_hu;
+    }
+
+private:
+
+    /** Starts the non-blocking exchange of the ghost cells with the neighbouring ranks */
+    void startHaloExchange();
+
+    /** Waits for the ghost cells and sets the outflow boundary conditions at the ends of the global domain */
+    void finishHaloExchange();
+
+    MPI_Comm m_communicator;
+    int m_rank;
+    int m_numberOfRanks;
+
+    unsigned int m_size;
+    unsigned int m_localSize;
+    unsigned int m_offset;
+    T m_cellSize;
+
+    T *m_h;
+    T *m_hu;
+    T *m_b;
+    /** m_b or NULL if the bathymetry of the slab is constant */
+    const T *m_bathymetry;
+    T *m_hNetUpdatesLeft;
+    T *m_hNetUpdatesRight;
+    T *m_huNetUpdatesLeft;
+    T *m_huNetUpdatesRight;
+    /** One flag per chunk of the interior edges which was completely dry in the last sweep */
+    std::vector<unsigned char> m_dryChunks;
+
+    /** The values which are sent to the neighbours: h and hu of the first and of the last local cell */
+    T m_sendBuffer[4];
+    /** The values which are received from the neighbours: h and hu of the left and of the right ghost cell */
+    T m_receiveBuffer[4];
+    MPI_Request m_requests[4];
+    int m_numberOfRequests;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _DISTRIBUTEDWAVEPROPAGATION_H */
@@ -0,0 +1,165 @@
+/*
+ * File:   Ensemble.cpp
+ *
+ * Many small 1D simulations advanced together by one vectorized solver pass.
+ */
+
+#include "Ensemble.h"
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <limits>
+
+Ensemble::Ensemble(scenarios::Scenario<T> *const *members, unsigned int numberOfMembers, unsigned int size, bool sharedTimeStep)
+    : m_members(numberOfMembers), m_size(size), m_sharedTimeStep(sharedTimeStep), m_flat(true),
+      m_h((size + 2) * numberOfMembers), m_hu((size + 2) * numberOfMembers), m_b((size + 2) * numberOfMembers),
+      m_hNetUpdatesLeft((size + 1) * numberOfMembers), m_hNetUpdatesRight((size + 1) * numberOfMembers),
+      m_huNetUpdatesLeft((size + 1) * numberOfMembers), m_huNetUpdatesRight((size + 1) * numberOfMembers),
+      m_cellSize(numberOfMembers), m_maxEdgeSpeed(numberOfMembers), m_timeSteps(numberOfMembers, 0), m_time(numberOfMembers, 0)
+{
+    // every member fills contiguous arrays, which are scattered into the interleaved layout
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    for (unsigned int m = 0; m < m_members; m++)
+    {
+        members[m]->fill(&h[0], &hu[0], &b[0], 0, size + 2);
+        m_cellSize[m] = members[m]->getCellSize();
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            m_h[i * m_members + m] = h[i];
+            m_hu[i * m_members + m] = hu[i];
+            m_b[i * m_members + m] = b[i];
+            m_flat = m_flat && b[i] == 0;
+        }
+    }
+}
+
+void Ensemble::simulateTimeStep()
+{
+    advance(std::numeric_limits<double>::infinity());
+}
+
+unsigned long Ensemble::simulateUntil(double endTime)
+{
+    unsigned long steps = 0;
+    while (advance(endTime))
+        steps++;
+    return steps;
+}
+
+bool Ensemble::advance(double endTime)
+{
+    bool running = false;
+    for (unsigned int m = 0; m < m_members; m++)
+        running = running || m_time[m] < endTime;
+    if (!running)
+        return false;
+
+    setOutflowBoundaryConditions();
+    computeNumericalFluxes();
+
+    // a member in which no wave moves has no CFL limit, it jumps to endTime in one step
+    const T unlimited = std::numeric_limits<T>::max();
+    T sharedDt = unlimited;
+    for (unsigned int m = 0; m < m_members; m++)
+    {
+        T dt = 0;
+        if (m_time[m] < endTime)
+        {
+            dt = m_maxEdgeSpeed[m] > 0 ? 0.4 * m_cellSize[m] / m_maxEdgeSpeed[m] : unlimited;
+            if (m_time[m] + dt > endTime)
+                dt = endTime - m_time[m];
+            sharedDt = std::min(sharedDt, dt);
+        }
+        m_timeSteps[m] = dt;
+    }
+    for (unsigned int m = 0; m < m_members; m++)
+    {
+        if (m_sharedTimeStep && m_time[m] < endTime)
+            m_timeSteps[m] = sharedDt;
+        // a single step without an end time
+        if (m_timeSteps[m] == unlimited)
+            m_timeSteps[m] = 0;
+    }
+
+    updateUnknowns();
+    T minTimeStep = unlimited;
+    for (unsigned int m = 0; m < m_members; m++)
+    {
+        minTimeStep = std::min(minTimeStep, m_timeSteps[m]);
+        // the last step ends exactly at endTime, even if the sum of the rounded time steps does not
+        if (m_timeSteps[m] > 0 && m_time[m] + m_timeSteps[m] >= endTime)
+            m_time[m] = endTime;
+        else
+            m_time[m] += m_timeSteps[m];
+    }
+    SWE_INSTRUMENT_END_STEP(minTimeStep);
+    return true;
+}
+
+void Ensemble::setOutflowBoundaryConditions()
+{
+    SWE_INSTRUMENT_PHASE(BOUNDARY_CONDITIONS);
+    const std::size_t last = (std::size_t) m_size * m_members;
+    for (std::size_t m = 0; m < m_members; m++)
+    {
+        m_h[m] = m_h[m_members + m];
+        m_hu[m] = m_hu[m_members + m];
+        m_h[last + m_members + m] = m_h[last + m];
+        m_hu[last + m_members + m] = m_hu[last + m];
+    }
+}
+
+void Ensemble::computeNumericalFluxes()
+{
+    SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+    std::fill(m_maxEdgeSpeed.begin(), m_maxEdgeSpeed.end(), (T) 0);
+    const T *b = m_flat ? 0 : &m_b[0];
+    const int edgesPerChunk = 64;
+    const int numberOfChunks = (m_size + 1 + edgesPerChunk - 1) / edgesPerChunk;
+
+    // every thread keeps the maxima of its chunks, they are merged once per thread
+#pragma omp parallel
+    {
+        std::vector<T> maxEdgeSpeed(m_members, 0), chunkMaxEdgeSpeed(m_members);
+#pragma omp for schedule(static)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned int chunkBegin = chunk * edgesPerChunk;
+            unsigned int chunkEnd = std::min<unsigned int>(chunkBegin + edgesPerChunk, m_size + 1);
+            m_solver.computeNetUpdatesInterleaved(&m_h[0], &m_hu[0], b, m_members, chunkBegin, chunkEnd,
+                    &m_hNetUpdatesLeft[0], &m_hNetUpdatesRight[0], &m_huNetUpdatesLeft[0], &m_huNetUpdatesRight[0],
+                    &chunkMaxEdgeSpeed[0]);
+            for (unsigned int m = 0; m < m_members; m++)
+                maxEdgeSpeed[m] = std::max(maxEdgeSpeed[m], chunkMaxEdgeSpeed[m]);
+        }
+#pragma omp critical
+        for (unsigned int m = 0; m < m_members; m++)
+            m_maxEdgeSpeed[m] = std::max(m_maxEdgeSpeed[m], maxEdgeSpeed[m]);
+    }
+}
+
+void Ensemble::updateUnknowns()
+{
+    SWE_INSTRUMENT_PHASE(UPDATE_UNKNOWNS);
+    std::vector<T> dtOverCellSize(m_members);
+    for (unsigned int m = 0; m < m_members; m++)
+        dtOverCellSize[m] = m_timeSteps[m] / m_cellSize[m];
+
+    const std::size_t members = m_members;
+    const T *factors = &dtOverCellSize[0];
+    T *h = &m_h[0], *hu = &m_hu[0];
+    const T *hNetUpdatesLeft = &m_hNetUpdatesLeft[0], *hNetUpdatesRight = &m_hNetUpdatesRight[0];
+    const T *huNetUpdatesLeft = &m_huNetUpdatesLeft[0], *huNetUpdatesRight = &m_huNetUpdatesRight[0];
+#pragma omp parallel for schedule(static)
+    for (int i = 1; i <= (int) m_size; i++)
+    {
+        const std::size_t offset = i * members;
+#pragma omp simd
+        for (std::size_t m = 0; m < members; m++)
+        {
+            const std::size_t cell = offset + m;
+            h[cell] -= factors[m] * (hNetUpdatesRight[cell - members] + hNetUpdatesLeft[cell]);
+            hu[cell] -= factors[m] * (huNetUpdatesRight[cell - members] + huNetUpdatesLeft[cell]);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * File:   Ensemble.h
+ *
+ * Many small 1D simulations advanced together by one vectorized solver pass.
+ */
+
+#ifndef _ENSEMBLE_H
+#define	_ENSEMBLE_H
+
+#include <vector>
+
+#include "types.h"
+#include "scenarios/scenario.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Runs an ensemble of variants of a scenario (e.g. ShockShock over a grid of heights and momentums),
+ * which all have the same number of cells.
+ *
+ * The members are stored interleaved with the member index innermost: cell i of member m is stored at
+ * index i * members + m. The f-wave kernel and the update of the unknowns loop over the members in
+ * their inner loop, so one vector instruction advances several members at once while every member is
+ * computed with the same operations as a single run.
+ *
+ * Every member advances with its own CFL time step by default, so the members reach different
+ * simulated times. With a shared time step all members advance with the smallest CFL time step of
+ * the ensemble. With the own time steps every member evolves like a single run (outflow boundaries,
+ * net updates of all edges, dt = 0.4 * cellSize / maxEdgeSpeed, update). The results are identical up
+ * to rounding, the FMA variants of the solver may contract the ensemble loop and the single run loop
+ * differently.
+ */
+class Ensemble
+{
+public:
+
+    /**
+     * @param [in] members The scenarios of the members, all with the given number of cells
+     * @param [in] numberOfMembers The number of members
+     * @param [in] size The number of cells of every member without the ghost cells
+     * @param [in] sharedTimeStep True if all members advance with the smallest time step of the ensemble
+     */
+    Ensemble(scenarios::Scenario<T> *const *members, unsigned int numberOfMembers, unsigned int size, bool sharedTimeStep = false);
+
+    /**
+     * Advances every member by one time step. The time step of a member in which no wave moves (all cells are dry)
+     * is 0, simulateUntil() advances it to the end time in one step.
+     */
+    void simulateTimeStep();
+
+    /**
+     * Advances every member until it reaches the given time. The last time step of every member is
+     * shortened, so it ends exactly at endTime.
+     *
+     * @param [in] endTime The simulated time
+     * @return The number of time steps
+     */
+    unsigned long simulateUntil(double endTime);
+
+    unsigned int getNumberOfMembers() const
+    {
+        return m_members;
+    }
+
+    unsigned int getSize() const
+    {
+        return m_size;
+    }
+
+    /** @return The water height of a cell (0 to size + 1) of a member */
+    T getHeight(unsigned int member, unsigned int cell) const
+    {
+        return m_h[cell * m_members + member];
+    }
+
+    /** @return The momentum of a cell (0 to size + 1) of a member */
+    T getMomentum(unsigned int member, unsigned int cell) const
+    {
+        return m_hu[cell * m_members + member];
+    }
+
+    /** @return The simulated time of a member */
+    double getTime(unsigned int member) const
+    {
+        return m_time[member];
+    }
+
+    /** @return The last time step of a member */
+    T getTimeStep(unsigned int member) const
+    {
+        return m_timeSteps[member];
+    }
+
+private:
+
+    /**
+     * Runs one time step of all members, the time step of every member is limited by the time
+     * which remains until endTime.
+     *
+     * @return True if a member has not reached endTime yet
+     */
+    bool advance(double endTime);
+
+    /** Sets the outflow boundary conditions of every member */
+    void setOutflowBoundaryConditions();
+
+    /** Computes the net updates of all edges and the maximum edge speed of every member */
+    void computeNumericalFluxes();
+
+    /** Applies the net updates with the time step of every member */
+    void updateUnknowns();
+
+    unsigned int m_members;
+    unsigned int m_size;
+    bool m_sharedTimeStep;
+    /** True if all members have a flat bathymetry, the bathymetry is not passed to the solver then */
+    bool m_flat;
+
+    /** Interleaved values of all cells including the ghost cells */
+    std::vector<T> m_h;
+    std::vector<T> m_hu;
+    std::vector<T> m_b;
+
+    /** Interleaved net updates, edge i lies between cell i and cell i + 1 */
+    std::vector<T> m_hNetUpdatesLeft;
+    std::vector<T> m_hNetUpdatesRight;
+    std::vector<T> m_huNetUpdatesLeft;
+    std::vector<T> m_huNetUpdatesRight;
+
+    /** Per member values */
+    std::vector<T> m_cellSize;
+    std::vector<T> m_maxEdgeSpeed;
+    std::vector<T> m_timeSteps;
+    std::vector<double> m_time;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _ENSEMBLE_H */
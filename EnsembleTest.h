@@ -0,0 +1,126 @@
+/*
+ * File:   EnsembleTest.h
+ *
+ * Tests of the interleaved ensemble runner.
+ */
+
+#ifndef _ENSEMBLETEST_H
+#define	_ENSEMBLETEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <vector>
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/rarerare.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../Ensemble.h"
+#include "../ReferenceWavePropagation.h"
+
+class EnsembleTest : public CxxTest::TestSuite
+{
+private:
+
+    static const unsigned int SIZE = 200;
+    static const unsigned int MEMBERS = 7;
+
+    /** \brief a parameter sweep over both riemann problems and a scenario with bathymetry */
+    struct Sweep
+    {
+        scenarios::ShockShock shockShock[3];
+        scenarios::RareRare rareRare[3];
+        scenarios::ShelfDamBreak shelf;
+        scenarios::Scenario<T> *members[MEMBERS];
+
+        Sweep()
+            : shockShock{scenarios::ShockShock(SIZE, 10, 3), scenarios::ShockShock(SIZE, 300, 50), scenarios::ShockShock(SIZE, 1387.1, 101.9)},
+              rareRare{scenarios::RareRare(SIZE, 10, 3), scenarios::RareRare(SIZE, 6907.4, -180.6), scenarios::RareRare(SIZE, 2, 7)},
+              shelf(SIZE)
+        {
+            for (unsigned int m = 0; m < 3; m++)
+            {
+                members[m] = &shockShock[m];
+                members[3 + m] = &rareRare[m];
+            }
+            members[6] = &shelf;
+        }
+    };
+
+public:
+
+    /** \brief every member with its own time step evolves like a single run */
+    void testOwnTimeSteps()
+    {
+        const int steps = 30;
+        Sweep sweep;
+        scenarios::Scenario<T> **members = sweep.members;
+        Ensemble ensemble(members, MEMBERS, SIZE);
+        for (int step = 0; step < steps; step++)
+            ensemble.simulateTimeStep();
+
+        for (unsigned int m = 0; m < MEMBERS; m++)
+        {
+            ReferenceWavePropagation reference(*members[m], SIZE);
+            for (int step = 0; step < steps; step++)
+                reference.simulateTimeStep();
+            TS_ASSERT_DELTA(ensemble.getTime(m), reference.getTime(), 1e-5 * reference.getTime());
+            const std::vector<T> &h = reference.getHeights(), &hu = reference.getMomentums();
+            for (unsigned int i = 1; i <= SIZE; i++)
+            {
+                TS_ASSERT_DELTA(ensemble.getHeight(m, i), h[i], 1e-5 * h[i]);
+                TS_ASSERT_DELTA(ensemble.getMomentum(m, i), hu[i], 1e-4 * std::abs(hu[i]) + 1e-3);
+            }
+        }
+    }
+
+    /** \brief with a shared time step all members advance with the smallest time step of the ensemble */
+    void testSharedTimeStep()
+    {
+        const int steps = 10;
+        Sweep sweep;
+        scenarios::Scenario<T> **members = sweep.members;
+        Ensemble ensemble(members, MEMBERS, SIZE, true);
+
+        std::vector<ReferenceWavePropagation> references;
+        for (unsigned int m = 0; m < MEMBERS; m++)
+            references.push_back(ReferenceWavePropagation(*members[m], SIZE));
+        for (int step = 0; step < steps; step++)
+        {
+            ensemble.simulateTimeStep();
+            T dt = ensemble.getTimeStep(0);
+            for (unsigned int m = 0; m < MEMBERS; m++)
+            {
+                TS_ASSERT_EQUALS(ensemble.getTimeStep(m), dt);
+                references[m].simulateTimeStep(dt);
+            }
+        }
+        for (unsigned int m = 0; m < MEMBERS; m++)
+        {
+            TS_ASSERT_EQUALS(ensemble.getTime(m), ensemble.getTime(0));
+            const std::vector<T> &h = references[m].getHeights(), &hu = references[m].getMomentums();
+            for (unsigned int i = 1; i <= SIZE; i++)
+            {
+                TS_ASSERT_DELTA(ensemble.getHeight(m, i), h[i], 1e-5 * h[i]);
+                TS_ASSERT_DELTA(ensemble.getMomentum(m, i), hu[i], 1e-4 * std::abs(hu[i]) + 1e-3);
+            }
+        }
+    }
+
+    /** \brief all members stop exactly at the end time, the fast members need more steps */
+    void testSimulateUntil()
+    {
+        Sweep sweep;
+        scenarios::Scenario<T> **members = sweep.members;
+        Ensemble ensemble(members, MEMBERS, SIZE);
+        const double endTime = 2;
+        unsigned long steps = ensemble.simulateUntil(endTime);
+        TS_ASSERT(steps > 0);
+        for (unsigned int m = 0; m < MEMBERS; m++)
+            TS_ASSERT_EQUALS(ensemble.getTime(m), endTime);
+        // nothing is left to do
+        TS_ASSERT_EQUALS(ensemble.simulateUntil(endTime), 0);
+    }
+};
+
+#endif	/* _ENSEMBLETEST_H */
@@ -12,29 +12,180 @@
 #include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstddef>
+#include <limits>
+
+#include "../Instrumentation.h"
 
 #define g 9.81
 namespace solver {
 
     /**
-     * A basic f-wave solver which computes net updates for two given wave vectors.
+     * Bathymetry policies of the f-wave kernels. With a flat bathymetry the bathymetry term of the
+     * flux jump is dropped and the bathymetry array is never read.
      */
-    template <typename T> class FWave {
-    public:
+    struct FlatBathymetry {
+        static const bool VARIABLE = false;
+        static const char *name() { return "flat"; }
+    };
 
-        FWave() {
-            roeEigenvalues = new T[2];
-        }
+    struct VariableBathymetry {
+        static const bool VARIABLE = true;
+        static const char *name() { return "variable"; }
+    };
+
+    /**
+     * Wetting policies of the f-wave kernels. WetOnly drops the wet-dry reflection and the masks of the
+     * dry cells, it may only be used as long as no cell of the range is dry.
+     */
+    struct WetOnly {
+        static const bool DRY_CELLS = false;
+        static const char *name() { return "wetOnly"; }
+    };
+
+    struct WetDry {
+        static const bool DRY_CELLS = true;
+        static const char *name() { return "wetDry"; }
+    };
 
-        ~FWave() {
-            delete [] roeEigenvalues;
+    /**
+     * Branch-free f-wave kernels which compute the net updates for a whole range of edges.
+     *
+     * All decisions (wet-dry reflection, the upwinding on the sign of the roe eigenvalues and the
+     * maximum edge speed) are expressed as selects, so the compiler can turn them into masked blends
+     * and every lane of a vector register follows the same instruction stream.
+     * The kernel is compiled once per instruction set and the best variant is chosen at runtime.
+     *
+     * The loops are vectorized with <code>#pragma omp simd</code>, so the code has to be compiled
+     * with -O3, -fopenmp-simd (or -fopenmp), -fno-math-errno and -fno-trapping-math.
+     *
+     * The arrays are stored as T, the arithmetic of every edge is carried out in the compute type C
+     * (see Precision). Without a separate compute type both are the same.
+     */
+    namespace kernel {
+
+        /**
+         * Computes the quantities of a single cell which are shared by both of its edges.
+         *
+         * @param [in] h The height of the water column
+         * @param [in] hu The space time dependent momentum of the water column
+         * @param [out] sqrtH The square root of the height
+         * @param [out] u The particle velocity, 0 for a dry cell
+         * @param [out] flux The momentum flux hu * u + g * h^2 / 2
+         */
+        template <typename T, typename Wetting = WetDry>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline void computeCell(T h, T hu, T &sqrtH, T &u, T &flux) {
+            const T zero = 0, half = 0.5, gravity = g;
+            sqrtH = std::sqrt(h);
+            u = Wetting::DRY_CELLS && h == zero ? zero : hu / h;
+            flux = hu * u + half * gravity * h * h;
         }
 
-        /** \brief Computes the net updates and the maxiumum edge speed for a given set of parameters.
+        /**
+         * Computes the net updates of a single edge from the precomputed quantities of its two cells without any branches.
+         * Only the roe averages are left: one square root and two divisions per edge. The policies drop the parts
+         * which a simulation never needs at compile time, the defaults handle every edge.
          *
-         * Computes the net updates and the maximum edge speed for a given set of water columns and bathymetry values.
-         * The roe eigenvalues, the wave speeds and the wave speeds of both the left and the right water column
-         * which are calculated during the computation of the updates can be retrieved via the appropriate getters.
+         * @param [in] hl The height of the left water column
+         * @param [in] hr The height of the right water column
+         * @param [in] hul The space time dependent momentum of the left water column
+         * @param [in] hur The space time dependent momentum of the right water column
+         * @param [in] bl The first bathymetry component
+         * @param [in] br The second bathymetry component
+         * @param [in] sqrtHl The square root of the left height
+         * @param [in] sqrtHr The square root of the right height
+         * @param [in] ul The particle velocity of the left water column
+         * @param [in] ur The particle velocity of the right water column
+         * @param [in] fluxl The momentum flux of the left water column
+         * @param [in] fluxr The momentum flux of the right water column
+         * @param [out] hNetUpdatesLeft The net update for the height of the left water column
+         * @param [out] hNetUpdatesRight The net update for the height of the right water column
+         * @param [out] huNetUpdatesLeft The net update for the momentum of the left water column
+         * @param [out] huNetUpdatesRight The net update for the momentum of the right water column
+         * @return The maximum edge speed
+         */
+        template <typename T, typename Bathymetry = VariableBathymetry, typename Wetting = WetDry>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeEdge(T hl, T hr, T hul, T hur, T bl, T br, T sqrtHl, T sqrtHr, T ul, T ur, T fluxl, T fluxr,
+                T &hNetUpdatesLeft, T &hNetUpdatesRight, T &huNetUpdatesLeft, T &huNetUpdatesRight) {
+            const T zero = 0, half = 0.5, gravity = g;
+            T hSum = hl + hr;
+            T hlOriginal = hl, hrOriginal = hr;
+
+            if (Wetting::DRY_CELLS) {
+                // wet-dry reflection: the mirrored cell has the same height, root and flux and the opposite velocity.
+                // Dry-dry edges compute with dummy values and are masked out at the end.
+                // The masks are not stored in bool variables, so all lanes of the loop keep the width of T
+                T hlReflected = hl == zero ? hr : hl, hrReflected = hr == zero ? hl : hr;
+                T hulReflected = hl == zero ? -hur : hul, hurReflected = hr == zero ? -hul : hur;
+                T blReflected = hl == zero ? br : bl, brReflected = hr == zero ? bl : br;
+                T sqrtHlReflected = hl == zero ? sqrtHr : sqrtHl, sqrtHrReflected = hr == zero ? sqrtHl : sqrtHr;
+                T ulReflected = hl == zero ? -ur : ul, urReflected = hr == zero ? -ul : ur;
+                T fluxlReflected = hl == zero ? fluxr : fluxl, fluxrReflected = hr == zero ? fluxl : fluxr;
+                hl = hSum == zero ? (T) 1 : hlReflected;
+                hr = hSum == zero ? (T) 1 : hrReflected;
+                hul = hSum == zero ? zero : hulReflected;
+                hur = hSum == zero ? zero : hurReflected;
+                bl = blReflected;
+                br = brReflected;
+                sqrtHl = hSum == zero ? (T) 1 : sqrtHlReflected;
+                sqrtHr = hSum == zero ? (T) 1 : sqrtHrReflected;
+                ul = hSum == zero ? zero : ulReflected;
+                ur = hSum == zero ? zero : urReflected;
+                fluxl = hSum == zero ? zero : fluxlReflected;
+                fluxr = hSum == zero ? zero : fluxrReflected;
+            }
+
+            // roe eigenvalues
+            T pVelocity = (ul * sqrtHl + ur * sqrtHr) / (sqrtHl + sqrtHr);
+            T root = std::sqrt(gravity * (half * (hl + hr)));
+            T lambda0 = pVelocity - root, lambda1 = pVelocity + root;
+
+            // jump in the fluxes
+            T fluxDelta0 = hur - hul;
+            T fluxDelta1 = fluxr - fluxl;
+            if (Bathymetry::VARIABLE) {
+                T bathymetryeffect = -gravity * (br - bl) * ((hl + hr) / 2);
+                fluxDelta1 = fluxDelta1 - bathymetryeffect;
+            }
+
+            // eigencoefficients
+            T coefficient = (T) 1 / (lambda1 - lambda0);
+            T alpha0 = coefficient * (lambda1 * fluxDelta0 - fluxDelta1);
+            T alpha1 = coefficient * (-lambda0 * fluxDelta0 + fluxDelta1);
+
+            // upwinding as masked blends
+            T hLeft = (lambda0 < zero ? alpha0 : zero) + (lambda1 < zero ? alpha1 : zero);
+            T huLeft = (lambda0 < zero ? alpha0 * lambda0 : zero) + (lambda1 < zero ? alpha1 * lambda1 : zero);
+            T hRight = (lambda0 > zero ? alpha0 : zero) + (lambda1 > zero ? alpha1 : zero);
+            T huRight = (lambda0 > zero ? alpha0 * lambda0 : zero) + (lambda1 > zero ? alpha1 * lambda1 : zero);
+
+            // lambda0 <= lambda1, so both are positive if lambda0 is and both are negative if lambda1 is
+            T speed = std::max(std::fabs(lambda0), std::fabs(lambda1));
+            speed = lambda0 > zero ? lambda1 : speed;
+            speed = lambda1 < zero ? zero : speed;
+
+            if (!Wetting::DRY_CELLS) {
+                hNetUpdatesLeft = hLeft;
+                huNetUpdatesLeft = huLeft;
+                hNetUpdatesRight = hRight;
+                huNetUpdatesRight = huRight;
+                return speed;
+            }
+            hNetUpdatesLeft = hlOriginal == zero ? zero : hLeft;
+            huNetUpdatesLeft = hlOriginal == zero ? zero : huLeft;
+            hNetUpdatesRight = hrOriginal == zero ? zero : hRight;
+            huNetUpdatesRight = hrOriginal == zero ? zero : huRight;
+            return hSum == zero ? zero : speed;
+        }
+
+        /**
+         * Computes the net updates of a single edge without any branches.
          *
          * @param [in] hl The height of the left water column
          * @param [in] hr The height of the right water column
@@ -46,69 +197,1045 @@ namespace solver {
          * @param [out] hNetUpdatesRight The net update for the height of the right water column
          * @param [out] huNetUpdatesLeft The net update for the momentum of the left water column
          * @param [out] huNetUpdatesRight The net update for the momentum of the right water column
-         * @param [out] maxEdgeSpeed The maximum of the two waves speed values
+         * @return The maximum edge speed
+         */
+        template <typename T, typename Bathymetry = VariableBathymetry, typename Wetting = WetDry>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeEdge(T hl, T hr, T hul, T hur, T bl, T br,
+                T &hNetUpdatesLeft, T &hNetUpdatesRight, T &huNetUpdatesLeft, T &huNetUpdatesRight) {
+            T sqrtHl, sqrtHr, ul, ur, fluxl, fluxr;
+            computeCell<T, Wetting>(hl, hul, sqrtHl, ul, fluxl);
+            computeCell<T, Wetting>(hr, hur, sqrtHr, ur, fluxr);
+            return computeEdge<T, Bathymetry, Wetting>(hl, hr, hul, hur, bl, br, sqrtHl, sqrtHr, ul, ur, fluxl, fluxr,
+                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+        }
+
+        /**
+         * Computes the net updates of the edges [begin, end). Edge i lies between cell i and cell i+1.
+         * The values are converted to the compute type C after loading and back to T before storing.
          *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @return The maximum edge speed of all edges in the range
          */
-        void computeNetUpdates(const T &hl, const T &hr, const T &hul, const T &hur, const T bl, const T br, T &hNetUpdatesLeft, T &hNetUpdatesRight, T &huNetUpdatesLeft, T &huNetUpdatesRight,
-                T &maxEdgeSpeed) {
+        template <typename T, typename C>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeNetUpdates(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                unsigned int begin, unsigned int end,
+                T * __restrict hNetUpdatesLeft, T * __restrict hNetUpdatesRight,
+                T * __restrict huNetUpdatesLeft, T * __restrict huNetUpdatesRight) {
+            C maxEdgeSpeed = 0;
+            if (b) {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1], hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            } else {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], (C) 0, (C) 0, hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            }
+            return maxEdgeSpeed;
+        }
+
+        /**
+         * Computes the net updates of the edges [begin, end) with fixed bathymetry and wetting policies.
+         * Same as computeNetUpdates, but the kernel has no flat bathymetry branch and only contains the
+         * work its policies need: b is not read with FlatBathymetry, the selects of the wet-dry reflection
+         * and of the dry cells are gone with WetOnly.
+         *
+         * @see computeNetUpdates
+         */
+        template <typename T, typename C, typename Bathymetry, typename Wetting>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeNetUpdatesSpecialized(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                unsigned int begin, unsigned int end,
+                T * __restrict hNetUpdatesLeft, T * __restrict hNetUpdatesRight,
+                T * __restrict huNetUpdatesLeft, T * __restrict huNetUpdatesRight) {
+            C maxEdgeSpeed = 0;
+            if (Bathymetry::VARIABLE) {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C, Bathymetry, Wetting>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1],
+                            hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            } else {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C, Bathymetry, Wetting>(h[i], h[i + 1], hu[i], hu[i + 1], (C) 0, (C) 0,
+                            hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            }
+            return maxEdgeSpeed;
+        }
+
+        /**
+         * Computes the net updates of a single edge with the f-wave solver linearized around the state at rest:
+         * the roe eigenvalues are replaced by -sqrt(g * h) and sqrt(g * h) of the mean height. One wave always
+         * goes to the left and one to the right, so the particle velocity and the upwinding drop out and one
+         * square root and two divisions are saved. The flux jump is the same as in computeEdge, so the scheme
+         * stays conservative and well-balanced, the net updates differ from the f-wave solver by a fraction of
+         * the Froude number. Both cells have to be wet.
+         *
+         * @return An upper bound of the maximum edge speed of the f-wave solver
+         * @see computeEdge
+         */
+        template <typename T, typename Bathymetry>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeEdgeLinearized(T hl, T hr, T hul, T hur, T bl, T br,
+                T &hNetUpdatesLeft, T &hNetUpdatesRight, T &huNetUpdatesLeft, T &huNetUpdatesRight) {
+            const T half = 0.5, gravity = g;
+            T ul = hul / hl, ur = hur / hr;
+            T hMean = half * (hl + hr);
+            T root = std::sqrt(gravity * hMean);
+
+            T fluxDelta0 = hur - hul;
+            T fluxDelta1 = (hur * ur + half * gravity * hr * hr) - (hul * ul + half * gravity * hl * hl);
+            if (Bathymetry::VARIABLE)
+                fluxDelta1 = fluxDelta1 + gravity * (br - bl) * hMean;
+
+            // eigencoefficients of the eigenvalues -root and root
+            T surfaceWave = half * fluxDelta1 / root;
+            hNetUpdatesLeft = half * fluxDelta0 - surfaceWave;
+            hNetUpdatesRight = half * fluxDelta0 + surfaceWave;
+            huNetUpdatesLeft = -root * hNetUpdatesLeft;
+            huNetUpdatesRight = root * hNetUpdatesRight;
+            return root + std::max(std::fabs(ul), std::fabs(ur));
+        }
+
+        /**
+         * Computes the net updates of the edges [begin, end) with the linearized solver, see computeEdgeLinearized.
+         *
+         * @param [in] b The bathymetry of the cells, only read with VariableBathymetry
+         * @see computeNetUpdates
+         */
+        template <typename T, typename C, typename Bathymetry>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeNetUpdatesLinearized(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                unsigned int begin, unsigned int end,
+                T * __restrict hNetUpdatesLeft, T * __restrict hNetUpdatesRight,
+                T * __restrict huNetUpdatesLeft, T * __restrict huNetUpdatesRight) {
+            C maxEdgeSpeed = 0;
+#pragma omp simd reduction(max:maxEdgeSpeed)
+            for (std::size_t i = begin; i < end; i++) {
+                C hLeft, hRight, huLeft, huRight;
+                C speed = computeEdgeLinearized<C, Bathymetry>(h[i], h[i + 1], hu[i], hu[i + 1],
+                        Bathymetry::VARIABLE ? (C) b[i] : (C) 0, Bathymetry::VARIABLE ? (C) b[i + 1] : (C) 0,
+                        hLeft, hRight, huLeft, huRight);
+                hNetUpdatesLeft[i] = hLeft;
+                hNetUpdatesRight[i] = hRight;
+                huNetUpdatesLeft[i] = huLeft;
+                huNetUpdatesRight[i] = huRight;
+                maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+            }
+            return maxEdgeSpeed;
+        }
+
+        /** The classes of edge ranges, see classifyEdges */
+        enum EdgeClass {
+            /** All cells are wet, the flow is slow and the surface almost flat: the linearized solver is enough */
+            SMOOTH_EDGES,
+            /** All cells are wet, but there are shocks, fast flows or steep waves */
+            WET_EDGES,
+            /** At least one cell is dry */
+            DRY_EDGES
+        };
+
+        /**
+         * @param [in] froude2 The square of the maximum Froude number times g
+         * @param [in] maxJump The maximum jump of the surface relative to the smaller height
+         * @return 1 if the edge is too rough for the linearized solver, 0 otherwise
+         */
+        template <typename T>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T classifyEdge(T hl, T hr, T hul, T hur, T bl, T br, T froude2, T maxJump) {
+            const T zero = 0, one = 1;
+            // |u| <= maxFroude * sqrt(g * h) without a division and a square root
+            T rough = std::fabs((hr + br) - (hl + bl)) > maxJump * std::min(hl, hr) ? one : zero;
+            rough = hul * hul > froude2 * hl * hl * hl ? one : rough;
+            rough = hur * hur > froude2 * hr * hr * hr ? one : rough;
+            return rough;
+        }
+
+        /**
+         * Decides which solver the edges [begin, end) need. The range is smooth if the Froude number of all cells
+         * is at most maxFroude and the jump of the surface h + b at every edge is at most maxJump times the smaller
+         * of the two heights.
+         *
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @return The EdgeClass of the whole range
+         */
+        template <typename T, typename C>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline int classifyEdges(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                unsigned int begin, unsigned int end, C maxFroude, C maxJump) {
+            const C froude2 = maxFroude * maxFroude * (C) g;
+            C minHeight = h[begin], rough = 0;
+            if (b) {
+#pragma omp simd reduction(min:minHeight) reduction(max:rough)
+                for (std::size_t i = begin; i < end; i++) {
+                    minHeight = std::min(minHeight, (C) h[i + 1]);
+                    rough = std::max(rough, classifyEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1], froude2, maxJump));
+                }
+            } else {
+#pragma omp simd reduction(min:minHeight) reduction(max:rough)
+                for (std::size_t i = begin; i < end; i++) {
+                    minHeight = std::min(minHeight, (C) h[i + 1]);
+                    rough = std::max(rough, classifyEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], (C) 0, (C) 0, froude2, maxJump));
+                }
+            }
+            if (minHeight <= 0)
+                return DRY_EDGES;
+            return rough > 0 ? WET_EDGES : SMOOTH_EDGES;
+        }
+
+        /**
+         * Computes the quantities of the cells [begin, end) which are shared by both edges of a cell.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The momentums of the water columns
+         * @param [in] begin The first cell
+         * @param [in] end One past the last cell
+         * @param [out] sqrtH The square roots of the heights
+         * @param [out] u The particle velocities
+         * @param [out] flux The momentum fluxes
+         */
+        template <typename T, typename C>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline void computeCells(const T * __restrict h, const T * __restrict hu, unsigned int begin, unsigned int end,
+                C * __restrict sqrtH, C * __restrict u, C * __restrict flux) {
+#pragma omp simd
+            for (std::size_t i = begin; i < end; i++)
+                computeCell<C>(h[i], hu[i], sqrtH[i], u[i], flux[i]);
+        }
+
+        /**
+         * Computes the net updates of the edges [begin, end) from the quantities of the cells [begin, end],
+         * see computeCells.
+         *
+         * @return The maximum edge speed of all edges in the range
+         */
+        template <typename T, typename C>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline T computeNetUpdates(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                const C * __restrict sqrtH, const C * __restrict u, const C * __restrict flux,
+                unsigned int begin, unsigned int end,
+                T * __restrict hNetUpdatesLeft, T * __restrict hNetUpdatesRight,
+                T * __restrict huNetUpdatesLeft, T * __restrict huNetUpdatesRight) {
+            C maxEdgeSpeed = 0;
+            if (b) {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1],
+                            sqrtH[i], sqrtH[i + 1], u[i], u[i + 1], flux[i], flux[i + 1], hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            } else {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+                for (std::size_t i = begin; i < end; i++) {
+                    C hLeft, hRight, huLeft, huRight;
+                    C speed = computeEdge<C>(h[i], h[i + 1], hu[i], hu[i + 1], (C) 0, (C) 0,
+                            sqrtH[i], sqrtH[i + 1], u[i], u[i + 1], flux[i], flux[i + 1], hLeft, hRight, huLeft, huRight);
+                    hNetUpdatesLeft[i] = hLeft;
+                    hNetUpdatesRight[i] = hRight;
+                    huNetUpdatesLeft[i] = huLeft;
+                    huNetUpdatesRight[i] = huRight;
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, speed);
+                }
+            }
+            return maxEdgeSpeed;
+        }
+
+        /**
+         * Computes the net updates of the edges [begin, end) of an ensemble of simulations which are stored
+         * interleaved: the value of cell i of member m is stored at index i * members + m. The inner loop runs
+         * over the members, so every vector lane computes the same edge of another member with the same
+         * instructions as computeNetUpdates.
+         *
+         * @param [in] members The number of members
+         * @param [in,out] maxEdgeSpeed The maximum edge speed of every member, raised to the maximum of the edges in the range
+         * @see computeNetUpdates
+         */
+        template <typename T, typename C>
+#if defined(__GNUC__)
+        __attribute__((always_inline))
+#endif
+        inline void computeNetUpdatesInterleaved(const T * __restrict h, const T * __restrict hu, const T * __restrict b,
+                unsigned int members, unsigned int begin, unsigned int end,
+                T * __restrict hNetUpdatesLeft, T * __restrict hNetUpdatesRight,
+                T * __restrict huNetUpdatesLeft, T * __restrict huNetUpdatesRight, T * __restrict maxEdgeSpeed) {
+            for (std::size_t i = begin; i < end; i++) {
+                const std::size_t offset = i * members;
+                if (b) {
+#pragma omp simd
+                    for (std::size_t m = 0; m < members; m++) {
+                        const std::size_t left = offset + m, right = left + members;
+                        C hLeft, hRight, huLeft, huRight;
+                        C speed = computeEdge<C>(h[left], h[right], hu[left], hu[right], b[left], b[right], hLeft, hRight, huLeft, huRight);
+                        hNetUpdatesLeft[left] = hLeft;
+                        hNetUpdatesRight[left] = hRight;
+                        huNetUpdatesLeft[left] = huLeft;
+                        huNetUpdatesRight[left] = huRight;
+                        const T current = maxEdgeSpeed[m];
+                        maxEdgeSpeed[m] = (T) speed > current ? (T) speed : current;
+                    }
+                } else {
+#pragma omp simd
+                    for (std::size_t m = 0; m < members; m++) {
+                        const std::size_t left = offset + m, right = left + members;
+                        C hLeft, hRight, huLeft, huRight;
+                        C speed = computeEdge<C>(h[left], h[right], hu[left], hu[right], (C) 0, (C) 0, hLeft, hRight, huLeft, huRight);
+                        hNetUpdatesLeft[left] = hLeft;
+                        hNetUpdatesRight[left] = hRight;
+                        huNetUpdatesLeft[left] = huLeft;
+                        huNetUpdatesRight[left] = huRight;
+                        const T current = maxEdgeSpeed[m];
+                        maxEdgeSpeed[m] = (T) speed > current ? (T) speed : current;
+                    }
+                }
+            }
+        }
+
+        /**
+         * The variants of all kernels for one instruction set.
+         * Every member function is compiled for the instruction set TARGET.
+         */
+#define FWAVE_KERNELS(NAME, TARGET) \
+        template <typename T, typename C> struct NAME { \
+            TARGET static T computeNetUpdates(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end, \
+                    T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight) { \
+                return kernel::computeNetUpdates<T, C>(h, hu, b, begin, end, hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight); \
+            } \
+            TARGET static void computeCells(const T *h, const T *hu, unsigned int begin, unsigned int end, C *sqrtH, C *u, C *flux) { \
+                kernel::computeCells<T, C>(h, hu, begin, end, sqrtH, u, flux); \
+            } \
+            TARGET static T computeNetUpdatesCached(const T *h, const T *hu, const T *b, const C *sqrtH, const C *u, const C *flux, \
+                    unsigned int begin, unsigned int end, T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight) { \
+                return kernel::computeNetUpdates<T, C>(h, hu, b, sqrtH, u, flux, begin, end, \
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight); \
+            } \
+            TARGET static void computeNetUpdatesInterleaved(const T *h, const T *hu, const T *b, unsigned int members, \
+                    unsigned int begin, unsigned int end, T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, \
+                    T *maxEdgeSpeed) { \
+                kernel::computeNetUpdatesInterleaved<T, C>(h, hu, b, members, begin, end, \
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, maxEdgeSpeed); \
+            } \
+            template <typename Bathymetry, typename Wetting> \
+            TARGET static T computeNetUpdatesSpecialized(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end, \
+                    T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight) { \
+                return kernel::computeNetUpdatesSpecialized<T, C, Bathymetry, Wetting>(h, hu, b, begin, end, \
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight); \
+            } \
+            template <typename Bathymetry> \
+            TARGET static T computeNetUpdatesLinearized(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end, \
+                    T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight) { \
+                return kernel::computeNetUpdatesLinearized<T, C, Bathymetry>(h, hu, b, begin, end, \
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight); \
+            } \
+            TARGET static int classifyEdges(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end, \
+                    T maxFroude, T maxJump) { \
+                return kernel::classifyEdges<T, C>(h, hu, b, begin, end, maxFroude, maxJump); \
+            } \
+        };
+
+        FWAVE_KERNELS(Generic, )
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FWAVE_RUNTIME_DISPATCH 1
+        FWAVE_KERNELS(SSE, __attribute__((target("sse4.2"))))
+        FWAVE_KERNELS(AVX2, __attribute__((target("avx2,fma"))))
+        FWAVE_KERNELS(AVX512, __attribute__((target("avx512f"))))
+#endif
+
+        /** The variants of the kernels for the instruction set of this cpu */
+        template <typename T, typename C> struct Kernels {
+            T (*computeNetUpdates)(const T *, const T *, const T *, unsigned int, unsigned int, T *, T *, T *, T *);
+            void (*computeCells)(const T *, const T *, unsigned int, unsigned int, C *, C *, C *);
+            T (*computeNetUpdatesCached)(const T *, const T *, const T *, const C *, const C *, const C *,
+                    unsigned int, unsigned int, T *, T *, T *, T *);
+            void (*computeNetUpdatesInterleaved)(const T *, const T *, const T *, unsigned int, unsigned int, unsigned int,
+                    T *, T *, T *, T *, T *);
+            /** Indexed by [Bathymetry::VARIABLE][Wetting::DRY_CELLS], variable bathymetry with wet-dry handling is the generic kernel */
+            T (*computeNetUpdatesSpecialized[2][2])(const T *, const T *, const T *, unsigned int, unsigned int, T *, T *, T *, T *);
+            /** Indexed by [Bathymetry::VARIABLE] */
+            T (*computeNetUpdatesLinearized[2])(const T *, const T *, const T *, unsigned int, unsigned int, T *, T *, T *, T *);
+            int (*classifyEdges)(const T *, const T *, const T *, unsigned int, unsigned int, T, T);
+
+            template <typename Variant> static Kernels of() {
+                Kernels kernels = {&Variant::computeNetUpdates, &Variant::computeCells, &Variant::computeNetUpdatesCached,
+                        &Variant::computeNetUpdatesInterleaved,
+                        {{&Variant::template computeNetUpdatesSpecialized<FlatBathymetry, WetOnly>,
+                          &Variant::template computeNetUpdatesSpecialized<FlatBathymetry, WetDry>},
+                         {&Variant::template computeNetUpdatesSpecialized<VariableBathymetry, WetOnly>,
+                          &Variant::computeNetUpdates}},
+                        {&Variant::template computeNetUpdatesLinearized<FlatBathymetry>,
+                         &Variant::template computeNetUpdatesLinearized<VariableBathymetry>},
+                        &Variant::classifyEdges};
+                return kernels;
+            }
+        };
+
+        /**
+         * @return The variants of the kernels for the best instruction set supported by this cpu
+         */
+        template <typename T, typename C> Kernels<T, C> selectKernels() {
+#ifdef FWAVE_RUNTIME_DISPATCH
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return Kernels<T, C>::template of<AVX512<T, C> >();
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Kernels<T, C>::template of<AVX2<T, C> >();
+            if (__builtin_cpu_supports("sse4.2"))
+                return Kernels<T, C>::template of<SSE<T, C> >();
+#endif
+            return Kernels<T, C>::template of<Generic<T, C> >();
+        }
+    }
+
+    /**
+     * The result of a single edge evaluation of the f-wave solver.
+     *
+     * Lives on the stack, so the solver does not need to keep any state between two calls.
+     */
+    template <typename T> struct NetUpdates {
+        /** The net update for the height of the left water column */
+        T hNetUpdatesLeft;
+        /** The net update for the height of the right water column */
+        T hNetUpdatesRight;
+        /** The net update for the momentum of the left water column */
+        T huNetUpdatesLeft;
+        /** The net update for the momentum of the right water column */
+        T huNetUpdatesRight;
+        /** The maximum of the two wave speed values */
+        T maxEdgeSpeed;
+        /** The roe eigenvalues used to compute the updates */
+        T roeEigenvalues[2];
+    };
+
+    /**
+     * The number of edges which FWave::computeNetUpdatesHybrid has passed to each solver.
+     */
+    struct HybridStatistics {
+        /** Edges in smooth regions, computed by the linearized solver */
+        unsigned long linearizedEdges;
+        /** Wet edges which needed the full f-wave solver */
+        unsigned long wetEdges;
+        /** Edges in ranges with dry cells, computed by the f-wave solver with the wet-dry handling */
+        unsigned long wetDryEdges;
+
+        HybridStatistics() : linearizedEdges(0), wetEdges(0), wetDryEdges(0) {
+        }
+    };
+
+    template <typename T, typename C> class FWave;
+
+    /**
+     * Precision policy of a simulation.
+     *
+     * All arrays (heights, momentums, bathymetry and net updates) and the values of the scenarios are
+     * stored as Storage, the solver computes in Compute. Precision<float, double> halves the bytes per
+     * cell compared to Precision<double> while keeping the sensitive arithmetic in double.
+     */
+    template <typename Storage, typename Compute = Storage> struct Precision {
+        typedef Storage StorageType;
+        typedef Compute ComputeType;
+        typedef FWave<Storage, Compute> Solver;
+    };
+
+    /**
+     * A basic f-wave solver which computes net updates for two given wave vectors.
+     *
+     * The solver is stateless: every method is const and does not allocate, so a single
+     * instance can be shared between any number of threads.
+     *
+     * T is the type of all values passed in and out of the solver (and of the arrays of the
+     * wave propagation), C the type of the sensitive arithmetic: the jump in the fluxes, the roe
+     * eigenvalues, the eigencoefficients, the batched kernels and the update of the unknowns.
+     * FWave<float, double> halves the memory traffic of FWave<double> but avoids the cancellation
+     * in the flux jump of a pure float solver.
+     */
+    template <typename T, typename C = T> class FWave {
+    public:
+
+        /** \brief Computes the net updates and the maxiumum edge speed for a given set of parameters.
+         *
+         * Computes the net updates and the maximum edge speed for a given set of water columns and bathymetry values.
+         * The roe eigenvalues which are calculated during the computation of the updates are returned as well.
+         *
+         * If exactly one of the water columns is dry, the reflecting (wet-dry) boundary condition is applied and
+         * the updates of the dry cell are set to zero. If both water columns are dry, all updates are zero.
+         *
+         * @param [in] hl The height of the left water column
+         * @param [in] hr The height of the right water column
+         * @param [in] hul The space time dependent momentum of the left water column
+         * @param [in] hur The space time dependent momentum of the right water column
+         * @param [in] bl The first bathymetry component
+         * @param [in] br The second bathymetry component
+         * @return The net updates, the maximum edge speed and the roe eigenvalues
+         */
+        NetUpdates<T> computeNetUpdates(T hl, T hr, T hul, T hur, T bl, T br) const {
+            NetUpdates<T> result;
             // reset all the output parameters to 0
-            hNetUpdatesLeft = hNetUpdatesRight = huNetUpdatesLeft = huNetUpdatesRight = maxEdgeSpeed = (T) 0;
+            result.hNetUpdatesLeft = result.hNetUpdatesRight = result.huNetUpdatesLeft = result.huNetUpdatesRight = result.maxEdgeSpeed = (T) 0;
+            result.roeEigenvalues[0] = result.roeEigenvalues[1] = (T) 0;
             // The height should not be negative
             assert(hl >= 0 && hr >= 0);
-            computeBoundaryConditions(hl, hr, hul, bl, br);
+            if (hl == 0 && hr == 0)
+                return result;
+            bool leftIsDry = hl == 0;
+            bool rightIsDry = hr == 0;
+            computeBoundaryConditions(hl, hr, hul, hur, bl, br);
 
-            updateRoeEigenvalues(hl, hr, hul, hur);
-            T *fluxDeltaValues = new T[2]();
-            computeFluxDeltaValues(hl, hr, hul, hur, bl, br fluxDeltaValues);
-            T *alpha = new T[2]();
-            computeEigencoefficients(hl, hr, fluxDeltaValues, alpha);
-            delete [] fluxDeltaValues;
-
-            T **z = new T*[2];
-            for (int i = 0; i < 2; i++)
-                z[i] = new T[2]();
+            C roeEigenvalues[2];
+            computeRoeEigenvalues(hl, hr, hul, hur, roeEigenvalues);
+            C fluxDeltaValues[2];
+            computeFluxDeltaValues(hl, hr, hul, hur, bl, br, fluxDeltaValues);
+            C alpha[2];
+            computeEigencoefficients(hl, hr, roeEigenvalues, fluxDeltaValues, alpha);
 
             // compute the wave vectors
+            C z[2][2];
             z[0][0] = alpha[0];
             z[0][1] = alpha[0] * roeEigenvalues[0];
             z[1][0] = alpha[1];
             z[1][1] = alpha[1] * roeEigenvalues[1];
-            delete [] alpha;
 
+            // the net updates are summed up in C as well and only rounded to T once
+            C netUpdates[4] = {0, 0, 0, 0};
             for (int i = 0; i < 2; i++) {
                 if (roeEigenvalues[i] < 0) {
-                    hNetUpdatesLeft += z[i][0];
-                    huNetUpdatesLeft += z[i][1];
+                    netUpdates[0] += z[i][0];
+                    netUpdates[2] += z[i][1];
                 } else if (roeEigenvalues[i] > 0) {
-                    hNetUpdatesRight += z[i][0];
-                    huNetUpdatesRight += z[i][1];
+                    netUpdates[1] += z[i][0];
+                    netUpdates[3] += z[i][1];
                 }
             }
+            result.hNetUpdatesLeft = netUpdates[0];
+            result.hNetUpdatesRight = netUpdates[1];
+            result.huNetUpdatesLeft = netUpdates[2];
+            result.huNetUpdatesRight = netUpdates[3];
+            result.roeEigenvalues[0] = roeEigenvalues[0];
+            result.roeEigenvalues[1] = roeEigenvalues[1];
+
+            // the reflected waves must not change the dry cell
+            if (leftIsDry)
+                result.hNetUpdatesLeft = result.huNetUpdatesLeft = (T) 0;
+            else if (rightIsDry)
+                result.hNetUpdatesRight = result.huNetUpdatesRight = (T) 0;
 
-            if (roeEigenvalues[0] > 0 && roeEigenvalues[1] > 0)
-                maxEdgeSpeed = roeEigenvalues[1];
-            else if (roeEigenvalues[0] < 0 && roeEigenvalues[1] < 0)
-                maxEdgeSpeed = 0;
+            if (result.roeEigenvalues[0] > 0 && result.roeEigenvalues[1] > 0)
+                result.maxEdgeSpeed = result.roeEigenvalues[1];
+            else if (result.roeEigenvalues[0] < 0 && result.roeEigenvalues[1] < 0)
+                result.maxEdgeSpeed = 0;
             else
-                maxEdgeSpeed = std::max(std::fabs(roeEigenvalues[0]), std::fabs(roeEigenvalues[1]));
+                result.maxEdgeSpeed = std::max(std::fabs(result.roeEigenvalues[0]), std::fabs(result.roeEigenvalues[1]));
+            return result;
+        }
+
+        /** \brief Computes the net updates and the maxiumum edge speed for a given set of parameters.
+         *
+         * Convenience overload of computeNetUpdates(T, T, T, T, T, T) which writes the results into
+         * output parameters.
+         *
+         * @param [in] hl The height of the left water column
+         * @param [in] hr The height of the right water column
+         * @param [in] hul The space time dependent momentum of the left water column
+         * @param [in] hur The space time dependent momentum of the right water column
+         * @param [in] bl The first bathymetry component
+         * @param [in] br The second bathymetry component
+         * @param [out] hNetUpdatesLeft The net update for the height of the left water column
+         * @param [out] hNetUpdatesRight The net update for the height of the right water column
+         * @param [out] huNetUpdatesLeft The net update for the momentum of the left water column
+         * @param [out] huNetUpdatesRight The net update for the momentum of the right water column
+         * @param [out] maxEdgeSpeed The maximum of the two waves speed values
+         *
+         */
+        void computeNetUpdates(const T &hl, const T &hr, const T &hul, const T &hur, const T bl, const T br, T &hNetUpdatesLeft, T &hNetUpdatesRight, T &huNetUpdatesLeft, T &huNetUpdatesRight,
+                T &maxEdgeSpeed) const {
+            NetUpdates<T> result = computeNetUpdates(hl, hr, hul, hur, bl, br);
+            hNetUpdatesLeft = result.hNetUpdatesLeft;
+            hNetUpdatesRight = result.hNetUpdatesRight;
+            huNetUpdatesLeft = result.huNetUpdatesLeft;
+            huNetUpdatesRight = result.huNetUpdatesRight;
+            maxEdgeSpeed = result.maxEdgeSpeed;
+        }
+
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges.
+         *
+         * Vectorized counterpart of computeNetUpdates(T, T, T, T, T, T) for contiguous arrays of water columns.
+         * Edge i lies between cell i and cell i+1, its net updates are stored at index i of the output arrays.
+         * The instruction set (SSE, AVX2 or AVX-512) is selected once at runtime. With SWE_INSTRUMENTATION, the
+         * kernel is timed and the edges are counted and classified in a separate pass afterwards.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @param [out] maxEdgeSpeed The maximum edge speed of all edges in the range
+         */
+        void computeNetUpdates(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed) const {
+            {
+                SWE_INSTRUMENT_PHASE(NET_UPDATES);
+                maxEdgeSpeed = kernels().computeNetUpdates(h, hu, b, begin, end, hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+            }
+            SWE_INSTRUMENT_EDGES(h, hu, begin, end, 1);
+        }
+
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges with fixed policies.
+         *
+         * Same as computeNetUpdates(const T *, const T *, const T *, unsigned int, unsigned int, ...), but the kernel
+         * is specialized for the bathymetry policy (FlatBathymetry or VariableBathymetry) and the wetting policy
+         * (WetOnly or WetDry) of the simulation. VariableBathymetry with WetDry computes the same as the generic kernel.
+         *
+         * @param [in] b The bathymetry of the cells, only read with VariableBathymetry
+         * @see computeNetUpdates(const T *, const T *, const T *, unsigned int, unsigned int, T *, T *, T *, T *, T &)
+         */
+        template <typename Bathymetry, typename Wetting>
+        void computeNetUpdatesSpecialized(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed) const {
+            {
+                SWE_INSTRUMENT_PHASE(NET_UPDATES);
+                maxEdgeSpeed = kernels().computeNetUpdatesSpecialized[Bathymetry::VARIABLE][Wetting::DRY_CELLS](h, hu, b, begin, end,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+            }
+            SWE_INSTRUMENT_EDGES(h, hu, begin, end, 1);
+        }
+
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges with the cheapest suitable solver.
+         *
+         * The range is split into chunks of 64 edges. Every chunk is classified first (see kernel::classifyEdges):
+         * chunks with dry cells go to the f-wave kernel with the wet-dry handling, wet chunks with shocks or fast
+         * flows to the wet-only f-wave kernel and smooth chunks, e.g. a quiescent deep ocean, to the linearized
+         * solver (see kernel::computeEdgeLinearized). The edges of a chunk are always computed by the same
+         * contiguous vectorized kernel. In the smooth regions, the net updates differ from computeNetUpdates by
+         * about maxFroude times the update itself, the maximum edge speed is an upper bound of the f-wave speed.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @param [out] maxEdgeSpeed The maximum edge speed of all edges in the range
+         * @param [in,out] statistics The edges of the range are added to the counter of their solver
+         * @param [in] maxFroude The maximum Froude number |u| / sqrt(g * h) of a smooth cell
+         * @param [in] maxJump The maximum jump of the surface h + b at a smooth edge, relative to the smaller height
+         */
+        void computeNetUpdatesHybrid(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed,
+                HybridStatistics &statistics, T maxFroude = 0.01, T maxJump = 0.01) const {
+            const unsigned int edgesPerChunk = 64;
+            const kernel::Kernels<T, C> &selected = kernels();
+            const bool variable = b != 0;
+            maxEdgeSpeed = 0;
+            {
+                SWE_INSTRUMENT_PHASE(NET_UPDATES);
+                for (unsigned int chunkBegin = begin; chunkBegin < end; chunkBegin += edgesPerChunk) {
+                    unsigned int chunkEnd = std::min(chunkBegin + edgesPerChunk, end);
+                    T chunkMaxEdgeSpeed;
+                    switch (selected.classifyEdges(h, hu, b, chunkBegin, chunkEnd, maxFroude, maxJump)) {
+                        case kernel::SMOOTH_EDGES:
+                            chunkMaxEdgeSpeed = selected.computeNetUpdatesLinearized[variable](h, hu, b, chunkBegin, chunkEnd,
+                                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+                            statistics.linearizedEdges += chunkEnd - chunkBegin;
+                            break;
+                        case kernel::WET_EDGES:
+                            chunkMaxEdgeSpeed = selected.computeNetUpdatesSpecialized[variable][0](h, hu, b, chunkBegin, chunkEnd,
+                                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+                            statistics.wetEdges += chunkEnd - chunkBegin;
+                            break;
+                        default:
+                            chunkMaxEdgeSpeed = selected.computeNetUpdates(h, hu, b, chunkBegin, chunkEnd,
+                                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+                            statistics.wetDryEdges += chunkEnd - chunkBegin;
+                    }
+                    maxEdgeSpeed = std::max(maxEdgeSpeed, chunkMaxEdgeSpeed);
+                }
+            }
+            SWE_INSTRUMENT_EDGES(h, hu, begin, end, 1);
+        }
+
+        /** \brief Computes the quantities of a range of cells which are shared by both edges of a cell.
+         *
+         * Every cell lies on two edges. Computing its square root, velocity and momentum flux once per cell
+         * instead of once per edge saves two square roots and two divisions per edge, see
+         * computeNetUpdates(const T *, const T *, const T *, const C *, const C *, const C *, ...).
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] begin The first cell
+         * @param [in] end One past the last cell
+         * @param [out] sqrtH The square roots of the heights
+         * @param [out] u The particle velocities, 0 for dry cells
+         * @param [out] flux The momentum fluxes hu * u + g * h^2 / 2
+         */
+        void computeCellQuantities(const T *h, const T *hu, unsigned int begin, unsigned int end, C *sqrtH, C *u, C *flux) const {
+            kernels().computeCells(h, hu, begin, end, sqrtH, u, flux);
+        }
+
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges from precomputed cell quantities.
+         *
+         * Same as computeNetUpdates(const T *, const T *, const T *, unsigned int, unsigned int, ...), but the square roots,
+         * velocities and momentum fluxes of the cells [begin, end] are taken from computeCellQuantities.
+         * Only the roe averages are left per edge.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] sqrtH The square roots of the heights
+         * @param [in] u The particle velocities
+         * @param [in] flux The momentum fluxes
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @param [out] maxEdgeSpeed The maximum edge speed of all edges in the range
+         */
+        void computeNetUpdates(const T *h, const T *hu, const T *b, const C *sqrtH, const C *u, const C *flux, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed) const {
+            {
+                SWE_INSTRUMENT_PHASE(NET_UPDATES);
+                maxEdgeSpeed = kernels().computeNetUpdatesCached(h, hu, b, sqrtH, u, flux, begin, end,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight);
+            }
+            SWE_INSTRUMENT_EDGES(h, hu, begin, end, 1);
+        }
+
+        /** \brief Computes the net updates and the maximum edge speeds of an ensemble of simulations.
+         *
+         * The members of the ensemble are stored interleaved: cell i of member m is stored at index i * members + m
+         * of all arrays, including the net updates. One vectorized pass over the members advances all of them at
+         * once, the edge of every member is computed with the same operations as in computeNetUpdates.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] members The number of members
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @param [out] maxEdgeSpeed The maximum edge speed of every member in the range
+         */
+        void computeNetUpdatesInterleaved(const T *h, const T *hu, const T *b, unsigned int members, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T *maxEdgeSpeed) const {
+            std::fill(maxEdgeSpeed, maxEdgeSpeed + members, (T) 0);
+            {
+                SWE_INSTRUMENT_PHASE(NET_UPDATES);
+                kernels().computeNetUpdatesInterleaved(h, hu, b, members, begin, end,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, maxEdgeSpeed);
+            }
+            SWE_INSTRUMENT_EDGES(h, hu, begin * members, end * members, members);
+        }
+
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges using all threads.
+         *
+         * Splits the range into chunks of EDGES_PER_CHUNK edges which are distributed statically over the OpenMP
+         * threads. Every thread reduces the maximum edge speed of its own chunks, the partial maxima are combined
+         * by the OpenMP max-reduction. Since every edge is computed independently and the maximum is exact, the
+         * results are bit-for-bit identical to computeNetUpdates() for any number of threads.
+         * Without OpenMP support, the chunks are processed one after the other.
+         *
+         * With a bitmap of dry chunks, a chunk whose cells are all dry is not solved: all its net updates and its
+         * edge speeds are zero. The net updates are only cleared if the chunk was not dry in the previous call, so
+         * the bitmap has to be kept with the net update arrays between the calls and start with all flags cleared.
+         *
+         * @param [in] h The heights of the water columns
+         * @param [in] hu The space time dependent momentums of the water columns
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [out] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [out] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [out] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [out] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @param [out] maxEdgeSpeed The maximum edge speed of all edges in the range
+         * @param [in,out] dryChunks One flag per chunk, set if the chunk was dry in the previous call, or NULL to solve all edges
+         */
+        void computeNetUpdatesParallel(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed,
+                unsigned char *dryChunks = 0) const {
+            computeNetUpdatesSpecializedParallel<VariableBathymetry, WetDry>(h, hu, b, begin, end,
+                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, maxEdgeSpeed, dryChunks);
         }
 
-        /** \brief Updates the stored roe eigenvalues.
+        /** \brief Computes the net updates and the maximum edge speed for a range of edges with fixed policies using all threads.
+         *
+         * Same as computeNetUpdatesParallel(), but every chunk is computed by computeNetUpdatesSpecialized().
+         * WetOnly has no dry cells, so the bitmap of dry chunks is ignored.
+         *
+         * @see computeNetUpdatesParallel
+         * @see computeNetUpdatesSpecialized
+         */
+        template <typename Bathymetry, typename Wetting>
+        void computeNetUpdatesSpecializedParallel(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, T &maxEdgeSpeed,
+                unsigned char *dryChunks = 0) const {
+            const int numberOfChunks = end > begin ? (end - begin + EDGES_PER_CHUNK - 1) / EDGES_PER_CHUNK : 0;
+            T maxSpeed = 0;
+#pragma omp parallel for schedule(static) reduction(max:maxSpeed)
+            for (int chunk = 0; chunk < numberOfChunks; chunk++)
+                maxSpeed = std::max(maxSpeed, computeNetUpdatesChunk<Bathymetry, Wetting>(h, hu, b, begin, end, chunk,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, dryChunks));
+            maxEdgeSpeed = maxSpeed;
+        }
+
+        /** \brief Computes the net updates of one chunk of computeNetUpdatesSpecializedParallel().
+         *
+         * Lets a caller distribute the chunks with its own scheduler, e.g. a TileScheduler which balances the
+         * threads when the dry chunks are skipped. Chunk k holds the edges [begin + k * EDGES_PER_CHUNK,
+         * begin + (k + 1) * EDGES_PER_CHUNK) up to end.
+         *
+         * @see computeNetUpdatesSpecializedParallel
+         * @param [in] chunk The chunk
+         * @return The maximum edge speed of the chunk
+         */
+        template <typename Bathymetry, typename Wetting>
+        T computeNetUpdatesChunk(const T *h, const T *hu, const T *b, unsigned int begin, unsigned int end, unsigned int chunk,
+                T *hNetUpdatesLeft, T *hNetUpdatesRight, T *huNetUpdatesLeft, T *huNetUpdatesRight, unsigned char *dryChunks = 0) const {
+            unsigned int chunkBegin = begin + chunk * EDGES_PER_CHUNK;
+            unsigned int chunkEnd = std::min(chunkBegin + EDGES_PER_CHUNK, end);
+            if (Wetting::DRY_CELLS && dryChunks) {
+                // the edges of the chunk touch the cells chunkBegin to chunkEnd, a wet chunk usually stops at its first cell
+                unsigned int cell = chunkBegin;
+                while (cell <= chunkEnd && h[cell] == 0)
+                    cell++;
+                if (cell > chunkEnd) {
+                    // the kernel computes zero net updates and speeds for dry-dry edges
+                    if (!dryChunks[chunk]) {
+                        std::fill(hNetUpdatesLeft + chunkBegin, hNetUpdatesLeft + chunkEnd, (T) 0);
+                        std::fill(hNetUpdatesRight + chunkBegin, hNetUpdatesRight + chunkEnd, (T) 0);
+                        std::fill(huNetUpdatesLeft + chunkBegin, huNetUpdatesLeft + chunkEnd, (T) 0);
+                        std::fill(huNetUpdatesRight + chunkBegin, huNetUpdatesRight + chunkEnd, (T) 0);
+                        dryChunks[chunk] = 1;
+                    }
+                    return 0;
+                }
+                dryChunks[chunk] = 0;
+            }
+            T chunkMaxEdgeSpeed;
+            computeNetUpdatesSpecialized<Bathymetry, Wetting>(h, hu, b, chunkBegin, chunkEnd,
+                    hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, chunkMaxEdgeSpeed);
+            return chunkMaxEdgeSpeed;
+        }
+
+        /** \brief Applies the net updates of the edges [0, size] to the cells [1, size] using all threads.
+         *
+         * Second half of a thread-parallel time step after computeNetUpdatesParallel(): cell i lies between
+         * edge i-1 and edge i. The cells are split into chunks of EDGES_PER_CHUNK cells with the same static
+         * schedule as the edges, so a thread mostly updates the cells whose net updates it has just computed.
+         * Every cell is updated independently in the compute type C and the minimum is exact, so the result
+         * does not depend on the number of threads. The ghost cells 0 and size+1 are not changed.
+         *
+         * @param [in,out] h The heights of the water columns including one ghost cell on each side
+         * @param [in,out] hu The space time dependent momentums of the water columns including the ghost cells
+         * @param [in] size The number of cells without the ghost cells
+         * @param [in] dt The time step
+         * @param [in] cellSize The size of one cell
+         * @param [in] hNetUpdatesLeft The net updates for the height of the left water columns
+         * @param [in] hNetUpdatesRight The net updates for the height of the right water columns
+         * @param [in] huNetUpdatesLeft The net updates for the momentum of the left water columns
+         * @param [in] huNetUpdatesRight The net updates for the momentum of the right water columns
+         * @return The smallest height after the update, e.g. to detect cells which fell dry
+         */
+        T updateUnknownsParallel(T *h, T *hu, unsigned int size, T dt, T cellSize,
+                const T *hNetUpdatesLeft, const T *hNetUpdatesRight, const T *huNetUpdatesLeft, const T *huNetUpdatesRight) const {
+            const int numberOfChunks = (size + EDGES_PER_CHUNK - 1) / EDGES_PER_CHUNK;
+            T minHeight = size > 0 ? h[1] : (T) 0;
+#pragma omp parallel for schedule(static) reduction(min:minHeight)
+            for (int chunk = 0; chunk < numberOfChunks; chunk++)
+                minHeight = std::min(minHeight, updateUnknownsChunk(h, hu, size, chunk, dt, cellSize,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight));
+            return minHeight;
+        }
+
+        /** \brief Updates the cells of one chunk of updateUnknownsParallel().
+         *
+         * Chunk k holds the cells [1 + k * EDGES_PER_CHUNK, 1 + (k + 1) * EDGES_PER_CHUNK) up to size, e.g. to
+         * distribute the chunks with a TileScheduler.
+         *
+         * @see updateUnknownsParallel
+         * @param [in] chunk The chunk
+         * @return The smallest height of the chunk after the update
+         */
+        T updateUnknownsChunk(T *h, T *hu, unsigned int size, unsigned int chunk, T dt, T cellSize,
+                const T *hNetUpdatesLeft, const T *hNetUpdatesRight, const T *huNetUpdatesLeft, const T *huNetUpdatesRight) const {
+            const C dtOverCellSize = (C) dt / (C) cellSize;
+            const std::size_t chunkBegin = 1 + (std::size_t) chunk * EDGES_PER_CHUNK;
+            const std::size_t chunkEnd = std::min<std::size_t>(chunkBegin + EDGES_PER_CHUNK, (std::size_t) size + 1);
+            T minHeight = std::numeric_limits<T>::max();
+#pragma omp simd reduction(min:minHeight)
+            for (std::size_t i = chunkBegin; i < chunkEnd; i++) {
+                h[i] = (C) h[i] - dtOverCellSize * ((C) hNetUpdatesRight[i - 1] + (C) hNetUpdatesLeft[i]);
+                hu[i] = (C) hu[i] - dtOverCellSize * ((C) huNetUpdatesRight[i - 1] + (C) huNetUpdatesLeft[i]);
+                minHeight = std::min(minHeight, h[i]);
+            }
+            return minHeight;
+        }
+
+        /** The number of edges or cells per chunk of the thread-parallel sweeps, a multiple of the cache line size */
+        static const unsigned int EDGES_PER_CHUNK = 1024;
+
+        /** \brief Computes the net updates and applies them to the unknowns in a single pass.
+         *
+         * Fused alternative to computing the net updates of all edges first and updating the unknowns in a second
+         * sweep. The net updates of blocks of edges are kept in a small buffer on the stack and every cell is
+         * updated as soon as both of its edges are done, so the net update arrays never go to memory.
+         * The quantities of the cells of a block (see computeCellQuantities) are computed once per cell as well.
+         * Per cell and time step the two-phase scheme moves h, hu and four net updates twice (18 values including
+         * write-allocates), the fused sweep only reads and writes h and hu once (4 values, 5 with bathymetry).
          *
-         * Updates the values of the member variables storing the roe eigenvalues for a given set of water columns.
-         * The eigenvalues can be accessed using the corresponding getter method.
+         * The time step is an input here, the maximum edge speed of this step is only known afterwards.
+         * It is usually computed from the maximum edge speed returned by the previous step. The caller is
+         * responsible to check the returned speed against the CFL condition (maxEdgeSpeed * dt / cellSize),
+         * see PolicyWavePropagation::FUSED for a time step which is rejected and repeated.
+         *
+         * @param [in,out] h The heights of the water columns including one ghost cell on each side
+         * @param [in,out] hu The space time dependent momentums of the water columns including the ghost cells
+         * @param [in] b The bathymetry of the cells or NULL for a flat bathymetry
+         * @param [in] size The number of cells without the ghost cells
+         * @param [in] dt The time step
+         * @param [in] cellSize The size of one cell
+         * @param [out] maxEdgeSpeed The maximum edge speed of this time step
+         */
+        void computeAndApplyNetUpdates(T *h, T *hu, const T *b, unsigned int size, T dt, T cellSize, T &maxEdgeSpeed) const {
+            T hNetUpdateRight = 0, huNetUpdateRight = 0;
+            computeAndApplyNetUpdates(h, hu, b, 0, size + 1, dt, cellSize, hNetUpdateRight, huNetUpdateRight, maxEdgeSpeed);
+        }
+
+        /** \brief Computes the net updates of a range of edges and applies them to the unknowns in a single pass.
+         *
+         * Same as computeAndApplyNetUpdates(T *, T *, const T *, unsigned int, T, T, T &) for the edges [begin, end).
+         * The cells begin to end - 1 are updated, the ghost cell 0 never. The right going net updates of edge
+         * begin - 1, which the first cell needs, are passed in, the ones of edge end - 1 for cell end are passed out.
+         * So the cells of a range may be updated in parallel to the ones of another range, as long as the edges
+         * between the ranges are computed before.
+         *
+         * @param [in] begin The first edge
+         * @param [in] end One past the last edge
+         * @param [in,out] hNetUpdateRight The right going net update for the height of edge begin - 1, then end - 1
+         * @param [in,out] huNetUpdateRight The right going net update for the momentum of edge begin - 1, then end - 1
+         * @param [out] maxEdgeSpeed The maximum edge speed of the range
+         */
+        void computeAndApplyNetUpdates(T *h, T *hu, const T *b, unsigned int begin, unsigned int end, T dt, T cellSize,
+                T &hNetUpdateRight, T &huNetUpdateRight, T &maxEdgeSpeed) const {
+            const unsigned int edgesPerBlock = 256;
+            T hNetUpdatesLeft[edgesPerBlock], hNetUpdatesRight[edgesPerBlock];
+            T huNetUpdatesLeft[edgesPerBlock], huNetUpdatesRight[edgesPerBlock];
+            C sqrtH[edgesPerBlock + 1], u[edgesPerBlock + 1], flux[edgesPerBlock + 1];
+            C dtOverCellSize = (C) dt / (C) cellSize;
+            maxEdgeSpeed = 0;
+
+            for (unsigned int blockBegin = begin; blockBegin < end; blockBegin += edgesPerBlock) {
+                unsigned int blockEnd = std::min(blockBegin + edgesPerBlock, end);
+                T blockMaxEdgeSpeed;
+                // the edges of this block only read cells which have not been updated yet
+                computeCellQuantities(h + blockBegin, hu + blockBegin, 0, blockEnd - blockBegin + 1, sqrtH, u, flux);
+                computeNetUpdates(h + blockBegin, hu + blockBegin, b ? b + blockBegin : 0, sqrtH, u, flux, 0, blockEnd - blockBegin,
+                        hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, blockMaxEdgeSpeed);
+                maxEdgeSpeed = std::max(maxEdgeSpeed, blockMaxEdgeSpeed);
+
+                // cell i lies between edge i-1 and edge i, the ghost cell 0 is not updated
+                if (blockBegin > 0) {
+                    h[blockBegin] = (C) h[blockBegin] - dtOverCellSize * ((C) hNetUpdateRight + (C) hNetUpdatesLeft[0]);
+                    hu[blockBegin] = (C) hu[blockBegin] - dtOverCellSize * ((C) huNetUpdateRight + (C) huNetUpdatesLeft[0]);
+                }
+                unsigned int edgesInBlock = blockEnd - blockBegin;
+                for (unsigned int i = 1; i < edgesInBlock; i++) {
+                    h[blockBegin + i] = (C) h[blockBegin + i] - dtOverCellSize * ((C) hNetUpdatesRight[i - 1] + (C) hNetUpdatesLeft[i]);
+                    hu[blockBegin + i] = (C) hu[blockBegin + i] - dtOverCellSize * ((C) huNetUpdatesRight[i - 1] + (C) huNetUpdatesLeft[i]);
+                }
+                hNetUpdateRight = hNetUpdatesRight[edgesInBlock - 1];
+                huNetUpdateRight = huNetUpdatesRight[edgesInBlock - 1];
+            }
+        }
+
+        /** \brief Computes the roe eigenvalues.
+         *
+         * Computes the roe eigenvalues for a given set of water columns.
          *
          * @param [in] hl The height of the left water column
          * @param [in] hr The height of the right water column
          * @param [in] hul The space time dependent momentum of the left water column
          * @param [in] hur The space time dependent momentum of the right water column
+         * @param [out] roeEigenvalues The two roe eigenvalues, computed in the compute type
          */
-        void updateRoeEigenvalues(const T &hl, const T &hr, const T &hul, const T &hur) {
+        void computeRoeEigenvalues(const T &hl, const T &hr, const T &hul, const T &hur, C roeEigenvalues[2]) const {
             // The height should not be negative
             assert(hl >= 0 && hr >= 0);
-            T pVelocity = computeParticleVelocity(hl, hr, hul, hur);
-            T height = 0.5 * (hl + hr);
-            T root = sqrt(g * height);
+            const C gravity = g;
+            C pVelocity = computeParticleVelocity(hl, hr, hul, hur);
+            C height = 0.5 * ((C) hl + (C) hr);
+            C root = std::sqrt(gravity * height);
             roeEigenvalues[0] = pVelocity - root;
             roeEigenvalues[1] = pVelocity + root;
         }
@@ -119,16 +1246,17 @@ namespace solver {
          * @param [in] hr The height of the right water column
          * @param [in] hul The space time dependent momentum of the left water column
          * @param [in] hur The space time dependent momentum of the right water column
-         * @return The particle velocity for the given waves
+         * @return The particle velocity for the given waves, computed in the compute type
          */
-        T computeParticleVelocity(const T &hl, const T &hr, const T &hul, const T &hur) const {
+        C computeParticleVelocity(const T &hl, const T &hr, const T &hul, const T &hur) const {
             // we should not divide by zero
             assert(hl != (T) 0);
             assert(hr != (T) 0);
-            T ul = hul / hl;
-            T ur = hur / hr;
-            assert(sqrt(hl) + sqrt(hr) != (T) 0);
-            T particleVelocity = (ul * sqrt(hl) + ur * sqrt(hr)) / (sqrt(hl) + sqrt(hr));
+            C ul = (C) hul / (C) hl;
+            C ur = (C) hur / (C) hr;
+            C sqrtHl = std::sqrt((C) hl), sqrtHr = std::sqrt((C) hr);
+            assert(sqrtHl + sqrtHr != (C) 0);
+            C particleVelocity = (ul * sqrtHl + ur * sqrtHr) / (sqrtHl + sqrtHr);
             return particleVelocity;
         }
 
@@ -138,60 +1266,52 @@ namespace solver {
          *
          * @param [in] hl The height of the left water column
          * @param [in] hr The height of the right water column
-         * @param [in] hul The space time dependent momentum of the left water column
-         * @param [in] hur The space time dependent momentum of the right water column
+         * @param [in] roeEigenvalues The roe eigenvalues of the water columns
          * @param [in] fluxDeltaValues The jump in the fluxes
-         * @param [out] alpha The eigencofficients (alpha values) for the given input
+         * @param [out] alpha The eigencofficients (alpha values) for the given input, computed in the compute type
          */
-        void computeEigencoefficients(const T &hl, const T &hr, const T fluxDeltaValues[2], T alpha[2]) const {
+        void computeEigencoefficients(const T &hl, const T &hr, const C roeEigenvalues[2], const C fluxDeltaValues[2], C alpha[2]) const {
             // The height should not be negative
             assert(hl >= 0 && hr >= 0);
             // We should not divide by zero
-            assert(roeEigenvalues[1] - roeEigenvalues[0] != (T) 0);
-            T coefficient = 1.0 / (roeEigenvalues[1] - roeEigenvalues[0]);
+            assert(roeEigenvalues[1] - roeEigenvalues[0] != (C) 0);
+            C coefficient = (C) 1 / (roeEigenvalues[1] - roeEigenvalues[0]);
             // computing the alpha values by multiplying the inverse of
             // the matrix of right eigenvectors to the jump in the fluxes
             alpha[0] = coefficient * (roeEigenvalues[1] * fluxDeltaValues[0] - fluxDeltaValues[1]);
             alpha[1] = coefficient * (-roeEigenvalues[0] * fluxDeltaValues[0] + fluxDeltaValues[1]);
         }
 
-        /**
-         * Returns the values of the member variables storing the eigenvalues
-         * of a given set of water columns.
-         *
-         * @param [in] eigenvalues The values of the member variables
-         */
-        void getRoeEigenvalues(T eigenvalues[2]) {
-            eigenvalues[0] = roeEigenvalues[0];
-            eigenvalues[1] = roeEigenvalues[1];
-        }
-
         /** Calculates the delta values of the flux function and takes care of the bathymetry effects.
-         * 
+         *
          * @param [in] hl The height of the left water column
          * @param [in] hr The height of the right water column
          * @param [in] hul The space time dependent momentum of the left water column
          * @param [in] hur The space time dependent momentum of the right water column
          * @param [in] bl The first bathymetry component
          * @param [in] br The second bathymetry component
-         * @param [out] fluxDeltaValues return array with the calculated delta values of the flux funtion
+         * @param [out] fluxDeltaValues return array with the calculated delta values of the flux funtion, computed in the
+         * compute type to avoid the cancellation of the two nearly equal fluxes
          */
-        void computeFluxDeltaValues(const T &hl, const T &hr, const T &hul, const T &hur, const T bl, const T br, T fluxDeltaValues[2]) const {
-            T bathymetryeffect = -g * (br - bl) * ((hl + hr) / 2);
-            fluxDeltaValues[0] = hur - hul;
-            fluxDeltaValues[1] = (hur * (hur / hr) + 0.5 * g * hr * hr - (hul * (hul / hl) + 0.5 * g * hl * hl)) - bathymetryeffect;
+        void computeFluxDeltaValues(const T &hl, const T &hr, const T &hul, const T &hur, const T bl, const T br, C fluxDeltaValues[2]) const {
+            const C gravity = g, half = 0.5;
+            C bathymetryeffect = -gravity * ((C) br - (C) bl) * (((C) hl + (C) hr) / 2);
+            fluxDeltaValues[0] = (C) hur - (C) hul;
+            fluxDeltaValues[1] = ((C) hur * ((C) hur / (C) hr) + half * gravity * (C) hr * (C) hr - ((C) hul * ((C) hul / (C) hl) + half * gravity * (C) hl * (C) hl)) - bathymetryeffect;
         }
-        
+
         /** Carries the reflecting (wet-dry) boundary condition to effect.
-         * 
-         * @param [in] hl The height of the left water column
-         * @param [in] hr The height of the right water column
-         * @param [in] hul The space time dependent momentum of the left water column
-         * @param [in] hur The space time dependent momentum of the right water column
-         * @param [in] bl The first bathymetry component
-         * @param [in] br The second bathymetry component
+         *
+         * If one of the water columns is dry, it is replaced by the mirrored state of the wet one.
+         *
+         * @param [in,out] hl The height of the left water column
+         * @param [in,out] hr The height of the right water column
+         * @param [in,out] hul The space time dependent momentum of the left water column
+         * @param [in,out] hur The space time dependent momentum of the right water column
+         * @param [in,out] bl The first bathymetry component
+         * @param [in,out] br The second bathymetry component
          */
-        void computeBoundaryConditions(const T &hl, const T &hr, const T &hul, const T &hur, const T bl, const T br) {
+        void computeBoundaryConditions(T &hl, T &hr, T &hul, T &hur, T &bl, T &br) const {
             if (hr == 0 && hl > 0) {
                 hr = hl;
                 br = bl;
@@ -205,11 +1325,14 @@ namespace solver {
 
     private:
 
-        T *roeEigenvalues;
+        /** @return The kernels for the instruction set of this cpu, selected on the first call */
+        static const kernel::Kernels<T, C> &kernels() {
+            static const kernel::Kernels<T, C> selected = kernel::selectKernels<T, C>();
+            return selected;
+        }
 
     };
 
 }
 
 #endif	/* _FWAVE_H */
-
@@ -10,9 +10,12 @@
 
 #include "../types.h"
 #include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <vector>
 #include "../scenarios/scenario.h"
 #include "../scenarios/rarerare.h"
 #include "../scenarios/shockshock.h"
+#include "../scenarios/extendeddambreak.h"
 #include "../WavePropagation.h"
 #include "../solvers/FWave.hpp"
 
@@ -56,6 +59,320 @@ public:
         testSingleSupersonicProblem(1.0, 1.0, 10.0, 20.0, 0.0, 0.0);
     }
 
+    /** \brief calls the testSingleWetDryProblem method with dry cells on both sides
+     *
+     */
+    void testWetDryProblems()
+    {
+        testSingleWetDryProblem(10.0, 5.0, true);
+        testSingleWetDryProblem(10.0, -5.0, false);
+        testSingleWetDryProblem(230.0, 80.0, true);
+    }
+
+    /** \brief tests that an edge between two dry cells produces no updates
+     *
+     */
+    void testDryDryProblems()
+    {
+        solver::NetUpdates<T> updates = m_solver.computeNetUpdates(0, 0, 0, 0, 0, 0);
+        TS_ASSERT_EQUALS(updates.hNetUpdatesLeft, 0);
+        TS_ASSERT_EQUALS(updates.hNetUpdatesRight, 0);
+        TS_ASSERT_EQUALS(updates.huNetUpdatesLeft, 0);
+        TS_ASSERT_EQUALS(updates.huNetUpdatesRight, 0);
+        TS_ASSERT_EQUALS(updates.maxEdgeSpeed, 0);
+    }
+
+    /** \brief compares the batched net updates to the ones of the single edge solver
+     *
+     *  Uses wet, dry and supersonic cells as well as a varying bathymetry.
+     *
+     */
+    void testBatchNetUpdates()
+    {
+        const unsigned int size = 64;
+        T h[size], hu[size], b[size];
+        for (unsigned int i = 0; i < size; i++)
+        {
+            h[i] = (i % 11 == 3 || i % 11 == 4) ? 0 : 5 + (i * 37) % 23;
+            hu[i] = h[i] == 0 ? 0 : (T) ((int) ((i * 53) % 41) - 20) * (i % 7 == 0 ? 10 : 1);
+            b[i] = -(T) ((i * 13) % 5);
+        }
+        T hNetUpdatesLeft[size], hNetUpdatesRight[size], huNetUpdatesLeft[size], huNetUpdatesRight[size];
+        for (int withBathymetry = 0; withBathymetry < 2; withBathymetry++)
+        {
+            const T *bathymetry = withBathymetry ? b : 0;
+            T maxEdgeSpeed;
+            m_solver.computeNetUpdates(h, hu, bathymetry, 0, size - 1, hNetUpdatesLeft, hNetUpdatesRight, huNetUpdatesLeft, huNetUpdatesRight, maxEdgeSpeed);
+            T expectedMaxEdgeSpeed = 0;
+            for (unsigned int i = 0; i < size - 1; i++)
+            {
+                solver::NetUpdates<T> expected = m_solver.computeNetUpdates(h[i], h[i + 1], hu[i], hu[i + 1],
+                        withBathymetry ? b[i] : 0, withBathymetry ? b[i + 1] : 0);
+                TS_ASSERT_DELTA(hNetUpdatesLeft[i], expected.hNetUpdatesLeft, 0.001);
+                TS_ASSERT_DELTA(hNetUpdatesRight[i], expected.hNetUpdatesRight, 0.001);
+                TS_ASSERT_DELTA(huNetUpdatesLeft[i], expected.huNetUpdatesLeft, 0.01);
+                TS_ASSERT_DELTA(huNetUpdatesRight[i], expected.huNetUpdatesRight, 0.01);
+                expectedMaxEdgeSpeed = std::max(expectedMaxEdgeSpeed, expected.maxEdgeSpeed);
+            }
+            TS_ASSERT_DELTA(maxEdgeSpeed, expectedMaxEdgeSpeed, 0.0001);
+        }
+    }
+
+    /** \brief tests that the net updates from precomputed cell quantities equal the ones of the batched kernel
+     *
+     *  Covers wet-wet, wet-dry and dry-dry edges with and without bathymetry.
+     */
+    void testCachedNetUpdates()
+    {
+        const unsigned int size = 300;
+        T h[size], hu[size], b[size], sqrtH[size], u[size], flux[size];
+        for (unsigned int i = 0; i < size; i++)
+        {
+            h[i] = i % 7 < 2 ? 0 : 10 + (i * 37) % 23;
+            hu[i] = h[i] == 0 ? 0 : (T) ((int) ((i * 53) % 41) - 20);
+            b[i] = -20 + (T) (i % 5);
+        }
+        T updates[4][size], cachedUpdates[4][size];
+        for (int withBathymetry = 0; withBathymetry < 2; withBathymetry++)
+        {
+            const T *bathymetry = withBathymetry ? b : 0;
+            T maxEdgeSpeed, cachedMaxEdgeSpeed;
+            m_solver.computeNetUpdates(h, hu, bathymetry, 0, size - 1, updates[0], updates[1], updates[2], updates[3], maxEdgeSpeed);
+            m_solver.computeCellQuantities(h, hu, 0, size, sqrtH, u, flux);
+            m_solver.computeNetUpdates(h, hu, bathymetry, sqrtH, u, flux, 0, size - 1,
+                    cachedUpdates[0], cachedUpdates[1], cachedUpdates[2], cachedUpdates[3], cachedMaxEdgeSpeed);
+            TS_ASSERT_EQUALS(maxEdgeSpeed, cachedMaxEdgeSpeed);
+            for (int j = 0; j < 4; j++)
+            {
+                for (unsigned int i = 0; i < size - 1; i++)
+                    TS_ASSERT_EQUALS(updates[j][i], cachedUpdates[j][i]);
+            }
+        }
+    }
+
+    /** \brief tests that the threaded sweep gives bit-for-bit the same results as the serial one
+     *
+     */
+    void testParallelNetUpdates()
+    {
+        const unsigned int size = 5000;
+        T *h = new T[size];
+        T *hu = new T[size];
+        for (unsigned int i = 0; i < size; i++)
+        {
+            h[i] = 10 + (i * 37) % 23;
+            hu[i] = (T) ((int) ((i * 53) % 41) - 20);
+        }
+        T **serial = new T*[4];
+        T **parallel = new T*[4];
+        for (int i = 0; i < 4; i++)
+        {
+            serial[i] = new T[size];
+            parallel[i] = new T[size];
+        }
+        T serialMaxEdgeSpeed, parallelMaxEdgeSpeed;
+        m_solver.computeNetUpdates(h, hu, 0, 0, size - 1, serial[0], serial[1], serial[2], serial[3], serialMaxEdgeSpeed);
+        m_solver.computeNetUpdatesParallel(h, hu, 0, 0, size - 1, parallel[0], parallel[1], parallel[2], parallel[3], parallelMaxEdgeSpeed);
+        TS_ASSERT_EQUALS(serialMaxEdgeSpeed, parallelMaxEdgeSpeed);
+        for (int i = 0; i < 4; i++)
+        {
+            for (unsigned int j = 0; j < size - 1; j++)
+                TS_ASSERT_EQUALS(serial[i][j], parallel[i][j]);
+            delete [] serial[i];
+            delete [] parallel[i];
+        }
+        delete [] serial;
+        delete [] parallel;
+        delete [] h;
+        delete [] hu;
+    }
+
+    /** \brief tests that skipping the dry chunks gives the same net updates as solving every edge
+     *
+     *  Only the middle chunk is dry. The net updates start with garbage, which the dry chunk has to clear once.
+     */
+    void testDryChunks()
+    {
+        const unsigned int chunkSize = solver::FWave<T>::EDGES_PER_CHUNK, size = 3 * chunkSize;
+        std::vector<T> h(size + 1, 0), hu(size + 1, 0);
+        for (unsigned int i = 0; i < chunkSize / 2; i++)
+        {
+            h[i] = 2;
+            hu[i] = 1;
+        }
+        for (unsigned int i = 2 * chunkSize + 10; i <= size; i++)
+            h[i] = 3;
+        std::vector<T> reference[4], skipped[4];
+        for (int i = 0; i < 4; i++)
+        {
+            reference[i].assign(size, 0);
+            skipped[i].assign(size, 1);
+        }
+        unsigned char dryChunks[3] = {0, 0, 0};
+
+        for (int pass = 0; pass < 3; pass++)
+        {
+            // in the last pass, a wave has reached the dry chunk
+            if (pass == 2)
+                h[chunkSize + 5] = 1;
+            T referenceMaxEdgeSpeed, skippedMaxEdgeSpeed;
+            m_solver.computeNetUpdatesParallel(&h[0], &hu[0], 0, 0, size, &reference[0][0], &reference[1][0],
+                    &reference[2][0], &reference[3][0], referenceMaxEdgeSpeed);
+            m_solver.computeNetUpdatesParallel(&h[0], &hu[0], 0, 0, size, &skipped[0][0], &skipped[1][0],
+                    &skipped[2][0], &skipped[3][0], skippedMaxEdgeSpeed, dryChunks);
+            TS_ASSERT_EQUALS(referenceMaxEdgeSpeed, skippedMaxEdgeSpeed);
+            TS_ASSERT_EQUALS(dryChunks[0], 0);
+            TS_ASSERT_EQUALS(dryChunks[1], pass < 2 ? 1 : 0);
+            TS_ASSERT_EQUALS(dryChunks[2], 0);
+            for (int i = 0; i < 4; i++)
+            {
+                for (unsigned int j = 0; j < size; j++)
+                    TS_ASSERT_EQUALS(reference[i][j], skipped[i][j]);
+            }
+        }
+    }
+
+    /** \brief tests that float storage with double arithmetic matches the double solver on float inputs
+     *
+     *  A small jump in deep water, where the flux jump of a pure float solver suffers from cancellation.
+     */
+    void testMixedPrecision()
+    {
+        const unsigned int size = 64;
+        float h[size], hu[size];
+        double hReference[size], huReference[size];
+        for (unsigned int i = 0; i < size; i++)
+        {
+            h[i] = 4000 + 0.25f * (i % 3);
+            hu[i] = 0.5f * (i % 5);
+            hReference[i] = h[i];
+            huReference[i] = hu[i];
+        }
+        float updates[4][size];
+        double referenceUpdates[4][size];
+        float maxEdgeSpeed;
+        double referenceMaxEdgeSpeed;
+        solver::Precision<float, double>::Solver mixed;
+        solver::FWave<double> reference;
+        mixed.computeNetUpdates(h, hu, 0, 0, size - 1, updates[0], updates[1], updates[2], updates[3], maxEdgeSpeed);
+        reference.computeNetUpdates(hReference, huReference, 0, 0, size - 1,
+                referenceUpdates[0], referenceUpdates[1], referenceUpdates[2], referenceUpdates[3], referenceMaxEdgeSpeed);
+        TS_ASSERT_DELTA(maxEdgeSpeed, referenceMaxEdgeSpeed, 1e-6 * referenceMaxEdgeSpeed);
+        for (unsigned int i = 0; i < size - 1; i++)
+        {
+            for (int j = 0; j < 4; j++)
+                TS_ASSERT_DELTA(updates[j][i], referenceUpdates[j][i], 1e-6 * std::fabs(referenceUpdates[j][i]) + 1e-6);
+
+            // the single edge solver computes the roe eigenvalues in double as well
+            solver::NetUpdates<float> single = mixed.computeNetUpdates(h[i], h[i + 1], hu[i], hu[i + 1], 0, 0);
+            solver::NetUpdates<double> singleReference = reference.computeNetUpdates(hReference[i], hReference[i + 1],
+                    huReference[i], huReference[i + 1], 0, 0);
+            TS_ASSERT_EQUALS(single.roeEigenvalues[0], (float) singleReference.roeEigenvalues[0]);
+            TS_ASSERT_EQUALS(single.roeEigenvalues[1], (float) singleReference.roeEigenvalues[1]);
+            TS_ASSERT_DELTA(single.hNetUpdatesLeft, referenceUpdates[0][i], 1e-6 * std::fabs(referenceUpdates[0][i]) + 1e-6);
+            TS_ASSERT_DELTA(single.hNetUpdatesRight, referenceUpdates[1][i], 1e-6 * std::fabs(referenceUpdates[1][i]) + 1e-6);
+        }
+    }
+
+    /** \brief tests that the fused sweep gives the same unknowns as computing and applying the net updates separately
+     *
+     */
+    void testFusedNetUpdates()
+    {
+        const unsigned int size = 1000;
+        scenarios::ShockShock scenario(size, 300, 50);
+        T *h = new T[size + 2];
+        T *hu = new T[size + 2];
+        T *hFused = new T[size + 2];
+        T *huFused = new T[size + 2];
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            h[i] = hFused[i] = scenario.getHeight(i);
+            hu[i] = huFused[i] = scenario.getMomentum(i);
+        }
+        T **updates = new T*[4];
+        for (int i = 0; i < 4; i++)
+            updates[i] = new T[size + 1];
+
+        T cellSize = scenario.getCellSize();
+        T maxEdgeSpeed, fusedMaxEdgeSpeed;
+        for (int step = 0; step < 20; step++)
+        {
+            m_solver.computeNetUpdates(h, hu, 0, 0, size + 1, updates[0], updates[1], updates[2], updates[3], maxEdgeSpeed);
+            T dt = 0.4 * cellSize / maxEdgeSpeed;
+            T dtOverCellSize = dt / cellSize;
+            for (unsigned int i = 1; i < size + 1; i++)
+            {
+                h[i] -= dtOverCellSize * (updates[1][i - 1] + updates[0][i]);
+                hu[i] -= dtOverCellSize * (updates[3][i - 1] + updates[2][i]);
+            }
+            m_solver.computeAndApplyNetUpdates(hFused, huFused, 0, size, dt, cellSize, fusedMaxEdgeSpeed);
+            TS_ASSERT_EQUALS(maxEdgeSpeed, fusedMaxEdgeSpeed);
+        }
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            TS_ASSERT_EQUALS(h[i], hFused[i]);
+            TS_ASSERT_EQUALS(hu[i], huFused[i]);
+        }
+
+        for (int i = 0; i < 4; i++)
+            delete [] updates[i];
+        delete [] updates;
+        delete [] h;
+        delete [] hu;
+        delete [] hFused;
+        delete [] huFused;
+    }
+
+    /** \brief tests that the hybrid solver picks the solver per chunk of 64 edges and stays close to the f-wave solver
+     *
+     *  A deep ocean at rest over a slope with a small bump, interrupted by a region with fast flows and a dry region.
+     */
+    void testHybridNetUpdates()
+    {
+        const unsigned int size = 640;
+        std::vector<T> h(size), hu(size), b(size);
+        for (unsigned int i = 0; i < size; i++)
+        {
+            b[i] = -4000 + (T) i;
+            h[i] = -b[i] + 0.5 * std::sin(0.1 * i);
+            hu[i] = (T) (i % 3);
+            // wet edges in the chunks [256, 384), wet-dry edges in the chunk [384, 448)
+            if (i >= 260 && i <= 370)
+                hu[i] = 20000. * ((int) (i % 3) - 1);
+            if (i >= 400 && i <= 420)
+                h[i] = hu[i] = 0;
+        }
+        std::vector<T> updates[4], hybridUpdates[4];
+        for (int j = 0; j < 4; j++)
+        {
+            updates[j].resize(size - 1);
+            hybridUpdates[j].resize(size - 1);
+        }
+        T maxEdgeSpeed, hybridMaxEdgeSpeed;
+        m_solver.computeNetUpdates(&h[0], &hu[0], &b[0], 0, size - 1, &updates[0][0], &updates[1][0], &updates[2][0], &updates[3][0],
+                maxEdgeSpeed);
+        solver::HybridStatistics statistics;
+        m_solver.computeNetUpdatesHybrid(&h[0], &hu[0], &b[0], 0, size - 1, &hybridUpdates[0][0], &hybridUpdates[1][0],
+                &hybridUpdates[2][0], &hybridUpdates[3][0], hybridMaxEdgeSpeed, statistics);
+
+        TS_ASSERT_EQUALS(statistics.linearizedEdges, 256 + 191);
+        TS_ASSERT_EQUALS(statistics.wetEdges, 128);
+        TS_ASSERT_EQUALS(statistics.wetDryEdges, 64);
+        // the linearized solver over-estimates the wave speed by at most the particle velocity
+        TS_ASSERT(hybridMaxEdgeSpeed >= maxEdgeSpeed * (1 - 1e-6));
+        TS_ASSERT_DELTA(hybridMaxEdgeSpeed, maxEdgeSpeed, 1e-3 * maxEdgeSpeed);
+        for (int j = 0; j < 4; j++)
+        {
+            for (unsigned int i = 0; i < size - 1; i++)
+            {
+                // the linearized updates differ by about the froude number, the others only by rounding
+                T tolerance = (i < 256 || i >= 448 ? 1e-2 : 1e-4) * std::abs(updates[j][i]) + 1e-2;
+                TS_ASSERT_DELTA(hybridUpdates[j][i], updates[j][i], tolerance);
+            }
+        }
+    }
+
     void testShockShockProblems()
     {
         int size = 10;
@@ -118,6 +435,19 @@ public:
         delete [] testValues;
     }
 
+    void testScenarioFill()
+    {
+        // the range starts in the middle of the first chunk and the split lies inside a chunk
+        const unsigned int size = 5000;
+        scenarios::ShockShock shockShock(size, 10, 3);
+        testSingleScenarioFill(shockShock, 17, size + 2);
+        scenarios::RareRare rareRare(size, 10, 3);
+        testSingleScenarioFill(rareRare, 0, size + 2);
+        scenarios::ExtendedDamBreak extendedDamBreak(size, 14, 3.5, 0.7);
+        testSingleScenarioFill(extendedDamBreak, 2499, 2503);
+        testSingleScenarioFill(extendedDamBreak, 2600, 2600);
+    }
+
     void testComputeParticleVelocity()
     {
         testSingleComputeParticleVelocity(200, 150, -40, -1, -0.11027);
@@ -146,7 +476,7 @@ private:
 
     void testSingleComputeFluxDeltaValues(const T &hl, const T &hr, const T &hul, const T &hur, const T expected[2], T *flux)
     {
-        m_solver.computeFluxDeltaValues(hl, hr, hul, hur, flux);
+        m_solver.computeFluxDeltaValues(hl, hr, hul, hur, 0, 0, flux);
         for (int i = 0; i < 2; i++)
             TS_ASSERT_DELTA(flux[i], expected[i], 0.1);
     }
@@ -158,15 +488,27 @@ private:
         TS_ASSERT_DELTA(result, expected, 0.0001);
     }
 
+    void testSingleScenarioFill(scenarios::Scenario<T> &scenario, unsigned int begin, unsigned int end)
+    {
+        std::vector<T> h(end - begin + 1, -1), hu(end - begin + 1, -1), b(end - begin + 1, -1);
+        scenario.fill(&h[0], &hu[0], &b[0], begin, end);
+        for (unsigned int i = begin; i < end; i++)
+        {
+            TS_ASSERT_EQUALS(h[i - begin], scenario.getHeight(i));
+            TS_ASSERT_EQUALS(hu[i - begin], scenario.getMomentum(i));
+            TS_ASSERT_EQUALS(b[i - begin], scenario.getBathymetry(i));
+        }
+        // nothing is written behind the range
+        TS_ASSERT_EQUALS(h[end - begin], -1);
+        TS_ASSERT_EQUALS(hu[end - begin], -1);
+        TS_ASSERT_EQUALS(b[end - begin], -1);
+    }
+
     void testSingleScenario(scenarios::Scenario<T> *scenario, const int size, const int timeSteps, const T expectedValue)
     {
         T *h = new T[size+2];
         T *hu = new T[size+2];
-        for (unsigned int j = 0; j < size+2; j++)
-        {
-            hu[j] = scenario->getMomentum(j);
-            h[j] = scenario->getHeight(j);
-        }
+        scenario->fill(h, hu, 0, 0, size+2);
         WavePropagation wavePropagation(h, hu, size, scenario->getCellSize());
         for (unsigned int j = 0; j < timeSteps; j++)
         {
@@ -214,27 +556,49 @@ private:
      */
     void testSingleSupersonicProblem(T hl, T hr, T hul, T hur, T b1, T b2)
     {
-        T *updates = new T[4]();
-        T maxEdgeSpeed;
-        m_solver.updateRoeEigenvalues(hl, hr, hul, hur);
-        T *roe = new T[2]();
-        m_solver.getRoeEigenvalues(roe);
-        m_solver.computeNetUpdates(hl, hr, hul, hur, b1, b2, updates[0], updates[1], updates[2], updates[3], maxEdgeSpeed);
-        bool leftUpdateIsZero = updates[0] == 0 && updates[2] == 0;
-        bool rightUpdateIsZero = updates[1] == 0 && updates[3] == 0;
+        solver::NetUpdates<T> updates = m_solver.computeNetUpdates(hl, hr, hul, hur, b1, b2);
+        bool leftUpdateIsZero = updates.hNetUpdatesLeft == 0 && updates.huNetUpdatesLeft == 0;
+        bool rightUpdateIsZero = updates.hNetUpdatesRight == 0 && updates.huNetUpdatesRight == 0;
         TS_ASSERT(leftUpdateIsZero || rightUpdateIsZero);
+        TS_ASSERT(updates.roeEigenvalues[0] * updates.roeEigenvalues[1] > 0);
         T particleVelocity = m_solver.computeParticleVelocity(hl, hr, hul, hur);
         if (particleVelocity > 0)
         {
-            TS_ASSERT(maxEdgeSpeed >= 0);
+            TS_ASSERT(updates.maxEdgeSpeed >= 0);
 
         }
         else if (particleVelocity < 0)
         {
-            TS_ASSERT(maxEdgeSpeed == 0);
+            TS_ASSERT(updates.maxEdgeSpeed == 0);
         }
-        delete [] updates;
-        delete [] roe;
+    }
+
+    /** \brief tests the reflecting boundary condition at a wet-dry edge
+     *
+     *  Computes the net updates for an edge with one dry water column and tests if the dry cell stays untouched
+     *  while the wet cell receives the reflected wave.
+     *
+     * @param [in] h The height of the wet water column
+     * @param [in] hu The momentum of the wet water column
+     * @param [in] dryOnTheRight true if the right water column is dry, false if the left one is dry
+     */
+    void testSingleWetDryProblem(T h, T hu, bool dryOnTheRight)
+    {
+        solver::NetUpdates<T> updates = dryOnTheRight ? m_solver.computeNetUpdates(h, 0, hu, 0, 0, 0)
+                : m_solver.computeNetUpdates(0, h, 0, hu, 0, 0);
+        if (dryOnTheRight)
+        {
+            TS_ASSERT_EQUALS(updates.hNetUpdatesRight, 0);
+            TS_ASSERT_EQUALS(updates.huNetUpdatesRight, 0);
+            TS_ASSERT(updates.hNetUpdatesLeft != 0);
+        }
+        else
+        {
+            TS_ASSERT_EQUALS(updates.hNetUpdatesLeft, 0);
+            TS_ASSERT_EQUALS(updates.huNetUpdatesLeft, 0);
+            TS_ASSERT(updates.hNetUpdatesRight != 0);
+        }
+        TS_ASSERT(updates.maxEdgeSpeed > 0);
     }
 
     /** \brief tests the Eigenvalue Computation
@@ -252,8 +616,7 @@ private:
     void testSingleEigenvalueComputation(const T hl, const T hr, const T hul, const T hur, const T expected1, const T expected2)
     {
         T *actualEigenvalues = new T[2]();
-        m_solver.updateRoeEigenvalues(hl, hr, hul, hur);
-        m_solver.getRoeEigenvalues(actualEigenvalues);
+        m_solver.computeRoeEigenvalues(hl, hr, hul, hur, actualEigenvalues);
         TS_ASSERT_DELTA(expected1, actualEigenvalues[0], 0.0001);
         TS_ASSERT_DELTA(expected2, actualEigenvalues[1], 0.0001);
         delete [] actualEigenvalues;
@@ -263,8 +626,7 @@ private:
 
     void singleEigenvalueComputationTest(const T &hl, const T &hr, const T &hul, const T &hur, const T expectedEigenvalues[2], T actualEigenvalues[2])
     {
-        m_solver.updateRoeEigenvalues(hl, hr, hul, hur);
-        m_solver.getRoeEigenvalues(actualEigenvalues);
+        m_solver.computeRoeEigenvalues(hl, hr, hul, hur, actualEigenvalues);
         TS_ASSERT_DELTA(expectedEigenvalues[0], actualEigenvalues[0], 0.00001);
         TS_ASSERT_DELTA(expectedEigenvalues[1], actualEigenvalues[1], 0.00001);
     }
@@ -0,0 +1,157 @@
+/*
+ * File:   GaugeTest.h
+ *
+ * Tests of the tide gauges.
+ */
+
+#ifndef _GAUGETEST_H
+#define	_GAUGETEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <vector>
+#include "../scenarios/shelfdambreak.h"
+#include "../io/GaugeWriter.h"
+#include "../io/GaugeReader.h"
+#include "../PolicyWavePropagation.h"
+
+class GaugeTest : public CxxTest::TestSuite
+{
+private:
+
+    /** \brief linear fields including the ghost cells, which change with the step */
+    void fill(T *h, T *hu, T *b, unsigned int size, unsigned long step)
+    {
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            h[i] = 10 + i + step;
+            hu[i] = 2. * i - step;
+            b[i] = -0.5 * i;
+        }
+    }
+
+public:
+
+    /** \brief interpolates between the cell centers and reads the series back
+     *
+     *  Only two blocks of 16 samples are used, so the writer has to wait for the I/O thread, and the
+     *  last block is incomplete.
+     */
+    void testInterpolation()
+    {
+        const unsigned int size = 10;
+        const unsigned long samples = 100;
+        const T cellSize = 2;
+        const char *fileName = "gauge_test.swe";
+        // a cell center, the edge between cells 3 and 4, a quarter between two centers and both ends of the domain
+        std::vector<double> positions;
+        positions.push_back(5);
+        positions.push_back(6);
+        positions.push_back(8.5);
+        positions.push_back(0);
+        positions.push_back(20);
+        T h[size + 2], hu[size + 2], b[size + 2];
+        {
+            io::GaugeWriter writer(fileName, positions, size, cellSize, 16, 2);
+            TS_ASSERT(writer.isOpen());
+            for (unsigned long step = 0; step < samples; step++)
+            {
+                fill(h, hu, b, size, step);
+                TS_ASSERT(writer.write(h, hu, b, 0.25 * step));
+            }
+            TS_ASSERT_EQUALS(writer.getNumberOfSamples(), samples);
+        }
+
+        io::GaugeReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT_EQUALS(reader.getNumberOfGauges(), positions.size());
+        TS_ASSERT_EQUALS(reader.getNumberOfSamples(), samples);
+        TS_ASSERT_EQUALS(reader.getNumberOfCells(), size);
+        TS_ASSERT_EQUALS(reader.getCellSize(), cellSize);
+        // the cell (including the ghost cell) at each position, the fields are linear in the cell
+        const T cells[] = {3, 3.5, 4.75, 1, 10};
+        for (unsigned int gauge = 0; gauge < positions.size(); gauge++)
+        {
+            TS_ASSERT_EQUALS(reader.getPosition(gauge), positions[gauge]);
+            for (unsigned long step = 0; step < samples; step++)
+            {
+                TS_ASSERT_EQUALS(reader.getTime(step), 0.25 * step);
+                TS_ASSERT_DELTA(reader.getHeight(gauge, step), 10 + cells[gauge] + step, 1e-5);
+                TS_ASSERT_DELTA(reader.getMomentum(gauge, step), 2 * cells[gauge] - step, 1e-5);
+                TS_ASSERT_DELTA(reader.getSurface(gauge, step), 10 + 0.5 * cells[gauge] + step, 1e-5);
+            }
+        }
+        std::remove(fileName);
+    }
+
+    /** \brief the wave propagation samples its gauges after every time step */
+    void testWavePropagation()
+    {
+        const unsigned int size = 200;
+        const int steps = 30;
+        const char *fileName = "gauge_test_propagation.swe";
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+        scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+        T cellSize = scenario.getCellSize();
+        // the centers of a cell on the shelf and in the deep water
+        std::vector<double> positions;
+        positions.push_back(19.5 * cellSize);
+        positions.push_back(179.5 * cellSize);
+
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize,
+                PolicyWavePropagation::REFLECTING);
+        std::vector<double> times;
+        std::vector<T> heights;
+        {
+            io::GaugeWriter writer(fileName, positions, size, cellSize, 8);
+            wavePropagation->setGauges(&writer);
+            for (int step = 0; step < steps; step++)
+            {
+                wavePropagation->simulateTimeStep();
+                times.push_back(wavePropagation->getTime());
+                heights.push_back(h[20]);
+            }
+            wavePropagation->setGauges(0);
+            wavePropagation->simulateTimeStep();
+        }
+        delete wavePropagation;
+
+        io::GaugeReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT_EQUALS(reader.getNumberOfSamples(), steps);
+        for (int step = 0; step < steps; step++)
+        {
+            TS_ASSERT_EQUALS(reader.getTime(step), times[step]);
+            TS_ASSERT_EQUALS(reader.getHeight(0, step), heights[step]);
+            TS_ASSERT_EQUALS(reader.getSurface(0, step), heights[step] + b[20]);
+        }
+        std::remove(fileName);
+    }
+
+    /** \brief a failed write closes the writer without blocking write() and is reported by close() */
+    void testWriteFailure()
+    {
+        const unsigned int size = 10;
+        // more samples than fit into the ring, each block is larger than the buffer of the stream
+        const unsigned long samples = 100;
+        std::vector<double> positions(100, 5);
+        T h[size + 2], hu[size + 2], b[size + 2];
+        fill(h, hu, b, size, 0);
+        io::GaugeWriter writer("/dev/full", positions, size, 2, 16, 2);
+        TS_ASSERT(writer.isOpen());
+        for (unsigned long step = 0; step < samples; step++)
+            writer.write(h, hu, b, step);
+        TS_ASSERT(!writer.close());
+        TS_ASSERT(writer.hasFailed());
+        TS_ASSERT(!writer.isOpen());
+        TS_ASSERT(!writer.write(h, hu, b, samples));
+
+        io::GaugeWriter missing("no_such_directory/gauge_test.swe", positions, size, 2);
+        TS_ASSERT(!missing.isOpen());
+        TS_ASSERT(!missing.close());
+    }
+};
+
+#endif	/* _GAUGETEST_H */
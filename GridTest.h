@@ -0,0 +1,131 @@
+/*
+ * File:   GridTest.h
+ *
+ * Tests of the grid files and the grid scenario.
+ */
+
+#ifndef _GRIDTEST_H
+#define	_GRIDTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <vector>
+#include "../io/Grid.h"
+#include "../scenarios/gridscenario.h"
+
+class GridTest : public CxxTest::TestSuite
+{
+private:
+
+    /** \brief a bilinear function, which the bilinear interpolation reproduces exactly */
+    static T bathymetry(double x, double y)
+    {
+        return -100 + 2 * x + 3 * y + 0.01 * x * y;
+    }
+
+    /** \brief writes a grid of 7 x 4 nodes with the origin (10, 20) and a spacing of (5, 2) */
+    void writeTestGrid(const char *fileName, bool withDisplacement)
+    {
+        std::vector<T> b(7 * 4), d(7 * 4);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            for (unsigned int i = 0; i < 7; i++)
+            {
+                b[j * 7 + i] = bathymetry(10 + 5 * i, 20 + 2 * j);
+                d[j * 7 + i] = i < 3 ? 1 : 0;
+            }
+        }
+        TS_ASSERT(io::writeGrid(fileName, 7, 4, 10, 20, 5, 2, &b[0], withDisplacement ? &d[0] : 0));
+    }
+
+public:
+
+    /** \brief writes a grid and samples it between and outside of the nodes */
+    void testSample()
+    {
+        const char *fileName = "grid_test.swegrid";
+        writeTestGrid(fileName, false);
+
+        io::GridReader grid(fileName);
+        TS_ASSERT(grid.isValid());
+        TS_ASSERT_EQUALS(grid.getNx(), 7);
+        TS_ASSERT_EQUALS(grid.getNy(), 4);
+        TS_ASSERT(!grid.hasDisplacement());
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::BATHYMETRY, 3, 2), bathymetry(25, 24));
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::DISPLACEMENT, 3, 2), 0);
+
+        TS_ASSERT_DELTA(grid.sample(io::GridReader::BATHYMETRY, 10, 20), bathymetry(10, 20), 1e-3);
+        TS_ASSERT_DELTA(grid.sample(io::GridReader::BATHYMETRY, 17.5, 21.3), bathymetry(17.5, 21.3), 1e-3);
+        TS_ASSERT_DELTA(grid.sample(io::GridReader::BATHYMETRY, 40, 26), bathymetry(40, 26), 1e-3);
+        // positions outside of the grid are clamped to the boundary
+        TS_ASSERT_DELTA(grid.sample(io::GridReader::BATHYMETRY, 0, 100), bathymetry(10, 26), 1e-3);
+        std::remove(fileName);
+    }
+
+    /** \brief imports an ASCII grid with NODATA values and cell corner coordinates */
+    void testAsciiImport()
+    {
+        const char *asciiFile = "grid_test.asc";
+        const char *fileName = "grid_test.swegrid";
+        std::FILE *file = std::fopen(asciiFile, "w");
+        std::fprintf(file, "ncols 3\nnrows 2\nxllcorner 100\nYLLCORNER 200\ncellsize 10\nNODATA_value -9999\n"
+                "1 2 -9999\n4 5.5 6\n");
+        std::fclose(file);
+
+        TS_ASSERT(io::importAsciiGrid(asciiFile, "", fileName));
+        io::GridReader grid(fileName);
+        TS_ASSERT(grid.isValid());
+        TS_ASSERT_EQUALS(grid.getNx(), 3);
+        TS_ASSERT_EQUALS(grid.getNy(), 2);
+        TS_ASSERT_EQUALS(grid.getOriginX(), 105);
+        TS_ASSERT_EQUALS(grid.getOriginY(), 205);
+        TS_ASSERT_EQUALS(grid.getDx(), 10);
+        // the first ASCII row is the northern one
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::BATHYMETRY, 0, 0), 4);
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::BATHYMETRY, 1, 0), 5.5);
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::BATHYMETRY, 0, 1), 1);
+        TS_ASSERT_EQUALS(grid.getValue(io::GridReader::BATHYMETRY, 2, 1), 0);
+
+        // a truncated grid is rejected
+        file = std::fopen(asciiFile, "w");
+        std::fprintf(file, "ncols 3\nnrows 2\nxllcenter 100\nyllcenter 200\ncellsize 10\n1 2 3\n4\n");
+        std::fclose(file);
+        TS_ASSERT(!io::importAsciiGrid(asciiFile, "", fileName));
+        io::GridReader missing(fileName);
+        TS_ASSERT(!missing.isValid());
+        std::remove(asciiFile);
+    }
+
+    /** \brief the scenario fills the cells below the sea level up to the displaced surface */
+    void testGridScenario()
+    {
+        const char *fileName = "grid_test.swegrid";
+        writeTestGrid(fileName, true);
+        io::GridReader grid(fileName);
+        TS_ASSERT(grid.hasDisplacement());
+
+        const unsigned int size = 60;
+        scenarios::GridScenario scenario(grid, size, 23, 0);
+        TS_ASSERT_DELTA(scenario.getCellSize(), 0.5, 1e-6);
+
+        std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+        scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+        for (unsigned int i = 0; i < size + 2; i++)
+        {
+            double x = std::min(std::max(10 + (i - 0.5) * 0.5, 10.), 40.);
+            TS_ASSERT_DELTA(b[i], bathymetry(x, 23), 1e-3);
+            T expected = b[i] >= 0 ? 0 : grid.sample(io::GridReader::DISPLACEMENT, x, 23) - b[i];
+            TS_ASSERT_DELTA(h[i], expected, 1e-3);
+            TS_ASSERT_EQUALS(hu[i], 0);
+            TS_ASSERT_EQUALS(h[i], scenario.getHeight(i));
+            TS_ASSERT_EQUALS(b[i], scenario.getBathymetry(i));
+        }
+        // the deep left part is wet and raised by the displacement, the shallow right part is dry
+        TS_ASSERT_DELTA(h[1], 1 - bathymetry(10.25, 23), 1e-3);
+        TS_ASSERT_EQUALS(h[size], 0);
+        std::remove(fileName);
+    }
+};
+
+#endif	/* _GRIDTEST_H */
@@ -0,0 +1,316 @@
+/*
+ * File:   Instrumentation.h
+ *
+ * Optional timers and counters of the hot paths of a time step.
+ */
+
+#ifndef _INSTRUMENTATION_H
+#define	_INSTRUMENTATION_H
+
+/**
+ * The instrumentation is compiled in with -DSWE_INSTRUMENTATION (scons instrumentation=1).
+ * Without it, the macros below expand to nothing and the solver is exactly the same code as before.
+ *
+ * SWE_INSTRUMENT_PHASE(phase) measures the wall time from the macro to the end of the enclosing block,
+ * SWE_INSTRUMENT_EDGES(h, hu, begin, end, stride) counts the edges i (between cell i and cell i + stride)
+ * in [begin, end) and classifies them, SWE_INSTRUMENT_END_STEP(dt) merges the counters of all threads
+ * and exports them every N steps.
+ */
+#ifdef SWE_INSTRUMENTATION
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace instrumentation {
+
+    enum Phase {
+        BOUNDARY_CONDITIONS = 0,
+        NUMERICAL_FLUXES,
+        UPDATE_UNKNOWNS,
+        /** The batched f-wave kernels, summed over all threads which call them */
+        NET_UPDATES,
+        /** The agreement of the processes on the global time step, including the wait for the slowest one */
+        TIME_STEP_REDUCTION,
+        NUMBER_OF_PHASES
+    };
+
+    /** @return The name of a phase in the exported data */
+    inline const char *getPhaseName(Phase phase) {
+        static const char *names[NUMBER_OF_PHASES] = {"boundaryConditions", "numericalFluxes", "updateUnknowns", "netUpdates",
+                "timeStepReduction"};
+        return names[phase];
+    }
+
+    /**
+     * The counters of one thread. The counters of every thread are allocated on their own cache line,
+     * so the counters of two threads never share one.
+     */
+    struct alignas(64) Counters {
+        double seconds[NUMBER_OF_PHASES];
+        unsigned long edges;
+        /** Edges where both eigenvalues have the same sign, all waves go into one direction */
+        unsigned long supersonicEdges;
+        /** Edges where exactly one cell is dry and the reflecting boundary condition is applied */
+        unsigned long wetDryEdges;
+
+        void add(const Counters &other) {
+            for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+                seconds[phase] += other.seconds[phase];
+            edges += other.edges;
+            supersonicEdges += other.supersonicEdges;
+            wetDryEdges += other.wetDryEdges;
+        }
+    };
+
+    /**
+     * Collects the counters of all threads.
+     *
+     * Every thread only writes its own counters, the counters are merged by endStep() outside of the
+     * parallel regions. A thread allocates its counters when it records for the first time, so any
+     * number of threads can record, e.g. after omp_set_num_threads() or with a num_threads clause.
+     *
+     * The merged counters are exported every interval steps as one CSV row or one JSON object per line,
+     * the values of a row are summed over the steps since the previous row.
+     */
+    class Recorder {
+    public:
+
+        enum Format {
+            CSV,
+            JSON
+        };
+
+        /** @return The recorder of the process */
+        static Recorder &instance() {
+            static Recorder recorder;
+            return recorder;
+        }
+
+        ~Recorder() {
+            closeOutput();
+            for (std::size_t thread = 0; thread < m_threads.size(); thread++) {
+                m_threads[thread]->~Counters();
+                std::free(m_threads[thread]);
+            }
+        }
+
+        /** @return The counters of the calling thread */
+        Counters &local() {
+            static thread_local Counters *counters = 0;
+            if (!counters)
+                counters = addThread();
+            return *counters;
+        }
+
+        /**
+         * Starts the export. A CSV file starts with a header line.
+         *
+         * @param [in] fileName The name of the output file
+         * @param [in] format The format of the output file
+         * @param [in] interval The counters are written every interval steps
+         * @return False if the file could not be created
+         */
+        bool setOutput(const std::string &fileName, Format format, unsigned long interval) {
+            closeOutput();
+            m_output = std::fopen(fileName.c_str(), "w");
+            m_format = format;
+            m_exportInterval = interval;
+            if (!m_output)
+                return false;
+            if (format == CSV) {
+                std::fprintf(m_output, "step,steps,minTimeStep,maxTimeStep");
+                for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+                    std::fprintf(m_output, ",%sSeconds", getPhaseName(static_cast<Phase> (phase)));
+                std::fprintf(m_output, ",edges,supersonicEdges,wetDryEdges\n");
+            }
+            return true;
+        }
+
+        /** Exports the remaining steps and closes the output file */
+        void closeOutput() {
+            if (!m_output)
+                return;
+            if (m_intervalSteps > 0)
+                write();
+            std::fclose(m_output);
+            m_output = 0;
+        }
+
+        /**
+         * Merges the counters of all threads at the end of a time step. Has to be called outside of
+         * parallel regions.
+         *
+         * @param [in] dt The time step
+         */
+        void endStep(double dt) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (std::size_t thread = 0; thread < m_threads.size(); thread++) {
+                m_interval.add(*m_threads[thread]);
+                *m_threads[thread] = Counters();
+            }
+            m_intervalMinTimeStep = m_intervalSteps == 0 ? dt : std::min(m_intervalMinTimeStep, dt);
+            m_intervalMaxTimeStep = m_intervalSteps == 0 ? dt : std::max(m_intervalMaxTimeStep, dt);
+            m_intervalSteps++;
+            if (!m_output || m_exportInterval == 0)
+                merge();
+            else if (m_intervalSteps == m_exportInterval)
+                write();
+        }
+
+        /** Discards all counters */
+        void reset() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (std::size_t thread = 0; thread < m_threads.size(); thread++)
+                *m_threads[thread] = Counters();
+            m_interval = m_total = Counters();
+            m_steps = m_intervalSteps = 0;
+        }
+
+        /** @return The counters of all finished steps, including the ones which are not exported yet */
+        Counters getTotal() const {
+            Counters total = m_total;
+            total.add(m_interval);
+            return total;
+        }
+
+        unsigned long getSteps() const {
+            return m_steps + m_intervalSteps;
+        }
+
+        double getMinTimeStep() const {
+            return m_intervalSteps > 0 && (m_steps == 0 || m_intervalMinTimeStep < m_minTimeStep) ? m_intervalMinTimeStep : m_minTimeStep;
+        }
+
+        double getMaxTimeStep() const {
+            return m_intervalSteps > 0 && (m_steps == 0 || m_intervalMaxTimeStep > m_maxTimeStep) ? m_intervalMaxTimeStep : m_maxTimeStep;
+        }
+
+    private:
+
+        Recorder() : m_output(0), m_format(CSV), m_exportInterval(0) {
+            reset();
+        }
+
+        /** @return New counters for the calling thread, aligned to a cache line */
+        Counters *addThread() {
+            void *memory;
+            if (posix_memalign(&memory, alignof(Counters), sizeof(Counters)) != 0)
+                throw std::bad_alloc();
+            Counters *counters = new (memory) Counters();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threads.push_back(counters);
+            return counters;
+        }
+
+        /** Adds the counters of the current interval to the total counters */
+        void merge() {
+            m_minTimeStep = m_steps == 0 ? m_intervalMinTimeStep : std::min(m_minTimeStep, m_intervalMinTimeStep);
+            m_maxTimeStep = m_steps == 0 ? m_intervalMaxTimeStep : std::max(m_maxTimeStep, m_intervalMaxTimeStep);
+            m_total.add(m_interval);
+            m_steps += m_intervalSteps;
+            m_interval = Counters();
+            m_intervalSteps = 0;
+        }
+
+        /** Exports the counters of the current interval */
+        void write() {
+            unsigned long step = m_steps + m_intervalSteps;
+            if (m_format == CSV) {
+                std::fprintf(m_output, "%lu,%lu,%.9e,%.9e", step, m_intervalSteps, m_intervalMinTimeStep, m_intervalMaxTimeStep);
+                for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+                    std::fprintf(m_output, ",%.9e", m_interval.seconds[phase]);
+                std::fprintf(m_output, ",%lu,%lu,%lu\n", m_interval.edges, m_interval.supersonicEdges, m_interval.wetDryEdges);
+            } else {
+                std::fprintf(m_output, "{\"step\": %lu, \"steps\": %lu, \"minTimeStep\": %.9e, \"maxTimeStep\": %.9e",
+                        step, m_intervalSteps, m_intervalMinTimeStep, m_intervalMaxTimeStep);
+                for (int phase = 0; phase < NUMBER_OF_PHASES; phase++)
+                    std::fprintf(m_output, ", \"%sSeconds\": %.9e", getPhaseName(static_cast<Phase> (phase)), m_interval.seconds[phase]);
+                std::fprintf(m_output, ", \"edges\": %lu, \"supersonicEdges\": %lu, \"wetDryEdges\": %lu}\n",
+                        m_interval.edges, m_interval.supersonicEdges, m_interval.wetDryEdges);
+            }
+            std::fflush(m_output);
+            merge();
+        }
+
+        /** The counters of every thread which has recorded so far, the threads are never removed */
+        std::vector<Counters*> m_threads;
+        std::mutex m_mutex;
+        /** Counters of the steps which are not exported yet */
+        Counters m_interval;
+        unsigned long m_intervalSteps;
+        double m_intervalMinTimeStep;
+        double m_intervalMaxTimeStep;
+        /** Counters of the exported steps */
+        Counters m_total;
+        unsigned long m_steps;
+        double m_minTimeStep;
+        double m_maxTimeStep;
+
+        std::FILE *m_output;
+        Format m_format;
+        unsigned long m_exportInterval;
+    };
+
+    /** Adds the wall time between its construction and its destruction to a phase of the calling thread */
+    class Timer {
+    public:
+
+        Timer(Phase phase) : m_phase(phase), m_start(std::chrono::steady_clock::now()) { }
+
+        ~Timer() {
+            Recorder::instance().local().seconds[m_phase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * Counts and classifies the edges i in [begin, end), edge i lies between cell i and cell i + stride.
+     * The classification uses the roe eigenvalues after the wet-dry reflection, like the solver.
+     * The gravity is passed in since this header does not depend on the solver.
+     */
+    template <typename T> void countEdges(const T *h, const T *hu, unsigned int begin, unsigned int end, unsigned int stride, T gravity) {
+        Counters &counters = Recorder::instance().local();
+        for (unsigned int i = begin; i < end; i++) {
+            T hl = h[i], hr = h[i + stride];
+            counters.edges++;
+            if (hl == 0 && hr == 0)
+                continue;
+            if (hl == 0 || hr == 0) {
+                // the reflected state has a roe velocity of 0, so the eigenvalues always have opposite signs
+                counters.wetDryEdges++;
+                continue;
+            }
+            T sqrtHl = std::sqrt(hl), sqrtHr = std::sqrt(hr);
+            T u = (hu[i] / sqrtHl + hu[i + stride] / sqrtHr) / (sqrtHl + sqrtHr);
+            T c = std::sqrt(gravity * (T) 0.5 * (hl + hr));
+            if (std::fabs(u) > c)
+                counters.supersonicEdges++;
+        }
+    }
+
+}
+
+#define SWE_INSTRUMENT_PHASE(phase) instrumentation::Timer instrumentationTimer(instrumentation::phase)
+#define SWE_INSTRUMENT_EDGES(h, hu, begin, end, stride) instrumentation::countEdges(h, hu, begin, end, stride, (T) g)
+#define SWE_INSTRUMENT_END_STEP(dt) instrumentation::Recorder::instance().endStep(dt)
+
+#else
+
+#define SWE_INSTRUMENT_PHASE(phase)
+#define SWE_INSTRUMENT_EDGES(h, hu, begin, end, stride)
+#define SWE_INSTRUMENT_END_STEP(dt)
+
+#endif
+
+#endif	/* _INSTRUMENTATION_H */
@@ -0,0 +1,156 @@
+/*
+ * File:   InstrumentationTest.h
+ *
+ * Tests of the hot path timers and counters.
+ */
+
+#ifndef _INSTRUMENTATIONTEST_H
+#define	_INSTRUMENTATIONTEST_H
+
+#ifndef SWE_INSTRUMENTATION
+#error "The instrumentation test has to be compiled with -DSWE_INSTRUMENTATION"
+#endif
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../scenarios/radialdambreak.h"
+#include "../scenarios/shockshock.h"
+#include "../WavePropagation2D.h"
+#include "../PolicyWavePropagation.h"
+#include "../solvers/FWave.hpp"
+#include "../Instrumentation.h"
+
+class InstrumentationTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief the edges of a batch are counted and classified like the solver sees them */
+    void testEdgeClassification()
+    {
+        instrumentation::Recorder &recorder = instrumentation::Recorder::instance();
+        recorder.reset();
+        // wet-dry, dry-wet, two supersonic edges (u = 10 and u = 5 against c = 4.43) and a subsonic edge
+        T h[6] = {1, 0, 2, 2, 2, 2};
+        T hu[6] = {0, 0, 20, 20, 0, 1};
+        T hL[5], hR[5], huL[5], huR[5], maxEdgeSpeed;
+        solver::FWave<T> solver;
+        solver.computeNetUpdates(h, hu, 0, 0, 5, hL, hR, huL, huR, maxEdgeSpeed);
+        recorder.endStep(0.5);
+
+        instrumentation::Counters total = recorder.getTotal();
+        TS_ASSERT_EQUALS(total.edges, 5);
+        TS_ASSERT_EQUALS(total.wetDryEdges, 2);
+        TS_ASSERT_EQUALS(total.supersonicEdges, 2);
+        TS_ASSERT(total.seconds[instrumentation::NET_UPDATES] > 0);
+        TS_ASSERT_EQUALS(recorder.getSteps(), 1);
+        TS_ASSERT_EQUALS(recorder.getMinTimeStep(), 0.5);
+    }
+
+    /** \brief every thread gets its own counters, also with more threads than at the first use of the recorder */
+    void testMoreThreads()
+    {
+        instrumentation::Recorder &recorder = instrumentation::Recorder::instance();
+        recorder.reset();
+        unsigned int numberOfThreads = 1;
+#ifdef _OPENMP
+        numberOfThreads = 2 * omp_get_max_threads() + 1;
+#endif
+#pragma omp parallel num_threads(numberOfThreads)
+        recorder.local().edges++;
+        recorder.endStep(1);
+        TS_ASSERT_EQUALS(recorder.getTotal().edges, numberOfThreads);
+    }
+
+    /** \brief the phases of the 1D time steps are timed and every edge is counted once */
+    void testPolicyPhases()
+    {
+        const unsigned int size = 1000, steps = 3;
+        scenarios::ShockShock scenario(size);
+        std::vector<T> h(size + 2), hu(size + 2);
+        scenario.fill(&h[0], &hu[0], 0, 0, size + 2);
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], 0, size, scenario.getCellSize(),
+                PolicyWavePropagation::OUTFLOW);
+
+        instrumentation::Recorder &recorder = instrumentation::Recorder::instance();
+        recorder.reset();
+        for (unsigned int step = 0; step < steps; step++)
+            wavePropagation->simulateTimeStep();
+        delete wavePropagation;
+
+        instrumentation::Counters total = recorder.getTotal();
+        TS_ASSERT_EQUALS(recorder.getSteps(), steps);
+        TS_ASSERT_EQUALS(total.edges, steps * (size + 1));
+        for (int phase = 0; phase < instrumentation::TIME_STEP_REDUCTION; phase++)
+            TS_ASSERT(total.seconds[phase] > 0);
+    }
+
+    /** \brief the phases of the 2D time steps are timed and exported every two steps */
+    void testPhasesAndExport()
+    {
+        const unsigned int size = 100, steps = 5;
+        const char *fileName = "instrumentation_test.csv";
+        scenarios::RadialDamBreak scenario(size);
+        WavePropagation2D wavePropagation(scenario, size, size);
+        wavePropagation.setActivityThreshold(-1);
+
+        instrumentation::Recorder &recorder = instrumentation::Recorder::instance();
+        // the constructor already computes one y-sweep
+        recorder.reset();
+        TS_ASSERT(recorder.setOutput(fileName, instrumentation::Recorder::CSV, 2));
+        T minTimeStep = 1e10, maxTimeStep = 0;
+        for (unsigned int step = 0; step < steps; step++)
+        {
+            T dt = wavePropagation.simulateTimeStep();
+            minTimeStep = std::min(minTimeStep, dt);
+            maxTimeStep = std::max(maxTimeStep, dt);
+        }
+
+        instrumentation::Counters total = recorder.getTotal();
+        TS_ASSERT_EQUALS(recorder.getSteps(), steps);
+        // every tile solves the edges to its ghost cells, so the edges between two tiles are solved twice
+        const unsigned int tiles = (size + WavePropagation2D::TILE_SIZE - 1) / WavePropagation2D::TILE_SIZE;
+        TS_ASSERT_EQUALS(total.edges, 2 * steps * (size + tiles) * size);
+        TS_ASSERT_EQUALS(total.supersonicEdges, 0);
+        TS_ASSERT_EQUALS(total.wetDryEdges, 0);
+        // only the distributed wave propagation has to agree on the time step
+        for (int phase = 0; phase < instrumentation::TIME_STEP_REDUCTION; phase++)
+            TS_ASSERT(total.seconds[phase] > 0);
+        TS_ASSERT_EQUALS(total.seconds[instrumentation::TIME_STEP_REDUCTION], 0);
+        TS_ASSERT_EQUALS(recorder.getMinTimeStep(), minTimeStep);
+        TS_ASSERT_EQUALS(recorder.getMaxTimeStep(), maxTimeStep);
+
+        // two full intervals and the remaining step when the output is closed
+        recorder.closeOutput();
+        std::FILE *file = std::fopen(fileName, "r");
+        char line[1024];
+        TS_ASSERT(std::fgets(line, sizeof(line), file));
+        TS_ASSERT_EQUALS(std::strncmp(line, "step,steps,minTimeStep", 22), 0);
+        unsigned int rows = 0;
+        unsigned long step, intervalSteps, edges = 0;
+        while (std::fgets(line, sizeof(line), file))
+        {
+            double timeSteps[2], seconds[instrumentation::NUMBER_OF_PHASES];
+            unsigned long rowEdges, supersonicEdges, wetDryEdges;
+            TS_ASSERT_EQUALS(std::sscanf(line, "%lu,%lu,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lu,%lu,%lu", &step, &intervalSteps,
+                    &timeSteps[0], &timeSteps[1], &seconds[0], &seconds[1], &seconds[2], &seconds[3], &seconds[4],
+                    &rowEdges, &supersonicEdges, &wetDryEdges), 12);
+            edges += rowEdges;
+            rows++;
+        }
+        std::fclose(file);
+        TS_ASSERT_EQUALS(rows, 3);
+        TS_ASSERT_EQUALS(step, steps);
+        TS_ASSERT_EQUALS(intervalSteps, 1);
+        TS_ASSERT_EQUALS(edges, total.edges);
+        std::remove(fileName);
+    }
+};
+
+#endif	/* _INSTRUMENTATIONTEST_H */
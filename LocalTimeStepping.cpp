@@ -0,0 +1,167 @@
+/*
+ * File:   LocalTimeStepping.cpp
+ *
+ * 1D wave propagation with local time stepping.
+ */
+
+#include "LocalTimeStepping.h"
+
+#include <algorithm>
+#include <cmath>
+
+LocalTimeStepping::LocalTimeStepping(T *h, T *hu, const T *b, unsigned int size, T cellSize, unsigned int maxLevel)
+    : m_h(h), m_hu(hu), m_b(b), m_size(size), m_cellSize(cellSize), m_maxLevel(maxLevel), m_usedLevel(0),
+      m_hNetUpdatesLeft(size + 1), m_hNetUpdatesRight(size + 1), m_huNetUpdatesLeft(size + 1), m_huNetUpdatesRight(size + 1),
+      m_edgeSpeeds(size + 1), m_cellLevels(size + 2, 0), m_edgeUpdates(0), m_globalEdgeUpdates(0), m_maxCourantNumber(0)
+{
+}
+
+void LocalTimeStepping::setOutflowBoundaryConditions()
+{
+    m_h[0] = m_h[1];
+    m_hu[0] = m_hu[1];
+    m_h[m_size + 1] = m_h[m_size];
+    m_hu[m_size + 1] = m_hu[m_size];
+}
+
+T LocalTimeStepping::assignLevels()
+{
+    // the speed and the net updates of every edge, the net updates are reused in the first sub step
+    const T *h = m_h, *hu = m_hu, *b = m_b;
+    T *hNetUpdatesLeft = &m_hNetUpdatesLeft[0], *hNetUpdatesRight = &m_hNetUpdatesRight[0];
+    T *huNetUpdatesLeft = &m_huNetUpdatesLeft[0], *huNetUpdatesRight = &m_huNetUpdatesRight[0];
+    T *edgeSpeeds = &m_edgeSpeeds[0];
+    T maxEdgeSpeed = 0;
+    if (b)
+    {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+        for (std::size_t i = 0; i <= m_size; i++)
+        {
+            edgeSpeeds[i] = solver::kernel::computeEdge(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1],
+                    hNetUpdatesLeft[i], hNetUpdatesRight[i], huNetUpdatesLeft[i], huNetUpdatesRight[i]);
+            maxEdgeSpeed = std::max(maxEdgeSpeed, edgeSpeeds[i]);
+        }
+    }
+    else
+    {
+#pragma omp simd reduction(max:maxEdgeSpeed)
+        for (std::size_t i = 0; i <= m_size; i++)
+        {
+            edgeSpeeds[i] = solver::kernel::computeEdge(h[i], h[i + 1], hu[i], hu[i + 1], (T) 0, (T) 0,
+                    hNetUpdatesLeft[i], hNetUpdatesRight[i], huNetUpdatesLeft[i], huNetUpdatesRight[i]);
+            maxEdgeSpeed = std::max(maxEdgeSpeed, edgeSpeeds[i]);
+        }
+    }
+
+    m_runs.clear();
+    m_usedLevel = 0;
+    if (maxEdgeSpeed == 0)
+        return 0;
+    if (m_maxLevel == 0)
+    {
+        // global time stepping, all cells stay on level 0
+        Run run = {0, m_size + 1, 0};
+        m_runs.push_back(run);
+        return 0.4 * m_cellSize / maxEdgeSpeed;
+    }
+
+    // a cell of level l may be 2^l times slower than the fastest edge
+    std::vector<unsigned int> levels(m_size + 2, 0);
+    for (unsigned int i = 1; i <= m_size; i++)
+    {
+        T cellSpeed = std::max(m_edgeSpeeds[i - 1], m_edgeSpeeds[i]);
+        unsigned int level = 0;
+        while (level < m_maxLevel && cellSpeed * (T) (2u << level) <= maxEdgeSpeed)
+            level++;
+        levels[i] = level;
+        m_usedLevel = std::max(m_usedLevel, level);
+    }
+
+    // widen the finer levels by the number of cells the fastest wave can cross during the macro step
+    unsigned int radius = (unsigned int) std::ceil(0.4 * (1u << m_usedLevel));
+    for (unsigned int i = 1; i <= m_size; i++)
+    {
+        unsigned int first = i > radius ? i - radius : 1, last = std::min(i + radius, m_size);
+        m_cellLevels[i] = *std::min_element(levels.begin() + first, levels.begin() + last + 1);
+    }
+
+    // neighbouring cells differ by at most one level
+    for (unsigned int i = 2; i <= m_size; i++)
+        m_cellLevels[i] = std::min(m_cellLevels[i], m_cellLevels[i - 1] + 1);
+    for (unsigned int i = m_size - 1; i >= 1; i--)
+        m_cellLevels[i] = std::min(m_cellLevels[i], m_cellLevels[i + 1] + 1);
+    m_cellLevels[0] = m_cellLevels[1];
+    m_cellLevels[m_size + 1] = m_cellLevels[m_size];
+
+    m_usedLevel = *std::max_element(m_cellLevels.begin(), m_cellLevels.end());
+
+    // an edge belongs to the finer of its two cells
+    for (unsigned int i = 0; i <= m_size; i++)
+    {
+        unsigned int level = std::min(m_cellLevels[i], m_cellLevels[i + 1]);
+        if (m_runs.empty() || m_runs.back().level != level)
+        {
+            Run run = {i, i + 1, level};
+            m_runs.push_back(run);
+        }
+        else
+            m_runs.back().end = i + 1;
+    }
+
+    return 0.4 * m_cellSize / maxEdgeSpeed;
+}
+
+T LocalTimeStepping::simulateMacroStep()
+{
+    setOutflowBoundaryConditions();
+    T dt = assignLevels();
+    if (dt == 0)
+        return 0;
+
+    m_maxCourantNumber = 0;
+    unsigned int subSteps = 1u << m_usedLevel;
+    for (unsigned int subStep = 0; subStep < subSteps; subStep++)
+    {
+        if (subStep > 0)
+            setOutflowBoundaryConditions();
+
+        // all active edges are computed from the same state before any cell is updated,
+        // in the first sub step this state is the one the levels were assigned with
+        for (unsigned int r = 0; r < m_runs.size(); r++)
+        {
+            const Run &run = m_runs[r];
+            if (subStep % (1u << run.level) != 0)
+                continue;
+            T maxEdgeSpeed;
+            if (subStep == 0)
+                maxEdgeSpeed = *std::max_element(m_edgeSpeeds.begin() + run.begin, m_edgeSpeeds.begin() + run.end);
+            else
+                m_solver.computeNetUpdates(m_h, m_hu, m_b, run.begin, run.end, &m_hNetUpdatesLeft[0], &m_hNetUpdatesRight[0],
+                        &m_huNetUpdatesLeft[0], &m_huNetUpdatesRight[0], maxEdgeSpeed);
+            m_maxCourantNumber = std::max(m_maxCourantNumber, maxEdgeSpeed * dt * (T) (1u << run.level) / m_cellSize);
+            m_edgeUpdates += run.end - run.begin;
+        }
+        m_globalEdgeUpdates += m_size + 1;
+
+        // both cells of an edge receive its net updates with the time step of the edge
+        for (unsigned int r = 0; r < m_runs.size(); r++)
+        {
+            const Run &run = m_runs[r];
+            if (subStep % (1u << run.level) != 0)
+                continue;
+            T dtOverCellSize = dt * (T) (1u << run.level) / m_cellSize;
+            for (unsigned int i = run.begin; i < run.end; i++)
+            {
+                m_h[i] -= dtOverCellSize * m_hNetUpdatesLeft[i];
+                m_hu[i] -= dtOverCellSize * m_huNetUpdatesLeft[i];
+            }
+            for (unsigned int i = run.begin; i < run.end; i++)
+            {
+                m_h[i + 1] -= dtOverCellSize * m_hNetUpdatesRight[i];
+                m_hu[i + 1] -= dtOverCellSize * m_huNetUpdatesRight[i];
+            }
+        }
+    }
+
+    return dt * subSteps;
+}
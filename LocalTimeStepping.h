@@ -0,0 +1,128 @@
+/*
+ * File:   LocalTimeStepping.h
+ *
+ * 1D wave propagation with local time stepping.
+ */
+
+#ifndef _LOCALTIMESTEPPING_H
+#define	_LOCALTIMESTEPPING_H
+
+#include <vector>
+
+#include "types.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Advances every cell with a time step which only depends on the local wave speed.
+ *
+ * At the beginning of each macro step the cells are grouped into levels: a cell of level l is
+ * advanced with the time step dt * 2^l, where dt is the smallest CFL time step of the domain.
+ * An edge belongs to the finer of its two cells. Within the macro step the edges of level l
+ * are computed in every 2^l-th sub step of size dt, and their net updates, scaled with the time
+ * step of the edge, are applied to both cells at once. The fluxes over an interface between two
+ * levels are thereby accumulated by the coarser cell at the rate of the finer one, so the total
+ * mass is conserved exactly like with global time stepping.
+ *
+ * The levels stay fixed during a macro step while the waves move on. To keep the CFL condition
+ * satisfied, every level is widened by the distance a wave can travel during a macro step and
+ * neighbouring cells differ by at most one level.
+ *
+ * With maxLevel = 0 this is the usual global time stepping.
+ */
+class LocalTimeStepping
+{
+public:
+
+    /**
+     * @param [in,out] h The heights of the water columns including one ghost cell on each side
+     * @param [in,out] hu The momentums of the water columns including the ghost cells
+     * @param [in] b The bathymetry including the ghost cells or NULL for a flat bathymetry
+     * @param [in] size The number of cells without the ghost cells
+     * @param [in] cellSize The size of one cell
+     * @param [in] maxLevel The coarsest level, cells advance with at most 2^maxLevel times the smallest time step
+     */
+    LocalTimeStepping(T *h, T *hu, const T *b, unsigned int size, T cellSize, unsigned int maxLevel = 4);
+
+    /**
+     * Assigns the levels and advances all cells by one macro step, the ghost cells are set to outflow
+     * boundary conditions before every sub step.
+     *
+     * @return The time step of the macro step, 0 if no wave moves (all cells are dry) and the cells stay unchanged
+     */
+    T simulateMacroStep();
+
+    /**
+     * @param [in] cell The cell, 1 to size
+     * @return The level of the cell during the last macro step
+     */
+    unsigned int getLevel(unsigned int cell) const
+    {
+        return m_cellLevels[cell];
+    }
+
+    /** @return The number of edges which were computed so far */
+    unsigned long getEdgeUpdates() const
+    {
+        return m_edgeUpdates;
+    }
+
+    /** @return The number of edges which global time stepping would have computed for the same simulated time */
+    unsigned long getGlobalEdgeUpdates() const
+    {
+        return m_globalEdgeUpdates;
+    }
+
+    /** @return The largest Courant number maxEdgeSpeed * dt / cellSize of any edge in the last macro step */
+    T getMaxCourantNumber() const
+    {
+        return m_maxCourantNumber;
+    }
+
+private:
+
+    /**
+     * A contiguous range of edges of the same level.
+     */
+    struct Run
+    {
+        unsigned int begin;
+        unsigned int end;
+        unsigned int level;
+    };
+
+    void setOutflowBoundaryConditions();
+
+    /**
+     * Computes the levels of the cells and the runs of edges for the next macro step.
+     *
+     * @return The smallest time step of the domain
+     */
+    T assignLevels();
+
+    T *m_h;
+    T *m_hu;
+    const T *m_b;
+    unsigned int m_size;
+    T m_cellSize;
+    unsigned int m_maxLevel;
+    /** The coarsest level which occurs in the current macro step */
+    unsigned int m_usedLevel;
+
+    std::vector<T> m_hNetUpdatesLeft;
+    std::vector<T> m_hNetUpdatesRight;
+    std::vector<T> m_huNetUpdatesLeft;
+    std::vector<T> m_huNetUpdatesRight;
+    /** The speeds of the edges at the beginning of the macro step */
+    std::vector<T> m_edgeSpeeds;
+
+    std::vector<unsigned int> m_cellLevels;
+    std::vector<Run> m_runs;
+
+    unsigned long m_edgeUpdates;
+    unsigned long m_globalEdgeUpdates;
+    T m_maxCourantNumber;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _LOCALTIMESTEPPING_H */
@@ -0,0 +1,78 @@
+/*
+ * File:   LocalTimeSteppingTest.h
+ *
+ * Tests of the local time stepping.
+ */
+
+#ifndef _LOCALTIMESTEPPINGTEST_H
+#define	_LOCALTIMESTEPPINGTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <vector>
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../LocalTimeStepping.h"
+#include "../ReferenceWavePropagation.h"
+
+class LocalTimeSteppingTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief with a single level the local time stepping is the global time stepping */
+    void testSingleLevel()
+    {
+        const unsigned int size = 500;
+        scenarios::ShockShock scenario(size, 300, 50);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        ReferenceWavePropagation reference(scenario, size);
+
+        LocalTimeStepping localTimeStepping(&h[0], &hu[0], 0, size, scenario.getCellSize(), 0);
+        for (int step = 0; step < 20; step++)
+        {
+            T dt = localTimeStepping.simulateMacroStep();
+            reference.simulateTimeStep(dt);
+            TS_ASSERT_DELTA(dt, reference.getMaxTimeStep(), 1e-6 * dt);
+        }
+        TS_ASSERT_EQUALS(localTimeStepping.getEdgeUpdates(), localTimeStepping.getGlobalEdgeUpdates());
+        const std::vector<T> &hGlobal = reference.getHeights(), &huGlobal = reference.getMomentums();
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            TS_ASSERT_DELTA(h[i], hGlobal[i], 1e-4 * hGlobal[i]);
+            TS_ASSERT_DELTA(hu[i], huGlobal[i], 1e-3 * std::abs(huGlobal[i]) + 1e-2);
+        }
+    }
+
+    /** \brief the shelf is advanced with coarser time steps than the trench, mass is conserved and the CFL condition holds */
+    void testShelf()
+    {
+        const unsigned int size = 2000;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+
+        double initialMass = 0;
+        for (unsigned int i = 1; i <= size; i++)
+            initialMass += h[i];
+
+        LocalTimeStepping localTimeStepping(&h[0], &hu[0], &b[0], size, scenario.getCellSize(), 4);
+        for (int step = 0; step < 50; step++)
+        {
+            localTimeStepping.simulateMacroStep();
+            TS_ASSERT(localTimeStepping.getMaxCourantNumber() <= 0.5);
+        }
+        TS_ASSERT_EQUALS(localTimeStepping.getLevel(size / 10), 0);
+        TS_ASSERT(localTimeStepping.getLevel(size - 1) >= 3);
+        TS_ASSERT(localTimeStepping.getEdgeUpdates() * 2 < localTimeStepping.getGlobalEdgeUpdates());
+
+        double mass = 0;
+        for (unsigned int i = 1; i <= size; i++)
+            mass += h[i];
+        TS_ASSERT_DELTA(mass, initialMass, 1e-5 * initialMass);
+    }
+};
+
+#endif	/* _LOCALTIMESTEPPINGTEST_H */
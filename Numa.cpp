@@ -0,0 +1,284 @@
+/*
+ * File:   Numa.cpp
+ *
+ * Allocation, first touch placement and thread pinning for large fields on NUMA systems.
+ */
+
+#include "Numa.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "scenarios/scenario.h"
+
+namespace
+{
+
+const unsigned long CELLS_PER_CHUNK = scenarios::Scenario<T>::CELLS_PER_CHUNK;
+
+/**
+ * Parses a list like "0-3,8,10-11" of the sysfs.
+ *
+ * @return The numbers of the list in ascending order
+ */
+std::vector<int> parseList(const std::string &list)
+{
+    std::vector<int> numbers;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        int first, last;
+        char dash;
+        std::stringstream rangeStream(range);
+        if (!(rangeStream >> first))
+            continue;
+        if (!(rangeStream >> dash >> last))
+            last = first;
+        for (int number = first; number <= last; number++)
+            numbers.push_back(number);
+    }
+    return numbers;
+}
+
+/** @return The first line of a file or an empty string */
+std::string readLine(const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str());
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+/**
+ * The node of every core, read once from the sysfs.
+ */
+class Topology
+{
+public:
+    Topology() : m_numberOfNodes(0)
+    {
+        std::vector<int> nodes = parseList(readLine("/sys/devices/system/node/online"));
+        for (unsigned int n = 0; n < nodes.size(); n++)
+        {
+            std::ostringstream fileName;
+            fileName << "/sys/devices/system/node/node" << nodes[n] << "/cpulist";
+            std::vector<int> cpus = parseList(readLine(fileName.str()));
+            for (unsigned int c = 0; c < cpus.size(); c++)
+            {
+                if ((unsigned int) cpus[c] >= m_nodes.size())
+                    m_nodes.resize(cpus[c] + 1, 0);
+                m_nodes[cpus[c]] = nodes[n];
+            }
+        }
+        m_numberOfNodes = std::max<unsigned int>(nodes.size(), 1);
+    }
+
+    unsigned int getNumberOfNodes() const
+    {
+        return m_numberOfNodes;
+    }
+
+    unsigned int getNode(int cpu) const
+    {
+        return cpu >= 0 && (unsigned int) cpu < m_nodes.size() ? m_nodes[cpu] : 0;
+    }
+
+private:
+    unsigned int m_numberOfNodes;
+    std::vector<unsigned int> m_nodes;
+};
+
+const Topology &topology()
+{
+    static const Topology topology;
+    return topology;
+}
+
+/** @return The cores the calling thread is allowed to run on */
+cpu_set_t getAffinity()
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0)
+        CPU_SET(0, &cpus);
+    return cpus;
+}
+
+/** @return The cores the process was allowed to run on when this was called first */
+const cpu_set_t &allowedCpus()
+{
+    static const cpu_set_t allowed = getAffinity();
+    return allowed;
+}
+
+int getThreadNumber()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+}
+
+template <typename Value> Value *numa::allocateField(unsigned long count, bool hugePages)
+{
+    std::size_t bytes = std::max<std::size_t>(count * sizeof(Value), 1);
+    std::size_t alignment = FIELD_ALIGNMENT;
+    if (bytes >= HUGE_PAGE_SIZE)
+    {
+        // the last huge page belongs to the field alone
+        alignment = HUGE_PAGE_SIZE;
+        bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+    void *field;
+    if (posix_memalign(&field, alignment, bytes) != 0)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (hugePages && alignment == HUGE_PAGE_SIZE)
+        madvise(field, bytes, MADV_HUGEPAGE);
+#endif
+    return static_cast<Value*> (field);
+}
+
+void numa::freeField(void *field)
+{
+    std::free(field);
+}
+
+template <typename Value> void numa::firstTouch(Value *field, unsigned long count, double value)
+{
+    const long numberOfChunks = (count + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK;
+#pragma omp parallel for schedule(static)
+    for (long chunk = 0; chunk < numberOfChunks; chunk++)
+    {
+        unsigned long chunkBegin = chunk * CELLS_PER_CHUNK;
+        unsigned long chunkEnd = std::min(chunkBegin + CELLS_PER_CHUNK, count);
+        std::fill(field + chunkBegin, field + chunkEnd, (Value) value);
+    }
+}
+
+template float *numa::allocateField<float>(unsigned long count, bool hugePages);
+template double *numa::allocateField<double>(unsigned long count, bool hugePages);
+template void numa::firstTouch<float>(float *field, unsigned long count, double value);
+template void numa::firstTouch<double>(double *field, unsigned long count, double value);
+
+unsigned int numa::pinThreads(Pinning pinning)
+{
+    const cpu_set_t &allowed = allowedCpus();
+    const Topology &nodes = topology();
+
+    // the allowed cores grouped by node
+    std::vector<std::vector<int> > cpusOfNodes;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+        unsigned int node = nodes.getNode(cpu);
+        if (node >= cpusOfNodes.size())
+            cpusOfNodes.resize(node + 1);
+        cpusOfNodes[node].push_back(cpu);
+    }
+    std::vector<int> cpus;
+    if (pinning == PIN_COMPACT)
+    {
+        for (unsigned int node = 0; node < cpusOfNodes.size(); node++)
+            cpus.insert(cpus.end(), cpusOfNodes[node].begin(), cpusOfNodes[node].end());
+    }
+    else if (pinning == PIN_SPREAD)
+    {
+        for (unsigned int i = 0; cpus.size() < (std::size_t) CPU_COUNT(&allowed); i++)
+            for (unsigned int node = 0; node < cpusOfNodes.size(); node++)
+                if (i < cpusOfNodes[node].size())
+                    cpus.push_back(cpusOfNodes[node][i]);
+    }
+
+    unsigned int pinned = 0;
+#pragma omp parallel reduction(+:pinned)
+    {
+        cpu_set_t set = allowed;
+        if (!cpus.empty())
+        {
+            CPU_ZERO(&set);
+            CPU_SET(cpus[getThreadNumber() % cpus.size()], &set);
+        }
+        if (sched_setaffinity(0, sizeof(set), &set) == 0)
+            pinned++;
+    }
+    return pinned;
+}
+
+bool numa::parsePinning(const char *name, Pinning &pinning)
+{
+    const std::string pinningName(name);
+    if (pinningName == "none")
+        pinning = PIN_NONE;
+    else if (pinningName == "compact")
+        pinning = PIN_COMPACT;
+    else if (pinningName == "spread")
+        pinning = PIN_SPREAD;
+    else
+        return false;
+    return true;
+}
+
+unsigned int numa::getNumberOfNodes()
+{
+    return topology().getNumberOfNodes();
+}
+
+unsigned int numa::getNode(int cpu)
+{
+    return topology().getNode(cpu);
+}
+
+double numa::getLocalFraction(const T *field, unsigned long count)
+{
+    const long numberOfChunks = (count + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK;
+    const unsigned long pageSize = sysconf(_SC_PAGESIZE);
+    unsigned long localPages = 0, placedPages = 0, failures = 0;
+#pragma omp parallel reduction(+:localPages, placedPages, failures)
+    {
+        std::vector<void*> pages;
+#pragma omp for schedule(static)
+        for (long chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned long address = reinterpret_cast<unsigned long> (field + chunk * CELLS_PER_CHUNK);
+            pages.push_back(reinterpret_cast<void*> (address / pageSize * pageSize));
+        }
+
+        // without target nodes, move_pages only returns the node of every page
+        std::vector<int> status(pages.size());
+        if (!pages.empty() && syscall(SYS_move_pages, 0, pages.size(), &pages[0], 0, &status[0], 0) != 0)
+            failures++;
+        const int node = getNode(sched_getcpu());
+        for (unsigned int i = 0; i < status.size(); i++)
+        {
+            // a negative status is an error, e.g. for a page which was never touched
+            if (status[i] < 0)
+                continue;
+            placedPages++;
+            if (status[i] == node)
+                localPages++;
+        }
+    }
+    if (failures > 0 || placedPages == 0)
+        return -1;
+    return (double) localPages / placedPages;
+}
@@ -0,0 +1,117 @@
+/*
+ * File:   Numa.h
+ *
+ * Allocation, first touch placement and thread pinning for large fields on NUMA systems.
+ */
+
+#ifndef _NUMA_H
+#define	_NUMA_H
+
+#include "types.h"
+
+/**
+ * Linux places a page on the NUMA node of the thread which touches it first. A field which is
+ * allocated and filled by a single thread therefore ends up on one socket, and the threads of the
+ * other sockets read and write it over the interconnect.
+ *
+ * The functions of this namespace keep every page of a field local to the thread which computes on
+ * it: allocateField() returns memory which is not touched yet, firstTouch() and Scenario::fill()
+ * initialize it with the static chunk schedule of FWave::computeNetUpdatesParallel(), and
+ * pinThreads() binds the OpenMP threads to fixed cores, so the same thread runs the same chunks on
+ * the same node in every time step. The placement is only preserved if the number of threads does
+ * not change between the initialization and the time steps.
+ */
+namespace numa
+{
+
+/** How the OpenMP threads are bound to the cores */
+enum Pinning
+{
+    /** Every thread may run on all cores the process was started on */
+    PIN_NONE,
+    /** Thread i runs on the i-th core, the cores are ordered by node, so neighbouring threads share a node */
+    PIN_COMPACT,
+    /** The threads are distributed round-robin over the nodes, so all memory controllers are used with few threads */
+    PIN_SPREAD
+};
+
+/** The size of a transparent huge page on x86-64 */
+const unsigned long HUGE_PAGE_SIZE = 2ul << 20;
+
+/** The alignment of all fields, the size of a cache line and of the widest vector registers */
+const unsigned long FIELD_ALIGNMENT = 64;
+
+/**
+ * Allocates a field without touching its pages.
+ *
+ * Fields of at least one huge page are aligned to HUGE_PAGE_SIZE and, if hugePages is set, advised
+ * to be backed by transparent huge pages (a hint, it has no effect if they are disabled). Smaller
+ * fields are aligned to FIELD_ALIGNMENT. A huge page is placed on the node of the thread which
+ * touches it first as a whole, so huge pages only pay off if every thread owns several of them.
+ * Fields of float and double values can be allocated, T by default.
+ *
+ * @param [in] count The number of values
+ * @param [in] hugePages Whether the field should be backed by huge pages
+ * @return The field, which has to be released with freeField()
+ * @throws std::bad_alloc If there is not enough memory, like new
+ */
+template <typename Value = T> Value *allocateField(unsigned long count, bool hugePages = true);
+
+/**
+ * Releases a field of allocateField().
+ *
+ * @param [in] field The field or NULL
+ */
+void freeField(void *field);
+
+/**
+ * Sets all values of a field in chunks of Scenario::CELLS_PER_CHUNK values, which are distributed
+ * statically over the OpenMP threads.
+ *
+ * @param [out] field The field
+ * @param [in] count The number of values
+ * @param [in] value The initial value
+ */
+template <typename Value> void firstTouch(Value *field, unsigned long count, double value = 0);
+
+/**
+ * Binds every OpenMP thread to the cores given by a pinning. Only the cores the process was allowed
+ * to run on at the first call are used, PIN_NONE restores this set for all threads.
+ *
+ * @param [in] pinning The pinning
+ * @return The number of threads which were bound successfully
+ */
+unsigned int pinThreads(Pinning pinning);
+
+/**
+ * @param [in] name none, compact or spread
+ * @param [out] pinning The pinning with this name
+ * @return False if the name is unknown
+ */
+bool parsePinning(const char *name, Pinning &pinning);
+
+/** @return The number of NUMA nodes, 1 if the topology is unknown */
+unsigned int getNumberOfNodes();
+
+/**
+ * @param [in] cpu The number of a core
+ * @return The NUMA node of the core, 0 if the topology is unknown
+ */
+unsigned int getNode(int cpu);
+
+/**
+ * Measures how much of a field is placed on the node of the thread which computes on it.
+ *
+ * Every thread looks up the page of the first value of each of its chunks (with the schedule of
+ * firstTouch()) and compares its node with the node the thread runs on. This is only meaningful if
+ * the threads are pinned.
+ *
+ * @param [in] field The field
+ * @param [in] count The number of values
+ * @return The fraction of the pages which are local, or -1 if the placement cannot be queried
+ */
+double getLocalFraction(const T *field, unsigned long count);
+
+}
+
+#endif	/* _NUMA_H */
@@ -0,0 +1,90 @@
+/*
+ * File:   NumaTest.h
+ *
+ * Tests of the field allocation, the first touch placement and the thread pinning.
+ */
+
+#ifndef _NUMATEST_H
+#define	_NUMATEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <sched.h>
+#include "../Numa.h"
+#include "../scenarios/shockshock.h"
+
+class NumaTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief small fields are aligned to cache lines, large fields to huge pages, first touch sets every value */
+    void testAllocation()
+    {
+        T *small = numa::allocateField(1000);
+        TS_ASSERT_EQUALS((unsigned long) small % numa::FIELD_ALIGNMENT, 0ul);
+        numa::firstTouch(small, 1000, 2);
+        for (unsigned long i = 0; i < 1000; i++)
+            TS_ASSERT_EQUALS(small[i], 2);
+        numa::freeField(small);
+
+        const unsigned long size = 3 * numa::HUGE_PAGE_SIZE / sizeof(T) + 5;
+        T *large = numa::allocateField(size);
+        TS_ASSERT_EQUALS((unsigned long) large % numa::HUGE_PAGE_SIZE, 0ul);
+        numa::firstTouch(large, size);
+        unsigned long zeros = 0;
+        for (unsigned long i = 0; i < size; i++)
+            zeros += large[i] == 0;
+        TS_ASSERT_EQUALS(zeros, size);
+        numa::freeField(large);
+        numa::freeField(0);
+    }
+
+    /** \brief every pinned thread runs on a single core and PIN_NONE restores the original cores */
+    void testPinning()
+    {
+        cpu_set_t original;
+        TS_ASSERT_EQUALS(sched_getaffinity(0, sizeof(original), &original), 0);
+
+        numa::Pinning pinning;
+        TS_ASSERT(numa::parsePinning("spread", pinning));
+        TS_ASSERT_EQUALS(pinning, numa::PIN_SPREAD);
+        TS_ASSERT(!numa::parsePinning("scatter", pinning));
+
+        TS_ASSERT(numa::pinThreads(numa::PIN_COMPACT) > 0);
+        cpu_set_t pinned;
+        TS_ASSERT_EQUALS(sched_getaffinity(0, sizeof(pinned), &pinned), 0);
+        TS_ASSERT_EQUALS(CPU_COUNT(&pinned), 1);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if (CPU_ISSET(cpu, &pinned))
+                TS_ASSERT(CPU_ISSET(cpu, &original));
+
+        TS_ASSERT(numa::pinThreads(numa::PIN_NONE) > 0);
+        cpu_set_t restored;
+        TS_ASSERT_EQUALS(sched_getaffinity(0, sizeof(restored), &restored), 0);
+        TS_ASSERT(CPU_EQUAL(&restored, &original));
+        TS_ASSERT(numa::getNumberOfNodes() >= 1);
+    }
+
+    /** \brief a field which is filled by the scenario with pinned threads is local to the threads */
+    void testPlacement()
+    {
+        const unsigned int size = 1000000;
+        scenarios::ShockShock scenario(size);
+        numa::pinThreads(numa::PIN_COMPACT);
+        // huge pages are placed as a whole, so a thread could own only a part of one
+        T *h = numa::allocateField(size + 2, false);
+        T *hu = numa::allocateField(size + 2, false);
+        // the pages are not placed before the first touch
+        TS_ASSERT(numa::getLocalFraction(h, size + 2) < 1);
+        scenario.fill(h, hu, 0, 0, size + 2);
+        double fraction = numa::getLocalFraction(h, size + 2);
+        // the placement cannot be queried in every environment
+        if (fraction >= 0)
+            TS_ASSERT_EQUALS(fraction, 1);
+        numa::freeField(h);
+        numa::freeField(hu);
+        numa::pinThreads(numa::PIN_NONE);
+    }
+};
+
+#endif	/* _NUMATEST_H */
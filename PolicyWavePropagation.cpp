@@ -0,0 +1,20 @@
+/*
+ * File:   PolicyWavePropagation.cpp
+ *
+ * 1D wave propagation with solver kernels specialized at compile time.
+ */
+
+#include "PolicyWavePropagation.h"
+
+PolicyWavePropagation *PolicyWavePropagation::create(T *h, T *hu, const T *b, unsigned int size, T cellSize, Boundary boundary)
+{
+    return create<solver::Precision<T> >(h, hu, b, size, cellSize, boundary);
+}
+
+PolicyWavePropagation *PolicyWavePropagation::restore(const io::SimulationState &state, Boundary boundary)
+{
+    PolicyWavePropagation *wavePropagation = create(state.h, state.hu, state.b, state.cellCount - 2, state.cellSize, boundary);
+    wavePropagation->m_time = state.time;
+    wavePropagation->m_step = state.step;
+    return wavePropagation;
+}
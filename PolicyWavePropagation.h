@@ -0,0 +1,724 @@
+/*
+ * File:   PolicyWavePropagation.h
+ *
+ * 1D wave propagation with solver kernels specialized at compile time.
+ */
+
+#ifndef _POLICYWAVEPROPAGATION_H
+#define	_POLICYWAVEPROPAGATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "Diagnostics.h"
+#include "Instrumentation.h"
+#include "Numa.h"
+#include "TileScheduler.h"
+#include "solvers/FWave.hpp"
+#include "io/Checkpoint.h"
+#include "io/GaugeWriter.h"
+
+/** Outflow boundary: the ghost cells copy the outermost cells */
+struct OutflowBoundary
+{
+    static const char *name()
+    {
+        return "outflow";
+    }
+
+    template <typename Storage> static void apply(Storage *h, Storage *hu, unsigned int size)
+    {
+        h[0] = h[1];
+        hu[0] = hu[1];
+        h[size + 1] = h[size];
+        hu[size + 1] = hu[size];
+    }
+};
+
+/** Reflecting walls: the ghost cells mirror the outermost cells with the opposite momentum */
+struct ReflectingBoundary
+{
+    static const char *name()
+    {
+        return "reflecting";
+    }
+
+    template <typename Storage> static void apply(Storage *h, Storage *hu, unsigned int size)
+    {
+        h[0] = h[1];
+        hu[0] = -hu[1];
+        h[size + 1] = h[size];
+        hu[size + 1] = -hu[size];
+    }
+};
+
+/**
+ * A 1D wave propagation whose bathymetry, wetting and boundary policies are fixed at compile time.
+ *
+ * Every combination is a separate instantiation of SpecializedWavePropagation, so the edge kernel and the
+ * boundary conditions do not test per edge or per step what is known before the run starts. create()
+ * chooses the instantiation once from the initial state of a scenario, afterwards the only dispatch is one
+ * virtual call per phase of a time step.
+ *
+ * The edge sweep and the update of the cells are split into chunks of FWave::EDGES_PER_CHUNK edges, which
+ * a TileScheduler distributes over all OpenMP threads (see FWave::computeNetUpdatesChunk and
+ * FWave::updateUnknownsChunk), the maximum edge speed of the CFL condition is reduced per thread. A time step
+ * gives bit-for-bit the same result with any number of threads. With dry cells, the chunks of edges on dry
+ * land are skipped; they are nearly free for the scheduler, so the threads with the wet chunks do not keep
+ * the others waiting.
+ *
+ * The precision is a policy as well (see solver::Precision): create<solver::Precision<float, double> >() stores
+ * h, hu, b and the net updates in float, the solver computes in double.
+ *
+ * Instead of the two phases, a time step can also be computed by the fused sweep (see FUSED), which never stores
+ * the net updates of all edges.
+ */
+class PolicyWavePropagation
+{
+public:
+
+    enum Boundary
+    {
+        OUTFLOW,
+        REFLECTING
+    };
+
+    /** How simulateTimeStep() computes a time step */
+    enum Mode
+    {
+        /** computeNumericalFluxes() stores the net updates of all edges, updateUnknowns() applies them */
+        TWO_PHASE,
+        /**
+         * One sweep computes the net updates of a chunk of edges and applies them right away (see
+         * FWave::computeAndApplyNetUpdates). The time step is estimated from the maximum edge speed of the last
+         * step. If the speeds of this step break the CFL condition (a Courant number above 0.5), the step is
+         * rejected: the unknowns are restored from a copy which the sweep takes of every chunk and the step is
+         * repeated with the time step of the measured speeds. The first step only measures the speeds.
+         * The diagnostics are only accumulated by the two-phase step.
+         */
+        FUSED
+    };
+
+    PolicyWavePropagation()
+        : m_gauges(0), m_time(0), m_step(0), m_mode(TWO_PHASE), m_rejectedSteps(0),
+          m_diagnosticsEnabled(false), m_diagnosticsCallback(0), m_diagnosticsUserData(0)
+    {
+    }
+
+    virtual ~PolicyWavePropagation()
+    {
+    }
+
+    /** Sets the values of the ghost cells */
+    virtual void setBoundaryConditions() = 0;
+
+    /**
+     * Computes the net updates of all edges.
+     *
+     * @return The maximum time step which satisfies the CFL condition, 0 if no wave moves (all cells are dry): such a
+     *         domain has no CFL limit, but stays unchanged with any time step, see simulateTimeStep()
+     */
+    virtual T computeNumericalFluxes() = 0;
+
+    /**
+     * Applies the net updates to h and hu.
+     *
+     * @param [in] dt The time step
+     */
+    virtual void updateUnknowns(T dt) = 0;
+
+    /**
+     * Computes a time step with the fused sweep, see FUSED.
+     *
+     * @param [in] maxTimeStep The largest time step the caller accepts, e.g. the time left to an output
+     * @return The time step
+     */
+    virtual T computeAndApplyNetUpdates(T maxTimeStep) = 0;
+
+    /**
+     * @return The bytes which a time step moves from and to memory per cell in the current mode, according to a
+     *         model of the traffic of the sweeps (not measured)
+     */
+    virtual double getBytesPerCell() const = 0;
+
+    /** @return The policies, e.g. "flat/wetOnly/outflow" */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @return The load imbalance of the threads in the last time step: the time of its parallel phases
+     *         divided by the time with perfectly balanced threads, see TileScheduler
+     */
+    virtual double getLoadImbalance() const = 0;
+
+    /** @return The number of chunks which were stolen by idle threads in the last time step */
+    virtual unsigned long getStolenChunks() const = 0;
+
+    /**
+     * Samples the tide gauges after every update of the unknowns.
+     *
+     * @param [in] gauges The gauges, owned by the caller, or NULL to stop sampling
+     */
+    void setGauges(io::GaugeWriter *gauges)
+    {
+        m_gauges = gauges;
+    }
+
+    /**
+     * Accumulates the diagnostics (see Diagnostics) of every time step while the unknowns are updated, instead of
+     * reading h and hu again in a separate pass. The sums are computed per block of DIAGNOSTICS_BLOCK_SIZE cells
+     * and the blocks are combined in a fixed order with compensated summation, so the diagnostics do not depend
+     * on the number of threads.
+     *
+     * @param [in] enabled False disables the diagnostics and the callback
+     * @param [in] callback Called after every time step or NULL
+     * @param [in] userData Passed to the callback
+     */
+    void setDiagnostics(bool enabled, DiagnosticsCallback callback = 0, void *userData = 0)
+    {
+        m_diagnosticsEnabled = enabled;
+        m_diagnosticsCallback = callback;
+        m_diagnosticsUserData = userData;
+    }
+
+    /** @return The diagnostics of the last time step, only valid if the diagnostics are enabled */
+    const Diagnostics &getDiagnostics() const
+    {
+        return m_diagnostics;
+    }
+
+    /** @return The simulated time */
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    /** @return The number of time steps, counted by updateUnknowns() */
+    unsigned long getStep() const
+    {
+        return m_step;
+    }
+
+    /** @param [in] mode The way simulateTimeStep() computes the following time steps */
+    void setMode(Mode mode)
+    {
+        m_mode = mode;
+    }
+
+    Mode getMode() const
+    {
+        return m_mode;
+    }
+
+    /** @return The number of fused time steps which were repeated with a smaller time step */
+    unsigned long getRejectedSteps() const
+    {
+        return m_rejectedSteps;
+    }
+
+    /**
+     * Like Ensemble::simulateUntil(), a domain in which no wave moves has no CFL limit and jumps to the largest time
+     * step of the caller, e.g. the time left to the end of a run. Without a limit, its time step is 0.
+     *
+     * @param [in] maxTimeStep The largest time step the caller accepts
+     * @return The time step
+     */
+    T simulateTimeStep(T maxTimeStep = std::numeric_limits<T>::max())
+    {
+        setBoundaryConditions();
+        T dt;
+        if (m_mode == FUSED)
+            dt = computeAndApplyNetUpdates(maxTimeStep);
+        else
+        {
+            dt = computeNumericalFluxes();
+            dt = dt == 0 ? getTimeStepAtRest(maxTimeStep) : std::min(dt, maxTimeStep);
+            updateUnknowns(dt);
+        }
+        SWE_INSTRUMENT_END_STEP(dt);
+        return dt;
+    }
+
+    /**
+     * Creates the wave propagation which is specialized for the initial state. The bathymetry is flat
+     * if b is NULL or constant, the wet-only kernel is chosen if no cell is dry.
+     *
+     * @param [in,out] h The heights of the water columns including one ghost cell on each side
+     * @param [in,out] hu The momentums of the water columns including the ghost cells
+     * @param [in] b The bathymetry including the ghost cells or NULL for a flat bathymetry
+     * @param [in] size The number of cells without the ghost cells
+     * @param [in] cellSize The size of one cell
+     * @param [in] boundary The boundary conditions at both ends of the domain
+     * @return The wave propagation, owned by the caller
+     */
+    static PolicyWavePropagation *create(T *h, T *hu, const T *b, unsigned int size, T cellSize, Boundary boundary);
+
+    /**
+     * Continues a simulation from a checkpoint, bit-identical to the simulation which wrote it.
+     * The policies are chosen for the restored state, which gives the same kernels as the interrupted run:
+     * a WetOnly run which has fallen dry continues with the wet-dry kernel in both cases.
+     *
+     * @param [in] state The state of the simulation, e.g. from io::CheckpointReader::getState(); the arrays are
+     * used directly, so a mapped checkpoint is only read where the simulation touches it
+     * @param [in] boundary The boundary conditions of the interrupted run
+     * @return The wave propagation at the time and step of the checkpoint, owned by the caller
+     */
+    static PolicyWavePropagation *restore(const io::SimulationState &state, Boundary boundary);
+
+    /**
+     * Same as create(T*, T*, const T*, unsigned int, T, Boundary), but the arrays and the net updates are stored
+     * as Precision::StorageType and the solver computes in Precision::ComputeType.
+     *
+     * @see create
+     */
+    template <typename Precision>
+    static PolicyWavePropagation *create(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+            const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary);
+
+    /** The number of cells which are summed up in one piece by the diagnostics */
+    static const unsigned int DIAGNOSTICS_BLOCK_SIZE = 1024;
+
+protected:
+
+    /** @return The time step of a domain without any moving wave, see simulateTimeStep() */
+    static T getTimeStepAtRest(T maxTimeStep)
+    {
+        // the net updates are zero, but an infinite time step would turn them into NaNs
+        return maxTimeStep < std::numeric_limits<T>::max() ? maxTimeStep : 0;
+    }
+
+    io::GaugeWriter *m_gauges;
+    double m_time;
+    unsigned long m_step;
+    Mode m_mode;
+    unsigned long m_rejectedSteps;
+
+    bool m_diagnosticsEnabled;
+    DiagnosticsCallback m_diagnosticsCallback;
+    void *m_diagnosticsUserData;
+    Diagnostics m_diagnostics;
+
+private:
+
+    template <typename Precision, typename Bathymetry>
+    static PolicyWavePropagation *createWithWetting(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+            const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary, bool dryCells);
+
+    template <typename Precision, typename Bathymetry, typename Wetting>
+    static PolicyWavePropagation *createWithBoundary(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+            const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary);
+};
+
+/**
+ * The wave propagation for one combination of policies.
+ *
+ * A run with WetOnly must not dry out. The update of the unknowns keeps track of the smallest height,
+ * once a cell falls dry the fluxes are computed with the wet-dry kernel, so the results stay valid.
+ *
+ * All arrays are stored as Precision::StorageType, the kernel is Precision::Solver.
+ */
+template <typename Bathymetry, typename Wetting, typename BoundaryConditions, typename Precision = solver::Precision<T> >
+class SpecializedWavePropagation : public PolicyWavePropagation
+{
+public:
+
+    typedef typename Precision::StorageType Storage;
+    typedef typename Precision::ComputeType Compute;
+
+    /**
+     * @param [in,out] h The heights of the water columns including one ghost cell on each side
+     * @param [in,out] hu The momentums of the water columns including the ghost cells
+     * @param [in] b The bathymetry including the ghost cells, only read with VariableBathymetry
+     * @param [in] size The number of cells without the ghost cells
+     * @param [in] cellSize The size of one cell
+     */
+    SpecializedWavePropagation(Storage *h, Storage *hu, const Storage *b, unsigned int size, T cellSize)
+        : m_h(h), m_hu(hu), m_b(b), m_size(size), m_cellSize(cellSize), m_dryCells(false), m_maxEdgeSpeed(0),
+          m_hNetUpdatesLeft(numa::allocateField<Storage>(size + 1)), m_hNetUpdatesRight(numa::allocateField<Storage>(size + 1)),
+          m_huNetUpdatesLeft(numa::allocateField<Storage>(size + 1)), m_huNetUpdatesRight(numa::allocateField<Storage>(size + 1)),
+          m_dryChunks((size + Solver::EDGES_PER_CHUNK) / Solver::EDGES_PER_CHUNK, 0),
+          m_scheduler(m_dryChunks.size()), m_minHeights(m_dryChunks.size()), m_hBackup(0), m_huBackup(0)
+    {
+        // like h and hu from Scenario::fill(), the net updates are first touched with the chunks of the edge sweep
+        numa::firstTouch(m_hNetUpdatesLeft, size + 1);
+        numa::firstTouch(m_hNetUpdatesRight, size + 1);
+        numa::firstTouch(m_huNetUpdatesLeft, size + 1);
+        numa::firstTouch(m_huNetUpdatesRight, size + 1);
+    }
+
+    ~SpecializedWavePropagation()
+    {
+        numa::freeField(m_hNetUpdatesLeft);
+        numa::freeField(m_hNetUpdatesRight);
+        numa::freeField(m_huNetUpdatesLeft);
+        numa::freeField(m_huNetUpdatesRight);
+        numa::freeField(m_hBackup);
+        numa::freeField(m_huBackup);
+    }
+
+    void setBoundaryConditions()
+    {
+        SWE_INSTRUMENT_PHASE(BOUNDARY_CONDITIONS);
+        BoundaryConditions::apply(m_h, m_hu, m_size);
+    }
+
+    T computeNumericalFluxes()
+    {
+        SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+        m_scheduler.resetStatistics();
+        // a chunk which was dry in the last sweep is most likely dry again and only scanned
+        for (unsigned int chunk = 0; chunk < m_dryChunks.size(); chunk++)
+            m_scheduler.setCost(chunk, m_dryChunks[chunk] ? 0 : 1);
+        Storage maxEdgeSpeed;
+        if (!Wetting::DRY_CELLS && m_dryCells)
+            maxEdgeSpeed = computeNetUpdates<solver::WetDry>();
+        else
+            maxEdgeSpeed = computeNetUpdates<Wetting>();
+        m_maxEdgeSpeed = maxEdgeSpeed;
+        return maxEdgeSpeed == 0 ? 0 : 0.4 * m_cellSize / maxEdgeSpeed;
+    }
+
+    void updateUnknowns(T timeStep)
+    {
+        SWE_INSTRUMENT_PHASE(UPDATE_UNKNOWNS);
+        // the simulated time advances by the time step which is applied to the stored unknowns
+        const Storage dt = timeStep;
+        if (m_diagnosticsEnabled)
+            updateUnknownsWithDiagnostics(dt);
+        else
+        {
+            // every cell is updated, the dry ones as well
+            for (unsigned int chunk = 0; chunk < m_minHeights.size(); chunk++)
+                m_scheduler.setCost(chunk, 1);
+            m_scheduler.run([this, dt](unsigned int chunk) {
+                // the edge sweep has one chunk more than the cells if size is a multiple of the chunk size
+                m_minHeights[chunk] = chunk * Solver::EDGES_PER_CHUNK < m_size ? m_solver.updateUnknownsChunk(m_h, m_hu,
+                        m_size, chunk, dt, m_cellSize, m_hNetUpdatesLeft, m_hNetUpdatesRight, m_huNetUpdatesLeft,
+                        m_huNetUpdatesRight) : std::numeric_limits<Storage>::max();
+                return 0;
+            });
+            if (!Wetting::DRY_CELLS && !m_dryCells)
+                m_dryCells = *std::min_element(m_minHeights.begin(), m_minHeights.end()) <= 0;
+        }
+        m_time += dt;
+        m_step++;
+        if (m_gauges)
+            m_gauges->write(m_h, m_hu, m_b, m_time);
+        if (m_diagnosticsEnabled && m_diagnosticsCallback)
+            m_diagnosticsCallback(m_diagnostics, m_diagnosticsUserData);
+    }
+
+    T computeAndApplyNetUpdates(T maxTimeStep)
+    {
+        // the fused sweep computes the fluxes and updates the unknowns at once, the kernel is timed as NET_UPDATES
+        SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+        if (!m_hBackup)
+        {
+            // first touched by the chunks of the sweep
+            m_hBackup = numa::allocateField<Storage>(m_size + 2);
+            m_huBackup = numa::allocateField<Storage>(m_size + 2);
+        }
+        m_scheduler.resetStatistics();
+        for (unsigned int chunk = 0; chunk < m_dryChunks.size(); chunk++)
+            m_scheduler.setCost(chunk, 1);
+
+        // without the speeds of the last step, the first sweep with a zero time step only measures them
+        Storage dt = m_maxEdgeSpeed > 0 ? std::min<T>(0.4 * m_cellSize / m_maxEdgeSpeed, maxTimeStep) : 0;
+        Storage maxEdgeSpeed = computeAndApplyNetUpdatesOfChunks(dt);
+        const bool rejected = maxEdgeSpeed * dt > 0.5 * m_cellSize;
+        if (rejected || (dt == 0 && maxEdgeSpeed > 0))
+        {
+            if (rejected)
+            {
+                m_scheduler.run([this](unsigned int chunk) {
+                    const unsigned int begin = 1 + chunk * Solver::EDGES_PER_CHUNK;
+                    const unsigned int end = std::min(begin + Solver::EDGES_PER_CHUNK, m_size + 1);
+                    if (begin < end)
+                    {
+                        std::copy(m_hBackup + begin, m_hBackup + end, m_h + begin);
+                        std::copy(m_huBackup + begin, m_huBackup + end, m_hu + begin);
+                    }
+                    return 0;
+                });
+                m_rejectedSteps++;
+            }
+            // the same cells give the same speeds
+            dt = std::min<T>(0.4 * m_cellSize / maxEdgeSpeed, maxTimeStep);
+            computeAndApplyNetUpdatesOfChunks(dt);
+        }
+        else if (maxEdgeSpeed == 0)
+            dt = getTimeStepAtRest(maxTimeStep);
+        m_maxEdgeSpeed = maxEdgeSpeed;
+        if (!Wetting::DRY_CELLS && !m_dryCells)
+            m_dryCells = *std::min_element(m_minHeights.begin(), m_minHeights.end()) <= 0;
+
+        m_time += dt;
+        m_step++;
+        if (m_gauges)
+            m_gauges->write(m_h, m_hu, m_b, m_time);
+        return dt;
+    }
+
+    double getBytesPerCell() const
+    {
+        const unsigned int bathymetry = Bathymetry::VARIABLE ? 1 : 0;
+        // fused: h and hu are read and written once, their copy for a rejected step is written (with write-allocate).
+        // Two-phase: h and hu are read twice and written once, the four net updates are written (with write-allocate)
+        // and read once. The bathymetry is read once by the edges
+        return (m_mode == FUSED ? 8 + bathymetry : 18 + bathymetry) * sizeof(Storage);
+    }
+
+    std::string getName() const
+    {
+        return std::string(Bathymetry::name()) + "/" + Wetting::name() + "/" + BoundaryConditions::name();
+    }
+
+    /** @return True if a WetOnly run has fallen back to the wet-dry kernel */
+    bool hasDryCells() const
+    {
+        return m_dryCells;
+    }
+
+    double getLoadImbalance() const
+    {
+        return m_scheduler.getLoadImbalance();
+    }
+
+    unsigned long getStolenChunks() const
+    {
+        return m_scheduler.getStolenTiles();
+    }
+
+private:
+
+    /**
+     * Computes the net updates of all edges, one chunk per tile of the scheduler.
+     *
+     * @return The maximum edge speed
+     */
+    template <typename Kernel>
+    Storage computeNetUpdates()
+    {
+        return m_scheduler.run([this](unsigned int chunk) {
+            return m_solver.template computeNetUpdatesChunk<Bathymetry, Kernel>(m_h, m_hu, m_b, 0, m_size + 1, chunk,
+                    m_hNetUpdatesLeft, m_hNetUpdatesRight, m_huNetUpdatesLeft, m_huNetUpdatesRight, &m_dryChunks[0]);
+        });
+    }
+
+    /** The net updates of an edge between two chunks of cells */
+    struct BoundaryEdge
+    {
+        Storage hNetUpdateLeft;
+        Storage hNetUpdateRight;
+        Storage huNetUpdateLeft;
+        Storage huNetUpdateRight;
+    };
+
+    /**
+     * The fused sweep: every chunk of cells is copied to the backup and updated with its inner edges by
+     * FWave::computeAndApplyNetUpdates. The edges between the chunks read a cell of both chunks, they are
+     * computed before any cell is updated. The chunks are the same with any number of threads, so are the results.
+     *
+     * @param [in] dt The time step
+     * @return The maximum edge speed of all edges
+     */
+    Storage computeAndApplyNetUpdatesOfChunks(Storage dt)
+    {
+        const unsigned int numberOfChunks = (m_size + Solver::EDGES_PER_CHUNK - 1) / Solver::EDGES_PER_CHUNK;
+        const Storage *b = Bathymetry::VARIABLE ? m_b : 0;
+        m_boundaryEdges.resize(numberOfChunks + 1);
+        Storage maxEdgeSpeed = 0;
+#pragma omp parallel for schedule(static) reduction(max:maxEdgeSpeed)
+        for (int chunk = 0; chunk <= (int) numberOfChunks; chunk++)
+        {
+            // the edge left of the chunk and the last edge, next to the ghost cell
+            const unsigned int edge = std::min(chunk * Solver::EDGES_PER_CHUNK, m_size);
+            BoundaryEdge &result = m_boundaryEdges[chunk];
+            Compute sqrtH[2], u[2], flux[2];
+            Storage edgeSpeed;
+            m_solver.computeCellQuantities(m_h + edge, m_hu + edge, 0, 2, sqrtH, u, flux);
+            m_solver.computeNetUpdates(m_h + edge, m_hu + edge, b ? b + edge : 0, sqrtH, u, flux, 0, 1, &result.hNetUpdateLeft,
+                    &result.hNetUpdateRight, &result.huNetUpdateLeft, &result.huNetUpdateRight, edgeSpeed);
+            maxEdgeSpeed = std::max(maxEdgeSpeed, edgeSpeed);
+        }
+
+        const Compute dtOverCellSize = (Compute) dt / (Compute) m_cellSize;
+        const Storage innerMaxEdgeSpeed = m_scheduler.run([this, b, dt, dtOverCellSize, numberOfChunks](unsigned int chunk) {
+            // the edge sweep has one chunk more than the cells if size is a multiple of the chunk size
+            if (chunk >= numberOfChunks)
+            {
+                m_minHeights[chunk] = std::numeric_limits<Storage>::max();
+                return (Storage) 0;
+            }
+            const unsigned int begin = 1 + chunk * Solver::EDGES_PER_CHUNK;
+            const unsigned int end = std::min(begin + Solver::EDGES_PER_CHUNK, m_size + 1);
+            std::copy(m_h + begin, m_h + end, m_hBackup + begin);
+            std::copy(m_hu + begin, m_hu + end, m_huBackup + begin);
+            // the edges inside the chunk update all of its cells but the last one
+            Storage hNetUpdateRight = m_boundaryEdges[chunk].hNetUpdateRight;
+            Storage huNetUpdateRight = m_boundaryEdges[chunk].huNetUpdateRight;
+            Storage chunkMaxEdgeSpeed;
+            m_solver.computeAndApplyNetUpdates(m_h, m_hu, b, begin, end - 1, dt, m_cellSize,
+                    hNetUpdateRight, huNetUpdateRight, chunkMaxEdgeSpeed);
+            const BoundaryEdge &right = m_boundaryEdges[chunk + 1];
+            m_h[end - 1] = (Compute) m_h[end - 1] - dtOverCellSize * ((Compute) hNetUpdateRight + (Compute) right.hNetUpdateLeft);
+            m_hu[end - 1] = (Compute) m_hu[end - 1] - dtOverCellSize * ((Compute) huNetUpdateRight + (Compute) right.huNetUpdateLeft);
+            m_minHeights[chunk] = *std::min_element(m_h + begin, m_h + end);
+            return chunkMaxEdgeSpeed;
+        });
+        return std::max(maxEdgeSpeed, innerMaxEdgeSpeed);
+    }
+
+    /** The sums and maxima of one block of cells */
+    struct DiagnosticsBlock
+    {
+        double mass;
+        double momentum;
+        double energy;
+        Compute maxSurface;
+        Compute maxVelocity;
+    };
+
+    /**
+     * Updates the unknowns and accumulates the diagnostics of the updated cells in the same sweep.
+     * The blocks are distributed over the threads, every block is summed up by the same vectorized loop.
+     */
+    void updateUnknownsWithDiagnostics(Storage dt)
+    {
+        // the same arithmetic as FWave::updateUnknownsParallel, so the diagnostics do not change the results
+        const Compute dtOverCellSize = (Compute) dt / (Compute) m_cellSize;
+        const Compute zero = 0, half = 0.5, gravity = g;
+        // the bathymetry of a flat domain is constant, but it still contributes to the potential energy and the surface
+        const Compute flatBathymetry = m_b ? m_b[0] : zero;
+        Storage *h = m_h, *hu = m_hu;
+        const Storage *b = m_b;
+        const Storage *hNetUpdatesLeft = m_hNetUpdatesLeft, *hNetUpdatesRight = m_hNetUpdatesRight;
+        const Storage *huNetUpdatesLeft = m_huNetUpdatesLeft, *huNetUpdatesRight = m_huNetUpdatesRight;
+        const int numberOfBlocks = (m_size + DIAGNOSTICS_BLOCK_SIZE - 1) / DIAGNOSTICS_BLOCK_SIZE;
+        m_diagnosticsBlocks.resize(numberOfBlocks);
+        DiagnosticsBlock *blocks = &m_diagnosticsBlocks[0];
+
+        Storage minHeight = h[1];
+#pragma omp parallel for schedule(static) reduction(min:minHeight)
+        for (int block = 0; block < numberOfBlocks; block++)
+        {
+            const std::size_t begin = 1 + (std::size_t) block * DIAGNOSTICS_BLOCK_SIZE;
+            const std::size_t end = std::min<std::size_t>(begin + DIAGNOSTICS_BLOCK_SIZE, m_size + 1);
+            double mass = 0, momentum = 0, energy = 0;
+            Compute maxSurface = -std::numeric_limits<Compute>::max(), maxVelocity = 0;
+#pragma omp simd reduction(+:mass, momentum, energy) reduction(max:maxSurface, maxVelocity) reduction(min:minHeight)
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const Storage height = (Compute) h[i] - dtOverCellSize * ((Compute) hNetUpdatesRight[i - 1] + (Compute) hNetUpdatesLeft[i]);
+                const Storage momentumOfCell = (Compute) hu[i] - dtOverCellSize * ((Compute) huNetUpdatesRight[i - 1] + (Compute) huNetUpdatesLeft[i]);
+                h[i] = height;
+                hu[i] = momentumOfCell;
+                const Compute bathymetry = Bathymetry::VARIABLE ? (Compute) b[i] : flatBathymetry;
+                const Compute velocity = height > zero ? (Compute) momentumOfCell / height : zero;
+                mass += height;
+                momentum += momentumOfCell;
+                energy += half * momentumOfCell * velocity + half * gravity * height * height + gravity * height * bathymetry;
+                maxSurface = std::max(maxSurface, height > zero ? height + bathymetry : -std::numeric_limits<Compute>::max());
+                maxVelocity = std::max(maxVelocity, std::fabs(velocity));
+                minHeight = std::min(minHeight, height);
+            }
+            DiagnosticsBlock &result = blocks[block];
+            result.mass = mass;
+            result.momentum = momentum;
+            result.energy = energy;
+            result.maxSurface = maxSurface;
+            result.maxVelocity = maxVelocity;
+        }
+        if (!Wetting::DRY_CELLS && !m_dryCells)
+            m_dryCells = minHeight <= 0;
+
+        CompensatedSum mass, momentum, energy;
+        Compute maxSurface = -std::numeric_limits<Compute>::max(), maxVelocity = 0;
+        for (int block = 0; block < numberOfBlocks; block++)
+        {
+            mass.add(blocks[block].mass);
+            momentum.add(blocks[block].momentum);
+            energy.add(blocks[block].energy);
+            maxSurface = std::max(maxSurface, blocks[block].maxSurface);
+            maxVelocity = std::max(maxVelocity, blocks[block].maxVelocity);
+        }
+        m_diagnostics.time = m_time + dt;
+        m_diagnostics.mass = mass.get() * m_cellSize;
+        m_diagnostics.momentum = momentum.get() * m_cellSize;
+        m_diagnostics.energy = energy.get() * m_cellSize;
+        m_diagnostics.maxSurface = maxSurface;
+        m_diagnostics.maxVelocity = maxVelocity;
+    }
+
+    typedef typename Precision::Solver Solver;
+
+    Storage *m_h;
+    Storage *m_hu;
+    const Storage *m_b;
+    unsigned int m_size;
+    Storage m_cellSize;
+    bool m_dryCells;
+    /** The maximum edge speed of the last time step, which estimates the time step of a fused sweep */
+    Storage m_maxEdgeSpeed;
+
+    /** The net updates, allocated with numa::allocateField() */
+    Storage *m_hNetUpdatesLeft;
+    Storage *m_hNetUpdatesRight;
+    Storage *m_huNetUpdatesLeft;
+    Storage *m_huNetUpdatesRight;
+    /** One flag per chunk of edges which was completely dry in the last sweep, see FWave::computeNetUpdatesChunk */
+    std::vector<unsigned char> m_dryChunks;
+
+    /** Distributes the chunks of edges and cells over the threads */
+    TileScheduler m_scheduler;
+    /** The smallest height of every chunk of cells after the last update */
+    std::vector<Storage> m_minHeights;
+
+    /** The unknowns before the last fused sweep, allocated with the first one */
+    Storage *m_hBackup;
+    Storage *m_huBackup;
+    /** The edges between the chunks of cells of the fused sweep */
+    std::vector<BoundaryEdge> m_boundaryEdges;
+
+    std::vector<DiagnosticsBlock> m_diagnosticsBlocks;
+
+    Solver m_solver;
+};
+
+template <typename Precision>
+PolicyWavePropagation *PolicyWavePropagation::create(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+        const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary)
+{
+    // the bathymetry of the ghost cells is read by the outermost edges, their heights are set by the boundary conditions
+    bool flat = true, dryCells = false;
+    for (unsigned int i = 0; b && i < size + 2; i++)
+        flat = flat && b[i] == b[0];
+    for (unsigned int i = 1; i <= size; i++)
+        dryCells = dryCells || h[i] <= 0;
+    if (flat)
+        return createWithWetting<Precision, solver::FlatBathymetry>(h, hu, b, size, cellSize, boundary, dryCells);
+    return createWithWetting<Precision, solver::VariableBathymetry>(h, hu, b, size, cellSize, boundary, dryCells);
+}
+
+template <typename Precision, typename Bathymetry>
+PolicyWavePropagation *PolicyWavePropagation::createWithWetting(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+        const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary, bool dryCells)
+{
+    if (dryCells)
+        return createWithBoundary<Precision, Bathymetry, solver::WetDry>(h, hu, b, size, cellSize, boundary);
+    return createWithBoundary<Precision, Bathymetry, solver::WetOnly>(h, hu, b, size, cellSize, boundary);
+}
+
+template <typename Precision, typename Bathymetry, typename Wetting>
+PolicyWavePropagation *PolicyWavePropagation::createWithBoundary(typename Precision::StorageType *h, typename Precision::StorageType *hu,
+        const typename Precision::StorageType *b, unsigned int size, T cellSize, Boundary boundary)
+{
+    if (boundary == REFLECTING)
+        return new SpecializedWavePropagation<Bathymetry, Wetting, ReflectingBoundary, Precision>(h, hu, b, size, cellSize);
+    return new SpecializedWavePropagation<Bathymetry, Wetting, OutflowBoundary, Precision>(h, hu, b, size, cellSize);
+}
+
+#endif	/* _POLICYWAVEPROPAGATION_H */
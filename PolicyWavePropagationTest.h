@@ -0,0 +1,385 @@
+/*
+ * File:   PolicyWavePropagationTest.h
+ *
+ * Tests of the wave propagation with specialized solver kernels.
+ */
+
+#ifndef _POLICYWAVEPROPAGATIONTEST_H
+#define	_POLICYWAVEPROPAGATIONTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../PolicyWavePropagation.h"
+#include "../ReferenceWavePropagation.h"
+
+class PolicyWavePropagationTest : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * \brief runs the wave propagation chosen for the initial state next to the generic kernel and compares them
+     * @param [in] expectedName The policies which have to be chosen
+     */
+    void testSingleSetup(unsigned int size, T cellSize, std::vector<T> &h, std::vector<T> &hu, const std::vector<T> &b,
+            PolicyWavePropagation::Boundary boundary, const char *expectedName)
+    {
+        ReferenceWavePropagation reference(h, hu, b, cellSize, boundary == PolicyWavePropagation::REFLECTING);
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, boundary);
+        TS_ASSERT_EQUALS(wavePropagation->getName(), expectedName);
+
+        double initialMass = 0;
+        for (unsigned int i = 1; i <= size; i++)
+            initialMass += h[i];
+        for (int step = 0; step < 30; step++)
+        {
+            T dt = wavePropagation->simulateTimeStep();
+            reference.simulateTimeStep(dt);
+            TS_ASSERT_DELTA(dt, reference.getMaxTimeStep(), 1e-6 * dt);
+        }
+
+        const std::vector<T> &hGeneric = reference.getHeights(), &huGeneric = reference.getMomentums();
+        double mass = 0;
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            TS_ASSERT_DELTA(h[i], hGeneric[i], 1e-5 * hGeneric[i]);
+            TS_ASSERT_DELTA(hu[i], huGeneric[i], 1e-4 * std::abs(huGeneric[i]) + 1e-3);
+            mass += h[i];
+        }
+        // the walls keep all of the water in the domain
+        if (boundary == PolicyWavePropagation::REFLECTING)
+            TS_ASSERT_DELTA(mass, initialMass, 1e-5 * initialMass);
+        delete wavePropagation;
+    }
+
+    /**
+     * \brief runs a wave propagation with the given precision up to a fixed time, the last time step is shortened
+     * @param [out] h The heights of the cells after the run, without the ghost cells
+     * @return The name of the policies
+     */
+    template <typename Precision>
+    std::string simulate(scenarios::Scenario<T> &scenario, unsigned int size, double endTime, std::vector<double> &h)
+    {
+        typedef typename Precision::StorageType Storage;
+        std::vector<Storage> hStorage(size + 2), huStorage(size + 2), bStorage(size + 2);
+        scenario.fill(&hStorage[0], &huStorage[0], &bStorage[0], 0, size + 2);
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create<Precision>(&hStorage[0], &huStorage[0], &bStorage[0],
+                size, scenario.getCellSize(), PolicyWavePropagation::REFLECTING);
+        while (wavePropagation->getTime() < endTime)
+            wavePropagation->simulateTimeStep(endTime - wavePropagation->getTime());
+        std::string name = wavePropagation->getName();
+        delete wavePropagation;
+        h.assign(hStorage.begin() + 1, hStorage.end() - 1);
+        return name;
+    }
+
+public:
+
+    /** \brief a wet riemann problem on a flat bathymetry gets the cheapest kernel */
+    void testFlatWetOnly()
+    {
+        const unsigned int size = 300;
+        scenarios::ShockShock scenario(size, 300, 50);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        testSingleSetup(size, scenario.getCellSize(), h, hu, b, PolicyWavePropagation::OUTFLOW, "flat/wetOnly/outflow");
+    }
+
+    /** \brief dry cells need the wet-dry kernel */
+    void testFlatWetDry()
+    {
+        const unsigned int size = 300;
+        scenarios::ShockShock scenario(size, 10, 3);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        for (unsigned int i = size / 3; i < size / 2; i++)
+            h[i] = hu[i] = 0;
+        testSingleSetup(size, scenario.getCellSize(), h, hu, b, PolicyWavePropagation::REFLECTING, "flat/wetDry/reflecting");
+    }
+
+    /** \brief a continental shelf keeps the bathymetry term */
+    void testVariableBathymetry()
+    {
+        const unsigned int size = 300;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        testSingleSetup(size, scenario.getCellSize(), h, hu, b, PolicyWavePropagation::REFLECTING, "variable/wetOnly/reflecting");
+    }
+
+    /** \brief a multi-step run gives bit-for-bit the same time steps and unknowns with one and with several threads */
+    void testThreads()
+    {
+        // several chunks of edges per thread, with a dry region and a continental shelf
+        const unsigned int size = 20000;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> hInitial, huInitial, b;
+        ReferenceWavePropagation::initialize(scenario, size, hInitial, huInitial, b);
+        for (unsigned int i = size / 4; i < size / 3; i++)
+            hInitial[i] = huInitial[i] = 0;
+        const int teams[2] = {1, 4};
+        std::vector<T> h[2], hu[2], dt[2];
+        for (int team = 0; team < 2; team++)
+        {
+#ifdef _OPENMP
+            const int threads = omp_get_max_threads();
+            omp_set_num_threads(teams[team]);
+#endif
+            h[team] = hInitial;
+            hu[team] = huInitial;
+            PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[team][0], &hu[team][0], &b[0], size,
+                    scenario.getCellSize(), PolicyWavePropagation::OUTFLOW);
+            for (int step = 0; step < 100; step++)
+                dt[team].push_back(wavePropagation->simulateTimeStep());
+            delete wavePropagation;
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#endif
+        }
+        TS_ASSERT(dt[0] == dt[1]);
+        TS_ASSERT(h[0] == h[1]);
+        TS_ASSERT(hu[0] == hu[1]);
+    }
+
+    /** \brief the chunks of a domain with a dry half are balanced by the scheduler, which measures the imbalance of every step */
+    void testLoadImbalance()
+    {
+        const unsigned int size = 20000;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        for (unsigned int i = size / 2; i <= size; i++)
+            h[i] = hu[i] = 0;
+#ifdef _OPENMP
+        const int threads = omp_get_max_threads();
+        omp_set_num_threads(4);
+#endif
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size,
+                scenario.getCellSize(), PolicyWavePropagation::OUTFLOW);
+        TS_ASSERT_EQUALS(wavePropagation->getLoadImbalance(), 1);
+        for (int step = 0; step < 10; step++)
+        {
+            wavePropagation->simulateTimeStep();
+            TS_ASSERT_LESS_THAN_EQUALS(1, wavePropagation->getLoadImbalance());
+            TS_ASSERT_LESS_THAN_EQUALS(wavePropagation->getLoadImbalance(), 4);
+        }
+        delete wavePropagation;
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+    }
+
+    /**
+     * \brief the fused sweep conserves the mass, stays close to the two-phase steps and does not depend on the number of
+     *  threads, a step whose estimated time step is too large for the speeds of the step is repeated
+     */
+    void testFused()
+    {
+        const unsigned int size = 20000;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> hInitial, huInitial, b;
+        ReferenceWavePropagation::initialize(scenario, size, hInitial, huInitial, b);
+        for (unsigned int i = size / 4; i < size / 3; i++)
+            hInitial[i] = huInitial[i] = 0;
+        const T cellSize = scenario.getCellSize();
+
+        std::vector<T> h = hInitial, hu = huInitial;
+        PolicyWavePropagation *twoPhase = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize,
+                PolicyWavePropagation::REFLECTING);
+        for (int step = 0; step < 100; step++)
+            twoPhase->simulateTimeStep();
+        const double endTime = twoPhase->getTime();
+        TS_ASSERT_EQUALS(twoPhase->getBytesPerCell(), 19 * sizeof(T));
+        delete twoPhase;
+
+        const int teams[2] = {1, 4};
+        std::vector<T> hFused[2], huFused[2], dt[2];
+        for (int team = 0; team < 2; team++)
+        {
+#ifdef _OPENMP
+            const int threads = omp_get_max_threads();
+            omp_set_num_threads(teams[team]);
+#endif
+            hFused[team] = hInitial;
+            huFused[team] = huInitial;
+            PolicyWavePropagation *fused = PolicyWavePropagation::create(&hFused[team][0], &huFused[team][0], &b[0], size,
+                    cellSize, PolicyWavePropagation::REFLECTING);
+            fused->setMode(PolicyWavePropagation::FUSED);
+            TS_ASSERT_EQUALS(fused->getBytesPerCell(), 9 * sizeof(T));
+            while (fused->getTime() < endTime)
+                dt[team].push_back(fused->simulateTimeStep(endTime - fused->getTime()));
+            TS_ASSERT_EQUALS(fused->getTime(), endTime);
+            // a dam break only slows down
+            TS_ASSERT_EQUALS(fused->getRejectedSteps(), 0);
+            delete fused;
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#endif
+        }
+        TS_ASSERT(dt[0] == dt[1]);
+        TS_ASSERT(hFused[0] == hFused[1]);
+        TS_ASSERT(huFused[0] == huFused[1]);
+
+        double mass = 0, fusedMass = 0, error = 0;
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            mass += hInitial[i];
+            fusedMass += hFused[0][i];
+            error += std::fabs(hFused[0][i] - h[i]);
+        }
+        TS_ASSERT_DELTA(fusedMass, mass, 1e-5 * mass);
+        TS_ASSERT_LESS_THAN(error, 1e-3 * mass);
+
+        // a flow in the trench which is much faster than the waves of the last step
+        PolicyWavePropagation *fused = PolicyWavePropagation::create(&hFused[0][0], &huFused[0][0], &b[0], size, cellSize,
+                PolicyWavePropagation::REFLECTING);
+        fused->setMode(PolicyWavePropagation::FUSED);
+        fused->simulateTimeStep();
+        fused->simulateTimeStep();
+        TS_ASSERT_EQUALS(fused->getRejectedSteps(), 0);
+        for (unsigned int i = size / 10; i < size / 10 + 10; i++)
+            huFused[0][i] = 3 * hFused[0][i] * std::sqrt(g * hFused[0][i]);
+        h = hFused[0];
+        hu = huFused[0];
+        T fusedDt = fused->simulateTimeStep();
+        TS_ASSERT_EQUALS(fused->getRejectedSteps(), 1);
+        delete fused;
+
+        // the repeated step is a step with the time step of the speeds in the cells before it
+        twoPhase = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, PolicyWavePropagation::REFLECTING);
+        T twoPhaseDt = twoPhase->simulateTimeStep();
+        delete twoPhase;
+        TS_ASSERT_DELTA(fusedDt, twoPhaseDt, 1e-5 * twoPhaseDt);
+        for (unsigned int i = 1; i <= size; i++)
+            TS_ASSERT_DELTA(hFused[0][i], h[i], 1e-4 * h[i] + 1e-6);
+    }
+
+    /** \brief a domain without any moving wave jumps to the largest time step of the caller in both modes */
+    void testDryDomain()
+    {
+        const unsigned int size = 3000;
+        std::vector<T> h(size + 2, 0), hu(size + 2, 0), b(size + 2, 0);
+        for (int mode = 0; mode < 2; mode++)
+        {
+            PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, 1,
+                    PolicyWavePropagation::OUTFLOW);
+            wavePropagation->setMode(mode == 0 ? PolicyWavePropagation::TWO_PHASE : PolicyWavePropagation::FUSED);
+            TS_ASSERT_EQUALS(wavePropagation->simulateTimeStep(), 0);
+            TS_ASSERT_EQUALS(wavePropagation->getTime(), 0);
+            // a run up to an end time stops
+            const double endTime = 2.5;
+            while (wavePropagation->getTime() < endTime)
+                wavePropagation->simulateTimeStep(endTime - wavePropagation->getTime());
+            TS_ASSERT_EQUALS(wavePropagation->getTime(), endTime);
+            TS_ASSERT_EQUALS(wavePropagation->getStep(), 2);
+            delete wavePropagation;
+        }
+        TS_ASSERT(h == std::vector<T>(size + 2, 0));
+        TS_ASSERT(hu == std::vector<T>(size + 2, 0));
+    }
+
+    /** \brief counts the calls of the diagnostics callback */
+    static void countDiagnostics(const Diagnostics &diagnostics, void *userData)
+    {
+        (*static_cast<int*>(userData))++;
+    }
+
+    /** \brief the diagnostics of the update sweep match a separate pass and do not depend on the number of threads */
+    void testDiagnostics()
+    {
+        // more than one block of cells
+        const unsigned int size = 3000;
+        scenarios::ShelfDamBreak scenario(size);
+        std::vector<T> h, hu, b;
+        ReferenceWavePropagation::initialize(scenario, size, h, hu, b);
+        std::vector<T> hInitial = h, huInitial = hu;
+        const T cellSize = scenario.getCellSize();
+
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, PolicyWavePropagation::REFLECTING);
+        int calls = 0;
+        wavePropagation->setDiagnostics(true, countDiagnostics, &calls);
+        double initialMass = 0;
+        for (unsigned int i = 1; i <= size; i++)
+            initialMass += h[i] * cellSize;
+        for (int step = 0; step < 50; step++)
+            wavePropagation->simulateTimeStep();
+        const Diagnostics diagnostics = wavePropagation->getDiagnostics();
+        TS_ASSERT_EQUALS(calls, 50);
+        TS_ASSERT_EQUALS(diagnostics.time, wavePropagation->getTime());
+
+        double mass = 0, momentum = 0, energy = 0;
+        T maxSurface = h[1] + b[1], maxVelocity = 0;
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            T u = hu[i] / h[i];
+            mass += h[i] * cellSize;
+            momentum += hu[i] * cellSize;
+            energy += (0.5 * hu[i] * u + 0.5 * g * h[i] * h[i] + g * h[i] * b[i]) * cellSize;
+            maxSurface = std::max(maxSurface, h[i] + b[i]);
+            maxVelocity = std::max(maxVelocity, std::abs(u));
+        }
+        TS_ASSERT_DELTA(diagnostics.mass, mass, 1e-6 * mass);
+        TS_ASSERT_DELTA(diagnostics.momentum, momentum, 1e-5 * std::abs(momentum) + 1e-3 * cellSize);
+        TS_ASSERT_DELTA(diagnostics.energy, energy, 1e-5 * std::abs(energy));
+        TS_ASSERT_EQUALS(diagnostics.maxSurface, maxSurface);
+        TS_ASSERT_EQUALS(diagnostics.maxVelocity, maxVelocity);
+        // the walls keep all of the water in the domain
+        TS_ASSERT_DELTA(diagnostics.mass, initialMass, 1e-5 * initialMass);
+        delete wavePropagation;
+
+#ifdef _OPENMP
+        // the blocks are summed up in the same order by any number of threads
+        const int threads = omp_get_max_threads();
+        omp_set_num_threads(3);
+        PolicyWavePropagation *threaded = PolicyWavePropagation::create(&hInitial[0], &huInitial[0], &b[0], size, cellSize,
+                PolicyWavePropagation::REFLECTING);
+        threaded->setDiagnostics(true);
+        for (int step = 0; step < 50; step++)
+            threaded->simulateTimeStep();
+        TS_ASSERT_EQUALS(threaded->getDiagnostics().mass, diagnostics.mass);
+        TS_ASSERT_EQUALS(threaded->getDiagnostics().momentum, diagnostics.momentum);
+        TS_ASSERT_EQUALS(threaded->getDiagnostics().energy, diagnostics.energy);
+        delete threaded;
+        omp_set_num_threads(threads);
+#endif
+    }
+
+    /**
+     * \brief a run with float storage and double arithmetic stays close to the pure double run up to the same time
+     *
+     *  The drift comes from rounding the stored heights to float, so it is about the float epsilon times the number of
+     *  steps, and the walls still keep all of the water in the domain.
+     */
+    void testMixedPrecision()
+    {
+        const unsigned int size = 3000;
+        scenarios::ShelfDamBreak scenario(size);
+        const double endTime = 200 * scenario.getCellSize() / std::sqrt(g * scenario.getHeight(1));
+        typedef solver::Precision<float, double> Mixed;
+        std::vector<double> hReference, hMixed;
+        TS_ASSERT_EQUALS(simulate<solver::Precision<double> >(scenario, size, endTime, hReference), "variable/wetOnly/reflecting");
+        TS_ASSERT_EQUALS(simulate<Mixed>(scenario, size, endTime, hMixed), "variable/wetOnly/reflecting");
+
+        double maxError = 0, mass = 0, mixedMass = 0;
+        for (unsigned int i = 0; i < size; i++)
+        {
+            maxError = std::max(maxError, std::fabs(hMixed[i] - hReference[i]) / hReference[i]);
+            mass += hReference[i];
+            mixedMass += hMixed[i];
+        }
+        TS_ASSERT(maxError > 0);
+        TS_ASSERT(maxError < 1e-5);
+        TS_ASSERT_DELTA(mixedMass, mass, 1e-6 * mass);
+    }
+};
+
+#endif	/* _POLICYWAVEPROPAGATIONTEST_H */
@@ -0,0 +1,177 @@
+/*
+ * File:   ReferenceWavePropagation.h
+ *
+ * Straightforward global time stepping, the reference of the tests and benchmarks.
+ */
+
+#ifndef _REFERENCEWAVEPROPAGATION_H
+#define	_REFERENCEWAVEPROPAGATION_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "types.h"
+#include "scenarios/scenario.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Advances all cells with the CFL time step 0.4 * cellSize / maxEdgeSpeed of the whole domain: the ghost
+ * cells are set, the net updates of all edges are computed with the generic kernel of FWave and then
+ * applied to both neighbouring cells. Nothing is specialized or fused, so the optimized wave propagations
+ * are compared against this class.
+ */
+class ReferenceWavePropagation
+{
+public:
+
+    /**
+     * Initializes h, hu and b including the ghost cells from a scenario.
+     *
+     * @param [in] scenario The scenario
+     * @param [in] size The number of cells without the ghost cells
+     * @param [out] h The heights of the water columns including one ghost cell on each side
+     * @param [out] hu The momentums of the water columns including the ghost cells
+     * @param [out] b The bathymetry including the ghost cells
+     */
+    static void initialize(scenarios::Scenario<T> &scenario, unsigned long size, std::vector<T> &h, std::vector<T> &hu,
+            std::vector<T> &b)
+    {
+        h.resize(size + 2);
+        hu.resize(size + 2);
+        b.resize(size + 2);
+        scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    }
+
+    /**
+     * Starts from the initial values of a scenario.
+     *
+     * @param [in] scenario The scenario
+     * @param [in] size The number of cells without the ghost cells
+     * @param [in] reflecting True for walls at both ends of the domain, false for outflow boundaries
+     */
+    ReferenceWavePropagation(scenarios::Scenario<T> &scenario, unsigned long size, bool reflecting = false)
+        : m_size(size), m_cellSize(scenario.getCellSize()), m_reflecting(reflecting), m_time(0),
+          m_maxTimeStep(std::numeric_limits<T>::max())
+    {
+        initialize(scenario, size, m_h, m_hu, m_b);
+        allocateNetUpdates();
+    }
+
+    /**
+     * Starts from given values.
+     *
+     * @param [in] h The heights of the water columns including one ghost cell on each side
+     * @param [in] hu The momentums of the water columns including the ghost cells
+     * @param [in] b The bathymetry including the ghost cells or an empty vector for a bathymetry of 0
+     * @param [in] cellSize The size of one cell
+     * @param [in] reflecting True for walls at both ends of the domain, false for outflow boundaries
+     */
+    ReferenceWavePropagation(const std::vector<T> &h, const std::vector<T> &hu, const std::vector<T> &b, T cellSize,
+            bool reflecting = false)
+        : m_size(h.size() - 2), m_cellSize(cellSize), m_reflecting(reflecting), m_time(0),
+          m_maxTimeStep(std::numeric_limits<T>::max()), m_h(h), m_hu(hu),
+          m_b(b.empty() ? std::vector<T>(h.size()) : b)
+    {
+        allocateNetUpdates();
+    }
+
+    /**
+     * Runs one time step.
+     *
+     * @param [in] maxTimeStep The largest allowed time step, e.g. to stop at a given time or to use the time step
+     *  of another run
+     * @return The time step, its own CFL time step if it is smaller than maxTimeStep. Like the other wave
+     *  propagations, the step without a limit is 0 if no wave moves.
+     */
+    T simulateTimeStep(T maxTimeStep = std::numeric_limits<T>::max())
+    {
+        T sign = m_reflecting ? -1 : 1;
+        m_h[0] = m_h[1];
+        m_hu[0] = sign * m_hu[1];
+        m_h[m_size + 1] = m_h[m_size];
+        m_hu[m_size + 1] = sign * m_hu[m_size];
+
+        T maxEdgeSpeed;
+        m_solver.computeNetUpdates(&m_h[0], &m_hu[0], &m_b[0], 0, m_size + 1, &m_hNetUpdatesLeft[0], &m_hNetUpdatesRight[0],
+                &m_huNetUpdatesLeft[0], &m_huNetUpdatesRight[0], maxEdgeSpeed);
+        m_maxTimeStep = maxEdgeSpeed > 0 ? 0.4 * m_cellSize / maxEdgeSpeed : std::numeric_limits<T>::max();
+        T dt = std::min(m_maxTimeStep, maxTimeStep);
+        if (dt == std::numeric_limits<T>::max())
+            return 0;
+
+        T dtOverCellSize = dt / m_cellSize;
+        for (unsigned long i = 1; i <= m_size; i++)
+        {
+            m_h[i] -= dtOverCellSize * (m_hNetUpdatesRight[i - 1] + m_hNetUpdatesLeft[i]);
+            m_hu[i] -= dtOverCellSize * (m_huNetUpdatesRight[i - 1] + m_huNetUpdatesLeft[i]);
+        }
+        m_time += dt;
+        return dt;
+    }
+
+    /**
+     * Runs time steps until the end time, the last time step is shortened.
+     *
+     * @param [in] endTime The simulated time at which to stop
+     * @return The number of time steps
+     */
+    unsigned long simulateUntil(double endTime)
+    {
+        unsigned long steps = 0;
+        for (; m_time < endTime; steps++)
+            simulateTimeStep(endTime - m_time);
+        return steps;
+    }
+
+    /** @return The CFL time step of the last step, the largest value of T if no wave moved */
+    T getMaxTimeStep() const
+    {
+        return m_maxTimeStep;
+    }
+
+    double getTime() const
+    {
+        return m_time;
+    }
+
+    /** @return The heights including the ghost cells */
+    const std::vector<T> &getHeights() const
+    {
+        return m_h;
+    }
+
+    /** @return The momentums including the ghost cells */
+    const std::vector<T> &getMomentums() const
+    {
+        return m_hu;
+    }
+
+private:
+
+    void allocateNetUpdates()
+    {
+        m_hNetUpdatesLeft.resize(m_size + 1);
+        m_hNetUpdatesRight.resize(m_size + 1);
+        m_huNetUpdatesLeft.resize(m_size + 1);
+        m_huNetUpdatesRight.resize(m_size + 1);
+    }
+
+    unsigned long m_size;
+    T m_cellSize;
+    bool m_reflecting;
+    double m_time;
+    T m_maxTimeStep;
+
+    std::vector<T> m_h;
+    std::vector<T> m_hu;
+    std::vector<T> m_b;
+    std::vector<T> m_hNetUpdatesLeft;
+    std::vector<T> m_hNetUpdatesRight;
+    std::vector<T> m_huNetUpdatesLeft;
+    std::vector<T> m_huNetUpdatesRight;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _REFERENCEWAVEPROPAGATION_H */
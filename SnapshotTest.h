@@ -0,0 +1,117 @@
+/*
+ * File:   SnapshotTest.h
+ *
+ * Tests of the snapshot writer and reader.
+ */
+
+#ifndef _SNAPSHOTTEST_H
+#define	_SNAPSHOTTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <vector>
+#include "../io/SnapshotWriter.h"
+#include "../io/SnapshotReader.h"
+
+class SnapshotTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief writes every second of ten steps and reads them back
+     *
+     *  Only one buffer is used, so the writer has to wait for the I/O thread most of the time.
+     */
+    void testWriteAndRead()
+    {
+        const unsigned long size = 1000;
+        const char *fileName = "snapshot_test.swe";
+        T h[size], hu[size], b[size];
+        {
+            io::SnapshotWriter writer(fileName, size, 2.5, true, 2, 0, 1);
+            TS_ASSERT(writer.isOpen());
+            for (unsigned long step = 0; step < 10; step++)
+            {
+                fill(h, hu, b, size, step);
+                TS_ASSERT_EQUALS(writer.write(h, hu, b, step, 0.5 * step), step % 2 == 0);
+            }
+        }
+
+        io::SnapshotReader reader(fileName);
+        TS_ASSERT(reader.isValid());
+        TS_ASSERT_EQUALS(reader.getNumberOfSnapshots(), 5);
+        TS_ASSERT_EQUALS(reader.getNumberOfCells(), size);
+        TS_ASSERT_EQUALS(reader.getCellSize(), 2.5);
+        TS_ASSERT(reader.hasBathymetry());
+        for (unsigned long snapshot = 0; snapshot < 5; snapshot++)
+        {
+            unsigned long step = 2 * snapshot;
+            TS_ASSERT_EQUALS(reader.getStep(snapshot), step);
+            TS_ASSERT_EQUALS(reader.getTime(snapshot), 0.5 * step);
+            fill(h, hu, b, size, step);
+            for (unsigned long i = 0; i < size; i++)
+            {
+                TS_ASSERT_EQUALS(reader.getHeight(snapshot)[i], h[i]);
+                TS_ASSERT_EQUALS(reader.getMomentum(snapshot)[i], hu[i]);
+                TS_ASSERT_EQUALS(reader.getBathymetry(snapshot)[i], b[i]);
+            }
+        }
+        TS_ASSERT_EQUALS(reader.findSnapshot(2.9), 2);
+        TS_ASSERT_EQUALS(reader.findSnapshot(3.0), 3);
+        TS_ASSERT_EQUALS(reader.findSnapshot(100), 4);
+        std::remove(fileName);
+    }
+
+    /** \brief tests that snapshots are taken whenever the simulated time passes a multiple of the interval
+     *
+     */
+    void testTimeInterval()
+    {
+        const unsigned long size = 10;
+        T h[size], hu[size], b[size];
+        fill(h, hu, b, size, 0);
+        io::SnapshotWriter writer("snapshot_test_time.swe", size, 1, false, 0, 1.0);
+        TS_ASSERT(writer.write(h, hu, 0, 0, 0.0));
+        TS_ASSERT(!writer.write(h, hu, 0, 1, 0.7));
+        TS_ASSERT(writer.write(h, hu, 0, 2, 1.4));
+        TS_ASSERT(!writer.write(h, hu, 0, 3, 1.9));
+        TS_ASSERT(writer.write(h, hu, 0, 4, 3.5));
+        TS_ASSERT_EQUALS(writer.getNumberOfSnapshots(), 3);
+        TS_ASSERT(writer.close());
+        std::remove("snapshot_test_time.swe");
+    }
+
+    /** \brief a full disk closes the writer and close() reports it, so does a file which cannot be created */
+    void testWriteFailure()
+    {
+        // larger than the buffer of the stream, so the I/O thread already notices the failure before close()
+        const unsigned long size = 100000;
+        std::vector<T> h(size, 1), hu(size, 0);
+        io::SnapshotWriter writer("/dev/full", size, 1);
+        TS_ASSERT(writer.isOpen());
+        for (unsigned long step = 0; step < 3; step++)
+            writer.write(&h[0], &hu[0], 0, step, step);
+        TS_ASSERT(!writer.close());
+        TS_ASSERT(writer.hasFailed());
+        TS_ASSERT(!writer.isOpen());
+        TS_ASSERT(!writer.write(&h[0], &hu[0], 0, 3, 3));
+
+        io::SnapshotWriter missing("no_such_directory/snapshot_test.swe", size, 1);
+        TS_ASSERT(!missing.isOpen());
+        TS_ASSERT(!missing.close());
+    }
+
+private:
+
+    void fill(T *h, T *hu, T *b, unsigned long size, unsigned long step)
+    {
+        for (unsigned long i = 0; i < size; i++)
+        {
+            h[i] = 10 + i + 0.25 * step;
+            hu[i] = i * step;
+            b[i] = -(T) i;
+        }
+    }
+};
+
+#endif	/* _SNAPSHOTTEST_H */
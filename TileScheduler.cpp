@@ -0,0 +1,151 @@
+/*
+ * File:   TileScheduler.cpp
+ *
+ * Work-stealing distribution of tiles over the OpenMP threads.
+ */
+
+#include "TileScheduler.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+TileScheduler::TileScheduler(unsigned int numberOfTiles)
+    : m_costs(numberOfTiles, 1), m_queues(0), m_numberOfQueues(0), m_numberOfThreads(0),
+      m_maxBusyTime(0), m_meanBusyTime(0), m_stolenTiles(0)
+{
+}
+
+TileScheduler::~TileScheduler()
+{
+    releaseQueues();
+}
+
+void TileScheduler::releaseQueues()
+{
+    for (unsigned int thread = 0; thread < m_numberOfQueues; thread++)
+        m_queues[thread].~Queue();
+    std::free(m_queues);
+    m_queues = 0;
+    m_numberOfQueues = 0;
+}
+
+unsigned int TileScheduler::getThreadNumber()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+unsigned int TileScheduler::getNumberOfThreads()
+{
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+}
+
+void TileScheduler::distribute(unsigned int numberOfThreads)
+{
+    if (numberOfThreads > m_numberOfQueues)
+    {
+        releaseQueues();
+        void *queues;
+        if (posix_memalign(&queues, alignof(Queue), numberOfThreads * sizeof(Queue)) != 0)
+            throw std::bad_alloc();
+        m_queues = static_cast<Queue*> (queues);
+        for (unsigned int thread = 0; thread < numberOfThreads; thread++)
+            new (&m_queues[thread]) Queue();
+        m_numberOfQueues = numberOfThreads;
+    }
+    m_numberOfThreads = numberOfThreads;
+
+    const unsigned int numberOfTiles = m_costs.size();
+    double totalCost = 0;
+    for (unsigned int tile = 0; tile < numberOfTiles; tile++)
+        totalCost += m_costs[tile];
+    // without any estimated cost, every thread gets the same number of tiles
+    const bool uniform = totalCost <= 0;
+    if (uniform)
+        totalCost = numberOfTiles;
+
+    unsigned int tile = 0;
+    double cost = 0;
+    for (unsigned int thread = 0; thread < numberOfThreads; thread++)
+    {
+        Queue &queue = m_queues[thread];
+        const double endCost = totalCost * (thread + 1) / numberOfThreads;
+        queue.begin = tile;
+        // a tile goes to the thread whose share contains the middle of its cost
+        while (tile < numberOfTiles && (thread + 1 == numberOfThreads || cost + 0.5 * (uniform ? 1 : m_costs[tile]) <= endCost))
+        {
+            cost += uniform ? 1 : m_costs[tile];
+            tile++;
+        }
+        queue.end = tile;
+        queue.stolenTiles = 0;
+        queue.busyTime = 0;
+    }
+}
+
+bool TileScheduler::next(unsigned int thread, unsigned int &tile)
+{
+    Queue &own = m_queues[thread];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin < own.end)
+        {
+            tile = own.begin++;
+            return true;
+        }
+    }
+
+    // the back half of the first thread with tiles left, the thieves start at different threads
+    for (unsigned int i = 1; i < m_numberOfThreads; i++)
+    {
+        Queue &victim = m_queues[(thread + i) % m_numberOfThreads];
+        unsigned int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin == victim.end)
+                continue;
+            end = victim.end;
+            begin = end - (end - victim.begin + 1) / 2;
+            victim.end = begin;
+        }
+        // the stolen tiles are in no queue until here, but this thread processes them in any case
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin + 1;
+        own.end = end;
+        own.stolenTiles += end - begin;
+        tile = begin;
+        return true;
+    }
+    return false;
+}
+
+void TileScheduler::accumulateBusyTimes()
+{
+    double maxBusyTime = 0, busyTime = 0;
+    for (unsigned int thread = 0; thread < m_numberOfThreads; thread++)
+    {
+        maxBusyTime = std::max(maxBusyTime, m_queues[thread].busyTime);
+        busyTime += m_queues[thread].busyTime;
+        m_stolenTiles += m_queues[thread].stolenTiles;
+    }
+    m_maxBusyTime += maxBusyTime;
+    m_meanBusyTime += busyTime / m_numberOfThreads;
+}
+
+void TileScheduler::resetStatistics()
+{
+    m_maxBusyTime = 0;
+    m_meanBusyTime = 0;
+    m_stolenTiles = 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * File:   TileScheduler.h
+ *
+ * Work-stealing distribution of tiles over the OpenMP threads.
+ */
+
+#ifndef _TILESCHEDULER_H
+#define	_TILESCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "types.h"
+
+/**
+ * Runs a function on every tile of a grid with all OpenMP threads.
+ *
+ * Every thread owns a deque with a contiguous range of tiles. The ranges are cut so that all
+ * threads get the same estimated cost, with equal costs they match the static schedule of OpenMP
+ * and thereby the first touch placement of the tiles. A thread takes its tiles from the front of
+ * its own deque. Once it is empty, the thread steals the back half of the range of another thread,
+ * so a wrong estimate only costs the time until the other threads ran out of work. The tiles stay
+ * contiguous, which keeps the neighbours of a tile in the same cache as long as possible.
+ *
+ * The maximum of the values returned by the function is reduced by every thread as its tiles
+ * complete, the partial maxima are combined at the end of the run.
+ *
+ * The busy time of every thread is measured from the start of a run until it found no more tiles.
+ * The load imbalance is the sum of the longest busy times of all runs divided by the sum of the
+ * mean busy times: 1 if the threads were perfectly balanced, the number of threads if one thread
+ * did all the work.
+ */
+class TileScheduler
+{
+public:
+
+    /**
+     * @param [in] numberOfTiles The number of tiles, all tiles have the estimated cost 1
+     */
+    TileScheduler(unsigned int numberOfTiles);
+
+    ~TileScheduler();
+
+    /**
+     * @param [in] tile The tile
+     * @param [in] cost The estimated cost of the tile in any unit, 0 for a tile which is skipped
+     */
+    void setCost(unsigned int tile, double cost)
+    {
+        m_costs[tile] = cost;
+    }
+
+    /**
+     * Calls work(tile) for every tile exactly once with all OpenMP threads.
+     *
+     * @param [in] work The function, it returns a value for the maximum, e.g. the maximum edge speed of the tile
+     * @return The maximum of the values returned by all calls
+     */
+    template <typename Work>
+    T run(Work work)
+    {
+        T maxValue = 0;
+        double start = now();
+#pragma omp parallel reduction(max:maxValue)
+        {
+            const unsigned int thread = getThreadNumber();
+            // the other threads wait at the end of the single construct
+#pragma omp single
+            distribute(getNumberOfThreads());
+
+            T threadMaxValue = 0;
+            unsigned int tile;
+            while (next(thread, tile))
+                threadMaxValue = std::max(threadMaxValue, (T) work(tile));
+            m_queues[thread].busyTime = now() - start;
+            maxValue = std::max(maxValue, threadMaxValue);
+        }
+        accumulateBusyTimes();
+        return maxValue;
+    }
+
+    /** Starts a new measurement of the load imbalance and the stolen tiles */
+    void resetStatistics();
+
+    /** @return The load imbalance of all runs since the last reset, 1 if there was no run */
+    double getLoadImbalance() const
+    {
+        return m_meanBusyTime > 0 ? m_maxBusyTime / m_meanBusyTime : 1;
+    }
+
+    /** @return The number of tiles which were stolen since the last reset */
+    unsigned long getStolenTiles() const
+    {
+        return m_stolenTiles;
+    }
+
+private:
+
+    /** The size of a cache line */
+    static const unsigned int CACHE_LINE_SIZE = 64;
+
+    /**
+     * The range of tiles which a thread has not processed yet and the statistics of the thread.
+     * Every queue starts on its own cache line and is padded to a multiple of it, so a thread
+     * never writes to a line another thread works on.
+     */
+    struct alignas(CACHE_LINE_SIZE) Queue
+    {
+        std::mutex mutex;
+        unsigned int begin;
+        unsigned int end;
+        /** The number of tiles this thread stole in the current run */
+        unsigned long stolenTiles;
+        /** The busy time of this thread in the current run */
+        double busyTime;
+    };
+
+    static double now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** @return The number of the calling thread in the current team */
+    static unsigned int getThreadNumber();
+
+    /** @return The number of threads in the current team */
+    static unsigned int getNumberOfThreads();
+
+    /** Cuts the tiles into one range of equal estimated cost per thread */
+    void distribute(unsigned int numberOfThreads);
+
+    /**
+     * Takes the next tile of a thread, from its own range or stolen from another thread.
+     *
+     * @return False if all tiles were taken
+     */
+    bool next(unsigned int thread, unsigned int &tile);
+
+    /** Adds the longest and the mean busy time of the last run to the statistics */
+    void accumulateBusyTimes();
+
+    /** Destroys and releases all queues */
+    void releaseQueues();
+
+    std::vector<double> m_costs;
+
+    /**
+     * One queue per thread, allocated for the largest team seen so far. The queues are
+     * allocated with the alignment of Queue, which new only guarantees since C++17.
+     */
+    Queue *m_queues;
+    unsigned int m_numberOfQueues;
+    /** The number of threads of the current run */
+    unsigned int m_numberOfThreads;
+
+    double m_maxBusyTime;
+    double m_meanBusyTime;
+    unsigned long m_stolenTiles;
+};
+
+#endif	/* _TILESCHEDULER_H */
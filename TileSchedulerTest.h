@@ -0,0 +1,91 @@
+/*
+ * File:   TileSchedulerTest.h
+ *
+ * Tests of the work-stealing tile scheduler.
+ */
+
+#ifndef _TILESCHEDULERTEST_H
+#define	_TILESCHEDULERTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../TileScheduler.h"
+#include "../WavePropagation2D.h"
+#include "../scenarios/radialdambreak.h"
+
+class TileSchedulerTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief every tile is processed exactly once and the maximum is reduced over all tiles, also with wrong estimates */
+    void testAllTiles()
+    {
+#ifdef _OPENMP
+        const int numberOfThreads = omp_get_max_threads();
+        omp_set_num_threads(4);
+#endif
+        const unsigned int numberOfTiles = 1000;
+        TileScheduler scheduler(numberOfTiles);
+        std::vector<int> calls(numberOfTiles, 0);
+        for (int run = 0; run < 3; run++)
+        {
+            // the first run has uniform costs, the others put all the estimated cost on a few tiles
+            for (unsigned int tile = 0; tile < numberOfTiles && run > 0; tile++)
+                scheduler.setCost(tile, tile % (100 * run) == 0 ? 1 : 0);
+            T maxValue = scheduler.run([&calls](unsigned int tile) {
+                calls[tile]++;
+                // the real cost is spread evenly, so the skewed estimate needs stealing
+                volatile T sum = 0;
+                for (int i = 0; i < 2000; i++)
+                    sum = sum + i;
+                return tile == 777 ? (T) 3.5 : (T) 0.5;
+            });
+            TS_ASSERT_EQUALS(maxValue, 3.5);
+        }
+        for (unsigned int tile = 0; tile < numberOfTiles; tile++)
+            TS_ASSERT_EQUALS(calls[tile], 3);
+        TS_ASSERT(scheduler.getLoadImbalance() >= 1);
+
+        scheduler.resetStatistics();
+        TS_ASSERT_EQUALS(scheduler.getLoadImbalance(), 1);
+        TS_ASSERT_EQUALS(scheduler.getStolenTiles(), 0ul);
+#ifdef _OPENMP
+        omp_set_num_threads(numberOfThreads);
+#endif
+    }
+
+    /** \brief the 2d wave propagation gives the same result with any number of threads */
+    void testWavePropagation2D()
+    {
+        const unsigned int size = 300;
+        scenarios::RadialDamBreak scenario(size);
+        const int teams[2] = {1, 4};
+        std::vector<T> h[2];
+        for (int team = 0; team < 2; team++)
+        {
+#ifdef _OPENMP
+            const int numberOfThreads = omp_get_max_threads();
+            omp_set_num_threads(teams[team]);
+#endif
+            WavePropagation2D wavePropagation(scenario, size, size);
+            for (int step = 0; step < 30; step++)
+            {
+                wavePropagation.simulateTimeStep();
+                TS_ASSERT(wavePropagation.getLoadImbalance() >= 1);
+            }
+            for (unsigned int y = 1; y <= size; y++)
+                for (unsigned int x = 1; x <= size; x++)
+                    h[team].push_back(wavePropagation.getHeight(x, y));
+#ifdef _OPENMP
+            omp_set_num_threads(numberOfThreads);
+#endif
+        }
+        TS_ASSERT(h[0] == h[1]);
+    }
+};
+
+#endif	/* _TILESCHEDULERTEST_H */
@@ -0,0 +1,306 @@
+/*
+ * File:   WavePropagation2D.cpp
+ *
+ * Two dimensional wave propagation using dimensional splitting and the f-wave solver.
+ */
+
+#include "WavePropagation2D.h"
+#include "Instrumentation.h"
+#include "Numa.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+WavePropagation2D::WavePropagation2D(scenarios::Scenario<T> &scenario, unsigned int sizeX, unsigned int sizeY)
+    : m_sizeX(sizeX), m_sizeY(sizeY), m_cellSize(scenario.getCellSize()),
+      m_tilesX((sizeX + TILE_SIZE - 1) / TILE_SIZE), m_tilesY((sizeY + TILE_SIZE - 1) / TILE_SIZE),
+      m_maxEdgeSpeedY(0), m_active(m_tilesX * m_tilesY, 1), m_changed(m_tilesX * m_tilesY, 0),
+      m_activityThreshold(0), m_skippedEdges(0), m_scheduler(m_tilesX * m_tilesY)
+{
+    // seven arrays per tile, each padded to a multiple of the cache line size
+    const unsigned long fieldSize = (STRIDE * STRIDE * sizeof(T) + numa::FIELD_ALIGNMENT - 1) / numa::FIELD_ALIGNMENT
+            * numa::FIELD_ALIGNMENT / sizeof(T);
+    m_tiles = new Tile[m_tilesX * m_tilesY];
+    m_storage = numa::allocateField(7 * fieldSize * m_tilesX * m_tilesY);
+
+    // every tile is initialized by the scheduler, which distributes the tiles like in the sweeps as long as all
+    // tiles are active, so its pages are first touched by the thread which solves it
+    m_scheduler.run([this, &scenario, fieldSize, sizeX, sizeY](unsigned int t) {
+        unsigned int tileX = t % m_tilesX;
+        unsigned int tileY = t / m_tilesX;
+        Tile &tile = m_tiles[t];
+        tile.sizeX = std::min(TILE_SIZE, sizeX - tileX * TILE_SIZE);
+        tile.sizeY = std::min(TILE_SIZE, sizeY - tileY * TILE_SIZE);
+        T *fields = m_storage + 7 * fieldSize * t;
+        std::fill(fields, fields + 7 * fieldSize, (T) 0);
+        tile.h = fields;
+        tile.hu = fields + fieldSize;
+        tile.hv = fields + 2 * fieldSize;
+        tile.hNetUpdatesLeft = fields + 3 * fieldSize;
+        tile.hNetUpdatesRight = fields + 4 * fieldSize;
+        tile.huNetUpdatesLeft = fields + 5 * fieldSize;
+        tile.huNetUpdatesRight = fields + 6 * fieldSize;
+        tile.maxEdgeSpeedX = tile.maxEdgeSpeedY = 0;
+
+        for (unsigned int j = 1; j <= tile.sizeY; j++)
+        {
+            for (unsigned int i = 1; i <= tile.sizeX; i++)
+            {
+                unsigned int x = tileX * TILE_SIZE + i;
+                unsigned int y = tileY * TILE_SIZE + j;
+                tile.h[j * STRIDE + i] = scenario.getHeight(x, y);
+                tile.hu[j * STRIDE + i] = scenario.getMomentumX(x, y);
+                tile.hv[j * STRIDE + i] = scenario.getMomentumY(x, y);
+            }
+        }
+        return 0;
+    });
+
+    // all tiles are active in the first time step
+    updateActiveTiles(true);
+
+    // the first time step needs an estimate of the speed in y direction
+    setOutflowBoundaryConditions();
+    m_maxEdgeSpeedY = computeYSweep();
+}
+
+WavePropagation2D::~WavePropagation2D()
+{
+    numa::freeField(m_storage);
+    delete [] m_tiles;
+}
+
+void WavePropagation2D::fillGhostLayer(unsigned int tileX, unsigned int tileY)
+{
+    Tile &tile = m_tiles[tileY * m_tilesX + tileX];
+    T *fields[3] = {tile.h, tile.hu, tile.hv};
+
+    // left and right ghost column
+    const Tile *left = tileX > 0 ? &m_tiles[tileY * m_tilesX + tileX - 1] : 0;
+    const Tile *right = tileX + 1 < m_tilesX ? &m_tiles[tileY * m_tilesX + tileX + 1] : 0;
+    for (int field = 0; field < 3; field++)
+    {
+        const T *leftField = left ? (field == 0 ? left->h : field == 1 ? left->hu : left->hv) : 0;
+        const T *rightField = right ? (field == 0 ? right->h : field == 1 ? right->hu : right->hv) : 0;
+        for (unsigned int j = 1; j <= tile.sizeY; j++)
+        {
+            fields[field][j * STRIDE] = left ? leftField[j * STRIDE + left->sizeX] : fields[field][j * STRIDE + 1];
+            fields[field][j * STRIDE + tile.sizeX + 1] = right ? rightField[j * STRIDE + 1] : fields[field][j * STRIDE + tile.sizeX];
+        }
+    }
+
+    // lower and upper ghost row
+    const Tile *lower = tileY > 0 ? &m_tiles[(tileY - 1) * m_tilesX + tileX] : 0;
+    const Tile *upper = tileY + 1 < m_tilesY ? &m_tiles[(tileY + 1) * m_tilesX + tileX] : 0;
+    for (int field = 0; field < 3; field++)
+    {
+        const T *lowerField = lower ? (field == 0 ? lower->h : field == 1 ? lower->hu : lower->hv) : 0;
+        const T *upperField = upper ? (field == 0 ? upper->h : field == 1 ? upper->hu : upper->hv) : 0;
+        const T *lowerRow = lower ? lowerField + lower->sizeY * STRIDE : fields[field] + STRIDE;
+        const T *upperRow = upper ? upperField + STRIDE : fields[field] + tile.sizeY * STRIDE;
+        std::copy(lowerRow + 1, lowerRow + tile.sizeX + 1, fields[field] + 1);
+        std::copy(upperRow + 1, upperRow + tile.sizeX + 1, fields[field] + (tile.sizeY + 1) * STRIDE + 1);
+    }
+}
+
+void WavePropagation2D::setOutflowBoundaryConditions()
+{
+    SWE_INSTRUMENT_PHASE(BOUNDARY_CONDITIONS);
+    // every tile only reads the interior cells of its neighbours and writes its own ghost layer.
+    // The neighbours of an inactive tile did not change, so its ghost layer is still valid
+    m_scheduler.run([this](unsigned int tile) {
+        if (m_active[tile])
+            fillGhostLayer(tile % m_tilesX, tile / m_tilesX);
+        return 0;
+    });
+}
+
+T WavePropagation2D::computeXSweep()
+{
+    SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+    T maxEdgeSpeed = m_scheduler.run([this](unsigned int t) {
+        Tile &tile = m_tiles[t];
+        if (!m_active[t])
+            return tile.maxEdgeSpeedX;
+        tile.maxEdgeSpeedX = 0;
+        for (unsigned int j = 1; j <= tile.sizeY; j++)
+        {
+            unsigned int row = j * STRIDE;
+            T rowMaxEdgeSpeed;
+            // the edges 0 to sizeX of the row, including the ones to the ghost cells
+            m_solver.computeNetUpdates(tile.h + row, tile.hu + row, 0, 0, tile.sizeX + 1,
+                    tile.hNetUpdatesLeft + row, tile.hNetUpdatesRight + row,
+                    tile.huNetUpdatesLeft + row, tile.huNetUpdatesRight + row, rowMaxEdgeSpeed);
+            tile.maxEdgeSpeedX = std::max(tile.maxEdgeSpeedX, rowMaxEdgeSpeed);
+        }
+        return tile.maxEdgeSpeedX;
+    });
+    m_skippedEdges += countSkippedEdges(true);
+    return maxEdgeSpeed;
+}
+
+void WavePropagation2D::updateUnknownsX(T dt)
+{
+    SWE_INSTRUMENT_PHASE(UPDATE_UNKNOWNS);
+    T dtOverCellSize = dt / m_cellSize;
+    m_scheduler.run([this, dtOverCellSize](unsigned int t) {
+        Tile &tile = m_tiles[t];
+        m_changed[t] = 0;
+        if (!m_active[t])
+            return 0;
+        T maxUpdate = 0;
+        for (unsigned int j = 1; j <= tile.sizeY; j++)
+        {
+            for (unsigned int i = j * STRIDE + 1; i <= j * STRIDE + tile.sizeX; i++)
+            {
+                T hUpdate = dtOverCellSize * (tile.hNetUpdatesRight[i - 1] + tile.hNetUpdatesLeft[i]);
+                T huUpdate = dtOverCellSize * (tile.huNetUpdatesRight[i - 1] + tile.huNetUpdatesLeft[i]);
+                tile.h[i] -= hUpdate;
+                tile.hu[i] -= huUpdate;
+                maxUpdate = std::max(maxUpdate, std::max(std::fabs(hUpdate), std::fabs(huUpdate)));
+            }
+        }
+        m_changed[t] = maxUpdate > m_activityThreshold;
+        return 0;
+    });
+}
+
+T WavePropagation2D::computeYSweep()
+{
+    SWE_INSTRUMENT_PHASE(NUMERICAL_FLUXES);
+    T maxEdgeSpeed = m_scheduler.run([this](unsigned int t) {
+        Tile &tile = m_tiles[t];
+        if (!m_active[t])
+            return tile.maxEdgeSpeedY;
+        tile.maxEdgeSpeedY = 0;
+        // edge j lies between row j and row j + 1, all edges of two rows are solved at once
+        for (unsigned int j = 0; j <= tile.sizeY; j++)
+        {
+            const std::size_t begin = j * STRIDE + 1, end = j * STRIDE + tile.sizeX + 1;
+            T rowMaxEdgeSpeed = 0;
+#pragma omp simd reduction(max:rowMaxEdgeSpeed)
+            for (std::size_t i = begin; i < end; i++)
+            {
+                T speed = solver::kernel::computeEdge(tile.h[i], tile.h[i + STRIDE], tile.hv[i], tile.hv[i + STRIDE], (T) 0, (T) 0,
+                        tile.hNetUpdatesLeft[i], tile.hNetUpdatesRight[i], tile.huNetUpdatesLeft[i], tile.huNetUpdatesRight[i]);
+                rowMaxEdgeSpeed = std::max(rowMaxEdgeSpeed, speed);
+            }
+            SWE_INSTRUMENT_EDGES(tile.h, tile.hv, begin, end, STRIDE);
+            tile.maxEdgeSpeedY = std::max(tile.maxEdgeSpeedY, rowMaxEdgeSpeed);
+        }
+        return tile.maxEdgeSpeedY;
+    });
+    m_skippedEdges += countSkippedEdges(false);
+    return maxEdgeSpeed;
+}
+
+void WavePropagation2D::updateUnknownsY(T dt)
+{
+    SWE_INSTRUMENT_PHASE(UPDATE_UNKNOWNS);
+    T dtOverCellSize = dt / m_cellSize;
+    m_scheduler.run([this, dtOverCellSize](unsigned int t) {
+        Tile &tile = m_tiles[t];
+        if (!m_active[t])
+            return 0;
+        T maxUpdate = 0;
+        for (unsigned int j = 1; j <= tile.sizeY; j++)
+        {
+            for (unsigned int i = j * STRIDE + 1; i <= j * STRIDE + tile.sizeX; i++)
+            {
+                T hUpdate = dtOverCellSize * (tile.hNetUpdatesRight[i - STRIDE] + tile.hNetUpdatesLeft[i]);
+                T hvUpdate = dtOverCellSize * (tile.huNetUpdatesRight[i - STRIDE] + tile.huNetUpdatesLeft[i]);
+                tile.h[i] -= hUpdate;
+                tile.hv[i] -= hvUpdate;
+                maxUpdate = std::max(maxUpdate, std::max(std::fabs(hUpdate), std::fabs(hvUpdate)));
+            }
+        }
+        // the x-update of this step may already have marked the tile
+        m_changed[t] = m_changed[t] || maxUpdate > m_activityThreshold;
+        return 0;
+    });
+}
+
+void WavePropagation2D::updateActiveTiles(bool keepActive)
+{
+    for (unsigned int tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        for (unsigned int tileX = 0; tileX < m_tilesX; tileX++)
+        {
+            unsigned int t = tileY * m_tilesX + tileX;
+            m_active[t] = (keepActive && m_active[t]) || m_changed[t]
+                    || (tileX > 0 && m_changed[t - 1]) || (tileX + 1 < m_tilesX && m_changed[t + 1])
+                    || (tileY > 0 && m_changed[t - m_tilesX]) || (tileY + 1 < m_tilesY && m_changed[t + m_tilesX]);
+            // the f-wave kernel is branch-free, so a dry cell of an active tile costs as much as a wet one.
+            // Dry tiles and tiles at rest are inactive and almost free
+            m_scheduler.setCost(t, m_active[t] ? m_tiles[t].sizeX * m_tiles[t].sizeY : 0);
+        }
+    }
+}
+
+unsigned long WavePropagation2D::countSkippedEdges(bool xSweep) const
+{
+    unsigned long skippedEdges = 0;
+    for (unsigned int t = 0; t < m_tilesX * m_tilesY; t++)
+    {
+        if (!m_active[t])
+            skippedEdges += xSweep ? (m_tiles[t].sizeX + 1) * m_tiles[t].sizeY : m_tiles[t].sizeX * (m_tiles[t].sizeY + 1);
+    }
+    return skippedEdges;
+}
+
+unsigned int WavePropagation2D::getActiveTiles() const
+{
+    return std::count(m_active.begin(), m_active.end(), 1);
+}
+
+T WavePropagation2D::simulateTimeStep()
+{
+    m_skippedEdges = 0;
+    m_scheduler.resetStatistics();
+    setOutflowBoundaryConditions();
+    T maxEdgeSpeed = std::max(computeXSweep(), m_maxEdgeSpeedY);
+    // no wave moves (all cells are dry), an infinite time step would turn the zero net updates into NaNs
+    if (maxEdgeSpeed == 0)
+    {
+        SWE_INSTRUMENT_END_STEP(0);
+        return 0;
+    }
+    T dt = 0.4 * m_cellSize / maxEdgeSpeed;
+    updateUnknownsX(dt);
+    // the y-sweep of a tile next to a tile which just changed is not zero anymore
+    updateActiveTiles(true);
+
+    setOutflowBoundaryConditions();
+    m_maxEdgeSpeedY = computeYSweep();
+    updateUnknownsY(dt);
+    updateActiveTiles(false);
+    SWE_INSTRUMENT_END_STEP(dt);
+    return dt;
+}
+
+const WavePropagation2D::Tile &WavePropagation2D::locate(unsigned int x, unsigned int y, unsigned int &index) const
+{
+    unsigned int tileX = x == 0 ? 0 : std::min((x - 1) / TILE_SIZE, m_tilesX - 1);
+    unsigned int tileY = y == 0 ? 0 : std::min((y - 1) / TILE_SIZE, m_tilesY - 1);
+    index = (y - tileY * TILE_SIZE) * STRIDE + x - tileX * TILE_SIZE;
+    return m_tiles[tileY * m_tilesX + tileX];
+}
+
+T WavePropagation2D::getHeight(unsigned int x, unsigned int y) const
+{
+    unsigned int index;
+    return locate(x, y, index).h[index];
+}
+
+T WavePropagation2D::getMomentumX(unsigned int x, unsigned int y) const
+{
+    unsigned int index;
+    return locate(x, y, index).hu[index];
+}
+
+T WavePropagation2D::getMomentumY(unsigned int x, unsigned int y) const
+{
+    unsigned int index;
+    return locate(x, y, index).hv[index];
+}
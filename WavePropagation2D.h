@@ -0,0 +1,242 @@
+/*
+ * File:   WavePropagation2D.h
+ *
+ * Two dimensional wave propagation using dimensional splitting and the f-wave solver.
+ */
+
+#ifndef _WAVEPROPAGATION2D_H
+#define	_WAVEPROPAGATION2D_H
+
+#include <vector>
+
+#include "types.h"
+#include "TileScheduler.h"
+#include "scenarios/scenario.h"
+#include "solvers/FWave.hpp"
+
+/**
+ * Solves the 2D shallow water equations on a uniform grid by alternating x-sweeps and y-sweeps
+ * of the 1D f-wave solver (dimensional splitting).
+ *
+ * The grid is stored in square tiles of TILE_SIZE x TILE_SIZE cells. Every tile has its own ghost
+ * layer, so both sweeps work on a small block of memory which stays in the cache. The y-sweep
+ * solves the edges between two neighbouring rows of a tile at once, so it never strides through
+ * memory column by column.
+ *
+ * Cells are addressed like in the 1D case: the domain has sizeX x sizeY cells with positions
+ * 1 to sizeX (1 to sizeY), position 0 and sizeX + 1 (sizeY + 1) are the ghost cells.
+ *
+ * Only active tiles are solved. A tile stays active as long as one of its updates exceeds the
+ * activity threshold and activates its four neighbours for the following sweeps. The CFL condition
+ * keeps a wave within one cell per sweep, so it cannot cross an active tile before its neighbours
+ * are solved as well. Quiescent water and dry land (where all edges are dry-dry) drop out after one
+ * step. An inactive tile keeps the maximum edge speeds of its last solve for the time step. With the
+ * default threshold of 0 a tile is only skipped if its updates would be exactly zero, so the results
+ * do not change.
+ *
+ * A threshold above 0 does not conserve the mass. The net updates of the f-wave solver split the
+ * jump of the flux between two cells, so skipping the edges of a tile only cancels out if the fluxes
+ * of its cells are equal, e.g. at rest. Once a tile with small, but nonzero velocities drops out
+ * next to active tiles, the mass changes by the flux differences across its skipped edges, about
+ * 0.1% within a few steps for the radial dam break with a threshold of 0.5.
+ *
+ * Since only the tiles around the fronts are active, a static split of the tiles leaves most threads
+ * idle. The tiles are distributed by a TileScheduler instead, which balances the estimated cost (the
+ * number of cells of the active tiles) and lets idle threads steal the remaining tiles of the others.
+ * Every tile is computed independently and the maximum edge speed is exact, so the results do not
+ * depend on the distribution.
+ */
+class WavePropagation2D
+{
+public:
+
+    /** The number of cells of a tile in each direction */
+    static const unsigned int TILE_SIZE = 64;
+
+    /**
+     * Creates the grid and sets the initial values from a scenario.
+     *
+     * @param [in] scenario The scenario, which is evaluated at the 2D positions of the cells
+     * @param [in] sizeX The number of cells in x direction
+     * @param [in] sizeY The number of cells in y direction
+     */
+    WavePropagation2D(scenarios::Scenario<T> &scenario, unsigned int sizeX, unsigned int sizeY);
+
+    ~WavePropagation2D();
+
+    /**
+     * Fills the ghost layers of all tiles, either with the values of the neighbouring tile or with
+     * the values of the outermost cells at the boundary of the domain (outflow).
+     */
+    void setOutflowBoundaryConditions();
+
+    /**
+     * Computes the net updates of all vertical edges.
+     *
+     * @return The maximum edge speed of all vertical edges
+     */
+    T computeXSweep();
+
+    /**
+     * Applies the net updates of the x-sweep to h and hu.
+     *
+     * @param [in] dt The time step
+     */
+    void updateUnknownsX(T dt);
+
+    /**
+     * Computes the net updates of all horizontal edges.
+     *
+     * @return The maximum edge speed of all horizontal edges
+     */
+    T computeYSweep();
+
+    /**
+     * Applies the net updates of the y-sweep to h and hv.
+     *
+     * @param [in] dt The time step
+     */
+    void updateUnknownsY(T dt);
+
+    /**
+     * Sets the threshold above which the update of a cell (dt / cellSize times its net updates) keeps
+     * its tile active. A negative threshold keeps all tiles active, a threshold above 0 trades the
+     * conservation of the mass for fewer solved tiles.
+     *
+     * @param [in] threshold The activity threshold, 0 by default
+     */
+    void setActivityThreshold(T threshold)
+    {
+        m_activityThreshold = threshold;
+    }
+
+    /** @return The number of edges which were skipped in the last time step */
+    unsigned long getSkippedEdges() const
+    {
+        return m_skippedEdges;
+    }
+
+    /** @return The number of tiles which are solved in the next time step */
+    unsigned int getActiveTiles() const;
+
+    /**
+     * @return The load imbalance of the threads in the last time step: the time of its parallel phases
+     *         divided by the time with perfectly balanced threads, see TileScheduler
+     */
+    double getLoadImbalance() const
+    {
+        return m_scheduler.getLoadImbalance();
+    }
+
+    /** @return The number of tiles which were stolen by idle threads in the last time step */
+    unsigned long getStolenTiles() const
+    {
+        return m_scheduler.getStolenTiles();
+    }
+
+    /**
+     * Runs one complete time step: x-sweep, update, y-sweep, update.
+     *
+     * The time step is computed from the maximum edge speed of the x-sweep and the maximum edge speed
+     * of the y-sweep of the previous time step, since the y-sweep can only be computed after the
+     * x-sweep has been applied.
+     *
+     * @return The time step, 0 if no wave moves (all cells are dry) and the cells stay unchanged
+     */
+    T simulateTimeStep();
+
+    /** @return The water height of the cell at (x, y) */
+    T getHeight(unsigned int x, unsigned int y) const;
+
+    /** @return The momentum in x direction of the cell at (x, y) */
+    T getMomentumX(unsigned int x, unsigned int y) const;
+
+    /** @return The momentum in y direction of the cell at (x, y) */
+    T getMomentumY(unsigned int x, unsigned int y) const;
+
+    unsigned int getSizeX() const
+    {
+        return m_sizeX;
+    }
+
+    unsigned int getSizeY() const
+    {
+        return m_sizeY;
+    }
+
+    T getCellSize() const
+    {
+        return m_cellSize;
+    }
+
+private:
+
+    /** Number of values in one row of a tile including the ghost cells */
+    static const unsigned int STRIDE = TILE_SIZE + 2;
+
+    /**
+     * A block of at most TILE_SIZE x TILE_SIZE cells with a ghost layer of one cell.
+     * All arrays are stored row by row with a row length of STRIDE.
+     */
+    struct Tile
+    {
+        /** Number of cells of this tile in x direction (smaller than TILE_SIZE at the border of the domain) */
+        unsigned int sizeX;
+        /** Number of cells of this tile in y direction */
+        unsigned int sizeY;
+        T *h;
+        T *hu;
+        T *hv;
+        /** Net updates of the current sweep, edge k lies between local cell k and k + 1 */
+        T *hNetUpdatesLeft;
+        T *hNetUpdatesRight;
+        T *huNetUpdatesLeft;
+        T *huNetUpdatesRight;
+        /** Maximum edge speeds of the last x-sweep and y-sweep of this tile */
+        T maxEdgeSpeedX;
+        T maxEdgeSpeedY;
+    };
+
+    /**
+     * Activates every tile which changed in this time step and its neighbours and estimates the
+     * cost of the tiles for the scheduler.
+     *
+     * @param [in] keepActive If true, the tiles which are already active stay active
+     */
+    void updateActiveTiles(bool keepActive);
+
+    /** @return The number of edges of the inactive tiles in x direction (x-sweep) or in y direction */
+    unsigned long countSkippedEdges(bool xSweep) const;
+
+    /** @return The tile containing the cell at position (x, y) and the index of the cell within the tile */
+    const Tile &locate(unsigned int x, unsigned int y, unsigned int &index) const;
+
+    /** Copies the ghost layer of a tile from its neighbours or from its own boundary cells */
+    void fillGhostLayer(unsigned int tileX, unsigned int tileY);
+
+    unsigned int m_sizeX;
+    unsigned int m_sizeY;
+    T m_cellSize;
+
+    unsigned int m_tilesX;
+    unsigned int m_tilesY;
+    Tile *m_tiles;
+    /** The arrays of all tiles, the arrays of a tile are placed on the NUMA node of the thread which solves it */
+    T *m_storage;
+
+    /** Maximum edge speed of the last y-sweep */
+    T m_maxEdgeSpeedY;
+
+    /** One flag per tile: the tile is solved in this time step */
+    std::vector<unsigned char> m_active;
+    /** One flag per tile: an update of the tile exceeded the threshold in this time step */
+    std::vector<unsigned char> m_changed;
+    T m_activityThreshold;
+    unsigned long m_skippedEdges;
+
+    TileScheduler m_scheduler;
+
+    solver::FWave<T> m_solver;
+};
+
+#endif	/* _WAVEPROPAGATION2D_H */
@@ -0,0 +1,176 @@
+/*
+ * File:   WavePropagation2DTest.h
+ *
+ * Tests of the dimensional splitting on the tiled 2D grid.
+ */
+
+#ifndef _WAVEPROPAGATION2DTEST_H
+#define	_WAVEPROPAGATION2DTEST_H
+
+#include "../types.h"
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include <limits>
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/radialdambreak.h"
+#include "../WavePropagation2D.h"
+#include "../solvers/FWave.hpp"
+
+class WavePropagation2DTest : public CxxTest::TestSuite
+{
+public:
+
+    /** \brief tests that a 1D scenario extruded along y evolves like the 1D solution in every row
+     *
+     *  The grid size is not a multiple of the tile size, so the partially filled tiles at the border are covered as well.
+     */
+    void testExtrudedScenario()
+    {
+        const unsigned int sizeX = 100, sizeY = 70;
+        scenarios::ShockShock scenario(sizeX);
+        WavePropagation2D wavePropagation(scenario, sizeX, sizeY);
+
+        T *h = new T[sizeX + 2];
+        T *hu = new T[sizeX + 2];
+        T **updates = new T*[4];
+        for (int i = 0; i < 4; i++)
+            updates[i] = new T[sizeX + 1];
+        for (unsigned int i = 0; i < sizeX + 2; i++)
+        {
+            h[i] = scenario.getHeight(i);
+            hu[i] = scenario.getMomentum(i);
+        }
+
+        solver::FWave<T> fwave;
+        for (int step = 0; step < 50; step++)
+        {
+            T dt = wavePropagation.simulateTimeStep();
+
+            h[0] = h[1];
+            hu[0] = hu[1];
+            h[sizeX + 1] = h[sizeX];
+            hu[sizeX + 1] = hu[sizeX];
+            T maxEdgeSpeed;
+            fwave.computeNetUpdates(h, hu, 0, 0, sizeX + 1, updates[0], updates[1], updates[2], updates[3], maxEdgeSpeed);
+            T dtOverCellSize = dt / scenario.getCellSize();
+            for (unsigned int i = 1; i <= sizeX; i++)
+            {
+                h[i] -= dtOverCellSize * (updates[1][i - 1] + updates[0][i]);
+                hu[i] -= dtOverCellSize * (updates[3][i - 1] + updates[2][i]);
+            }
+        }
+
+        for (unsigned int y = 1; y <= sizeY; y++)
+        {
+            for (unsigned int x = 1; x <= sizeX; x++)
+            {
+                TS_ASSERT_DELTA(wavePropagation.getHeight(x, y), h[x], 0.00001);
+                TS_ASSERT_DELTA(wavePropagation.getMomentumX(x, y), hu[x], 0.00001);
+                TS_ASSERT_DELTA(wavePropagation.getMomentumY(x, y), 0, 0.00001);
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+            delete [] updates[i];
+        delete [] updates;
+        delete [] h;
+        delete [] hu;
+    }
+
+    /** \brief tests that the radial dam break stays symmetric and conserves the mass
+     *
+     */
+    void testRadialDamBreak()
+    {
+        const unsigned int size = 150;
+        scenarios::RadialDamBreak scenario(size);
+        WavePropagation2D wavePropagation(scenario, size, size);
+        T initialMass = computeMass(wavePropagation);
+
+        for (int step = 0; step < 40; step++)
+            wavePropagation.simulateTimeStep();
+
+        // the mass is summed up in T, so the rounding errors grow with the number of cells
+        TS_ASSERT_DELTA(computeMass(wavePropagation) / initialMass, 1, 1000 * std::numeric_limits<T>::epsilon());
+        for (unsigned int y = 1; y <= size; y++)
+        {
+            for (unsigned int x = 1; x < y; x++)
+                TS_ASSERT_DELTA(wavePropagation.getHeight(x, y), wavePropagation.getHeight(y, x), 0.05);
+        }
+    }
+
+    /** \brief tests that skipping the quiescent tiles does not change the results
+     *
+     *  The dam in the middle of the domain only reaches the tiles at the border after some time steps.
+     */
+    void testActiveTiles()
+    {
+        const unsigned int size = 512;
+        scenarios::RadialDamBreak scenario(size);
+        WavePropagation2D tracked(scenario, size, size);
+        WavePropagation2D reference(scenario, size, size);
+        reference.setActivityThreshold(-1);
+
+        const unsigned int tiles = (size / WavePropagation2D::TILE_SIZE) * (size / WavePropagation2D::TILE_SIZE);
+        unsigned long skippedEdges = 0;
+        for (int step = 0; step < 20; step++)
+        {
+            TS_ASSERT_EQUALS(tracked.simulateTimeStep(), reference.simulateTimeStep());
+            TS_ASSERT_EQUALS(reference.getSkippedEdges(), 0);
+            TS_ASSERT_EQUALS(reference.getActiveTiles(), tiles);
+            skippedEdges += tracked.getSkippedEdges();
+        }
+        TS_ASSERT(skippedEdges > 0);
+        TS_ASSERT(tracked.getActiveTiles() < tiles);
+
+        for (unsigned int y = 1; y <= size; y++)
+        {
+            for (unsigned int x = 1; x <= size; x++)
+            {
+                TS_ASSERT_EQUALS(tracked.getHeight(x, y), reference.getHeight(x, y));
+                TS_ASSERT_EQUALS(tracked.getMomentumX(x, y), reference.getMomentumX(x, y));
+                TS_ASSERT_EQUALS(tracked.getMomentumY(x, y), reference.getMomentumY(x, y));
+            }
+        }
+    }
+
+    /** \brief documents the mass error of an activity threshold above zero
+     *
+     *  The front does not reach the border of the domain, so the mass is conserved up to rounding errors until the
+     *  first tile behind the front drops out while its cells still move.
+     */
+    void testActivityThresholdMassError()
+    {
+        const unsigned int size = 512;
+        scenarios::RadialDamBreak scenario(size);
+        WavePropagation2D wavePropagation(scenario, size, size);
+        wavePropagation.setActivityThreshold(0.5);
+        T initialMass = computeMass(wavePropagation);
+
+        for (int step = 0; step < 200; step++)
+            wavePropagation.simulateTimeStep();
+        TS_ASSERT_DELTA(computeMass(wavePropagation) / initialMass, 1, 1000 * std::numeric_limits<T>::epsilon());
+        for (int step = 0; step < 50; step++)
+            wavePropagation.simulateTimeStep();
+        T error = std::fabs(computeMass(wavePropagation) / initialMass - 1);
+        TS_ASSERT(error > 1e-4);
+        TS_ASSERT(error < 1e-2);
+    }
+
+private:
+
+    /** \brief sums up the water heights of all cells */
+    T computeMass(const WavePropagation2D &wavePropagation)
+    {
+        T mass = 0;
+        for (unsigned int y = 1; y <= wavePropagation.getSizeY(); y++)
+        {
+            for (unsigned int x = 1; x <= wavePropagation.getSizeX(); x++)
+                mass += wavePropagation.getHeight(x, y);
+        }
+        return mass;
+    }
+};
+
+#endif	/* _WAVEPROPAGATION2DTEST_H */
@@ -0,0 +1,1128 @@
+/*
+ * File:   Benchmark.cpp
+ *
+ * Micro- and macro-benchmarks of the f-wave solver and the wave propagation.
+ * All results are written as one JSON document to stdout, so they can be compared between builds.
+ *
+ * Usage: benchmark [maxCells] [secondsPerRun] [none|compact|spread]
+ * The last argument is the pinning of the threads in the NUMA placement benchmark, compact by default.
+ */
+
+#include "../types.h"
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/rarerare.h"
+#include "../scenarios/extendeddambreak.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../scenarios/radialdambreak.h"
+#include "../WavePropagation2D.h"
+#include "../LocalTimeStepping.h"
+#include "../AdaptiveWavePropagation.h"
+#include "../Ensemble.h"
+#include "../Numa.h"
+#include "../PolicyWavePropagation.h"
+#include "../ReferenceWavePropagation.h"
+#include "../io/GaugeWriter.h"
+#include "../io/CompressedSnapshotWriter.h"
+#include "../solvers/FWave.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/** Seconds since an arbitrary point in time */
+double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Collects the results and prints them as JSON.
+ */
+class Report
+{
+public:
+    Report() : m_first(true)
+    {
+        std::printf("{\n  \"type\": \"%s\",\n  \"results\": [\n", sizeof(T) == sizeof(float) ? "float" : "double");
+    }
+
+    /**
+     * Adds a throughput.
+     *
+     * @param [in] benchmark The name of the benchmark
+     * @param [in] name The name of the variant
+     * @param [in] cells The problem size
+     * @param [in] seconds The measured wall time
+     * @param [in] items The number of processed edges or cells
+     * @param [in] unit The name of the throughput
+     * @param [in] bytesPerItem The number of bytes moved from and to memory per item according to a model of the
+     * traffic of the loops (not measured), or 0 if there is no model
+     */
+    void add(const std::string &benchmark, const std::string &name, unsigned long cells, double seconds,
+            double items, const std::string &unit, double bytesPerItem = 0)
+    {
+        begin(benchmark, name, cells);
+        std::printf(", \"seconds\": %.6f, \"%s\": %.6e", seconds, unit.c_str(), items / seconds);
+        if (bytesPerItem > 0)
+            std::printf(", \"modelledBytesPerCell\": %.0f, \"modelledBytesPerSecond\": %.6e", bytesPerItem, bytesPerItem * items / seconds);
+        end();
+    }
+
+    /**
+     * Starts a result which is not a throughput, e.g. a speedup, a ratio or an error. Its values are added with
+     * value() and the result is completed with end().
+     *
+     * @param [in] benchmark The name of the benchmark
+     * @param [in] name The name of the variant
+     * @param [in] cells The problem size
+     */
+    Report &begin(const std::string &benchmark, const std::string &name, unsigned long cells)
+    {
+        std::printf("%s    {\"benchmark\": \"%s\", \"name\": \"%s\", \"cells\": %lu",
+                m_first ? "" : ",\n", benchmark.c_str(), name.c_str(), cells);
+        m_first = false;
+        return *this;
+    }
+
+    Report &value(const char *name, double value)
+    {
+        std::printf(", \"%s\": %.6g", name, value);
+        return *this;
+    }
+
+    void end()
+    {
+        std::printf("}");
+        std::fflush(stdout);
+    }
+
+    /** Closes the list of results */
+    void finish()
+    {
+        std::printf("\n  ]\n}\n");
+    }
+
+private:
+    bool m_first;
+};
+
+/** Prevents the compiler from removing the benchmarked computations */
+volatile T sink;
+
+/**
+ * Measures the single edge solver and the batched kernel on a given set of edges.
+ *
+ * @param [in] name The name of the input set
+ * @param [in] h The heights of the water columns
+ * @param [in] hu The momentums of the water columns
+ * @param [in] seconds The minimal duration of each measurement
+ */
+void benchmarkEdges(Report &report, const char *name, const std::vector<T> &h, const std::vector<T> &hu, double seconds)
+{
+    solver::FWave<T> fwave;
+    unsigned int edges = h.size() - 1;
+    std::vector<T> hNetUpdatesLeft(edges), hNetUpdatesRight(edges), huNetUpdatesLeft(edges), huNetUpdatesRight(edges);
+
+    unsigned long iterations = 0;
+    T maxEdgeSpeed = 0;
+    double start = now(), elapsed;
+    do
+    {
+        for (unsigned int i = 0; i < edges; i++)
+        {
+            solver::NetUpdates<T> updates = fwave.computeNetUpdates(h[i], h[i + 1], hu[i], hu[i + 1], 0, 0);
+            maxEdgeSpeed = std::max(maxEdgeSpeed, updates.maxEdgeSpeed);
+        }
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    sink = maxEdgeSpeed;
+    report.add("computeNetUpdates", std::string("single/") + name, edges, elapsed, (double) iterations * edges, "edgesPerSecond");
+
+    iterations = 0;
+    start = now();
+    do
+    {
+        fwave.computeNetUpdates(&h[0], &hu[0], 0, 0, edges, &hNetUpdatesLeft[0], &hNetUpdatesRight[0],
+                &huNetUpdatesLeft[0], &huNetUpdatesRight[0], maxEdgeSpeed);
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    sink = maxEdgeSpeed;
+    report.add("computeNetUpdates", std::string("batch/") + name, edges, elapsed, (double) iterations * edges, "edgesPerSecond");
+}
+
+void benchmarkSolver(Report &report, double seconds)
+{
+    const unsigned int size = 4096;
+    std::vector<T> h(size + 1), hu(size + 1);
+
+    // subsonic: |u| < sqrt(g*h)
+    for (unsigned int i = 0; i <= size; i++)
+    {
+        h[i] = 100 + (i * 37) % 23;
+        hu[i] = (T) ((int) ((i * 53) % 41) - 20) * 10;
+    }
+    benchmarkEdges(report, "subsonic", h, hu, seconds);
+
+    // supersonic: u > sqrt(g*h)
+    for (unsigned int i = 0; i <= size; i++)
+    {
+        h[i] = 1 + (i % 3) * 0.1;
+        hu[i] = 20 + i % 5;
+    }
+    benchmarkEdges(report, "supersonic", h, hu, seconds);
+
+    // every second cell is dry
+    for (unsigned int i = 0; i <= size; i++)
+    {
+        h[i] = i % 2 ? 0 : 10 + i % 7;
+        hu[i] = i % 2 ? 0 : 5;
+    }
+    benchmarkEdges(report, "dry", h, hu, seconds);
+}
+
+/**
+ * Runs full time steps of the wave propagation on a scenario: the two-phase and the fused time step of
+ * PolicyWavePropagation.
+ *
+ * @param [in] name The name of the scenario
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] seconds The minimal duration of the measurement
+ */
+void benchmarkTimeSteps(Report &report, const char *name, scenarios::Scenario<T> &scenario, unsigned long size, double seconds)
+{
+    T *h = new T[size + 2];
+    T *hu = new T[size + 2];
+    const PolicyWavePropagation::Mode modes[2] = {PolicyWavePropagation::TWO_PHASE, PolicyWavePropagation::FUSED};
+    const char *modeNames[2] = {"twoPhase/", "fused/"};
+    for (int mode = 0; mode < 2; mode++)
+    {
+        scenario.fill(h, hu, 0, 0, size + 2);
+        PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(h, hu, 0, size, scenario.getCellSize(),
+                PolicyWavePropagation::OUTFLOW);
+        wavePropagation->setMode(modes[mode]);
+        unsigned long steps = 0;
+        double start = now(), elapsed;
+        do
+        {
+            wavePropagation->simulateTimeStep();
+            steps++;
+            elapsed = now() - start;
+        } while (elapsed < seconds);
+        report.add("timeStep", std::string(modeNames[mode]) + name, size, elapsed, (double) steps * size, "cellUpdatesPerSecond",
+                wavePropagation->getBytesPerCell());
+        delete wavePropagation;
+    }
+    delete [] h;
+    delete [] hu;
+}
+
+/**
+ * Simulates ShelfDamBreak for the time span of about 200 global time steps.
+ *
+ * @param [in] size The number of cells
+ * @param [in] maxLevel The coarsest level of the local time stepping, 0 for global time stepping
+ * @param [out] edgeUpdates The number of computed edges
+ * @param [out] globalEdgeUpdates The number of edges global time stepping would have computed
+ * @return The wall time
+ */
+double simulateShelf(unsigned long size, unsigned int maxLevel, unsigned long &edgeUpdates, unsigned long &globalEdgeUpdates)
+{
+    scenarios::ShelfDamBreak scenario(size);
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    T endTime = 200 * 0.4 * scenario.getCellSize() / std::sqrt(g * h[1]);
+
+    LocalTimeStepping localTimeStepping(&h[0], &hu[0], &b[0], size, scenario.getCellSize(), maxLevel);
+    double start = now();
+    for (T time = 0; time < endTime;)
+    {
+        T dt = localTimeStepping.simulateMacroStep();
+        // nothing moves anymore
+        if (dt == 0)
+            break;
+        time += dt;
+    }
+    double elapsed = now() - start;
+    edgeUpdates = localTimeStepping.getEdgeUpdates();
+    globalEdgeUpdates = localTimeStepping.getGlobalEdgeUpdates();
+    return elapsed;
+}
+
+/**
+ * Compares global and local time stepping on a variable depth.
+ *
+ * @param [in] size The number of cells
+ * @param [in] maxLevel The coarsest level of the local time stepping
+ */
+void benchmarkLocalTimeStepping(Report &report, unsigned long size, unsigned int maxLevel)
+{
+    unsigned long edgeUpdates, globalEdgeUpdates;
+    double globalSeconds = simulateShelf(size, 0, edgeUpdates, globalEdgeUpdates);
+    report.add("localTimeStepping", "global/ShelfDamBreak", size, globalSeconds, (double) edgeUpdates, "edgesPerSecond");
+
+    double localSeconds = simulateShelf(size, maxLevel, edgeUpdates, globalEdgeUpdates);
+    report.add("localTimeStepping", "local/ShelfDamBreak", size, localSeconds, (double) edgeUpdates, "edgesPerSecond");
+    report.begin("localTimeStepping", "speedup/ShelfDamBreak", size).value("maxLevel", maxLevel)
+            .value("speedup", globalSeconds / localSeconds).value("edgeUpdateRatio", (double) globalEdgeUpdates / edgeUpdates).end();
+}
+
+/**
+ * Runs the wave propagation which PolicyWavePropagation::create() chooses with the given precision policy up to a
+ * fixed time. The last time step is shortened, so all precision policies are compared at the same simulated time.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] endTime The simulated time
+ * @param [in] mode The time step of the wave propagation
+ * @param [out] h The heights of the cells at the end time
+ * @param [out] steps The number of time steps
+ * @param [out] bytesPerCell The modelled memory traffic of a time step, see PolicyWavePropagation::getBytesPerCell
+ * @return The wall time
+ */
+template <typename Precision>
+double simulatePolicy(scenarios::Scenario<T> &scenario, unsigned long size, double endTime, PolicyWavePropagation::Mode mode,
+        std::vector<double> &h, unsigned int &steps, double &bytesPerCell)
+{
+    typedef typename Precision::StorageType Storage;
+    std::vector<Storage> hStorage(size + 2), huStorage(size + 2), b(size + 2);
+    scenario.fill(&hStorage[0], &huStorage[0], &b[0], 0, size + 2);
+    PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create<Precision>(&hStorage[0], &huStorage[0], &b[0], size,
+            scenario.getCellSize(), PolicyWavePropagation::OUTFLOW);
+    wavePropagation->setMode(mode);
+
+    steps = 0;
+    double start = now();
+    while (wavePropagation->getTime() < endTime)
+    {
+        wavePropagation->simulateTimeStep(endTime - wavePropagation->getTime());
+        steps++;
+    }
+    double elapsed = now() - start;
+    bytesPerCell = wavePropagation->getBytesPerCell();
+    delete wavePropagation;
+
+    h.assign(hStorage.begin() + 1, hStorage.end() - 1);
+    return elapsed;
+}
+
+/**
+ * Reports the throughput of a precision policy and its deviation from the pure double precision solution.
+ *
+ * @param [in] kind The kind of time step, "fused" or "policy"
+ */
+void reportPrecision(Report &report, const char *kind, const char *name, unsigned long size, unsigned int steps, double seconds,
+        double bytesPerCell, const std::vector<double> &h, const std::vector<double> &hReference)
+{
+    report.add("precision", std::string(kind) + "/" + name, size, seconds, (double) steps * size, "cellUpdatesPerSecond", bytesPerCell);
+
+    double maxError = 0, sumError = 0, sumReference = 0;
+    for (unsigned long i = 0; i < size; i++)
+    {
+        double error = std::fabs(h[i] - hReference[i]);
+        maxError = std::max(maxError, error / hReference[i]);
+        sumError += error;
+        sumReference += hReference[i];
+    }
+    report.begin("precision", std::string("drift/") + kind + "/" + name, size).value("steps", steps)
+            .value("maxRelativeError", maxError).value("l1RelativeError", sumError / sumReference).end();
+}
+
+/**
+ * Compares pure double, pure float and float storage with double arithmetic on the fused and on the two-phase time
+ * step of a full run (see PolicyWavePropagation). The drift is measured on the heights at a fixed simulated time
+ * against the pure double solution of the same time step.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ */
+void benchmarkPrecision(Report &report, scenarios::Scenario<T> &scenario, unsigned long size)
+{
+    // about 100 time steps
+    const double endTime = 100 * 0.4 * scenario.getCellSize() / std::sqrt(g * scenario.getHeight(1));
+    const PolicyWavePropagation::Mode modes[2] = {PolicyWavePropagation::FUSED, PolicyWavePropagation::TWO_PHASE};
+    const char *kinds[2] = {"fused", "policy"};
+    for (int mode = 0; mode < 2; mode++)
+    {
+        std::vector<double> hReference, h;
+        unsigned int steps;
+        double bytesPerCell;
+        double seconds = simulatePolicy<solver::Precision<double> >(scenario, size, endTime, modes[mode], hReference, steps, bytesPerCell);
+        reportPrecision(report, kinds[mode], "double", size, steps, seconds, bytesPerCell, hReference, hReference);
+        seconds = simulatePolicy<solver::Precision<float> >(scenario, size, endTime, modes[mode], h, steps, bytesPerCell);
+        reportPrecision(report, kinds[mode], "float", size, steps, seconds, bytesPerCell, h, hReference);
+        seconds = simulatePolicy<solver::Precision<float, double> >(scenario, size, endTime, modes[mode], h, steps, bytesPerCell);
+        reportPrecision(report, kinds[mode], "float+double", size, steps, seconds, bytesPerCell, h, hReference);
+    }
+}
+
+/**
+ * Compares the initialization with the per cell getters against the bulk fill of the scenario.
+ * Every repetition allocates new arrays, so the fill also includes the first touch of the pages.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] seconds The minimal duration of each measurement
+ */
+void benchmarkInitialization(Report &report, const char *name, scenarios::Scenario<T> &scenario, unsigned long size, double seconds)
+{
+    unsigned long repetitions = 0;
+    double start = now(), elapsed;
+    do
+    {
+        T *h = new T[size + 2];
+        T *hu = new T[size + 2];
+        for (unsigned long i = 0; i < size + 2; i++)
+        {
+            h[i] = scenario.getHeight(i);
+            hu[i] = scenario.getMomentum(i);
+        }
+        sink = h[size / 2] + hu[size / 2];
+        delete [] h;
+        delete [] hu;
+        repetitions++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    report.add("initialization", std::string("getters/") + name, size, elapsed, (double) repetitions * (size + 2), "cellsPerSecond", 2 * sizeof(T));
+
+    repetitions = 0;
+    start = now();
+    do
+    {
+        T *h = new T[size + 2];
+        T *hu = new T[size + 2];
+        scenario.fill(h, hu, 0, 0, size + 2);
+        sink = h[size / 2] + hu[size / 2];
+        delete [] h;
+        delete [] hu;
+        repetitions++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    report.add("initialization", std::string("fill/") + name, size, elapsed, (double) repetitions * (size + 2), "cellsPerSecond", 2 * sizeof(T));
+}
+
+/**
+ * Compares a parameter sweep run member by member with the interleaved ensemble runner.
+ * Both run the two-phase scheme with the own CFL time step of every member.
+ *
+ * @param [in] members The number of members, ShockShock with heights between 10 and 10 + members
+ * @param [in] size The number of cells of every member
+ * @param [in] steps The number of time steps of every member
+ */
+void benchmarkEnsemble(Report &report, unsigned int members, unsigned long size, unsigned int steps)
+{
+    std::vector<scenarios::ShockShock> sweep;
+    std::vector<scenarios::Scenario<T> *> scenarios(members);
+    sweep.reserve(members);
+    for (unsigned int m = 0; m < members; m++)
+    {
+        sweep.push_back(scenarios::ShockShock(size, 10 + m, 3));
+        scenarios[m] = &sweep[m];
+    }
+    const double cellUpdates = (double) members * steps * size;
+
+    double start = now();
+    {
+        solver::FWave<T> fwave;
+        std::vector<T> h(size + 2), hu(size + 2);
+        std::vector<T> hNetUpdatesLeft(size + 1), hNetUpdatesRight(size + 1), huNetUpdatesLeft(size + 1), huNetUpdatesRight(size + 1);
+        for (unsigned int m = 0; m < members; m++)
+        {
+            scenarios[m]->fill(&h[0], &hu[0], 0, 0, size + 2);
+            T cellSize = scenarios[m]->getCellSize();
+            for (unsigned int step = 0; step < steps; step++)
+            {
+                h[0] = h[1];
+                hu[0] = hu[1];
+                h[size + 1] = h[size];
+                hu[size + 1] = hu[size];
+                T maxEdgeSpeed;
+                fwave.computeNetUpdatesParallel(&h[0], &hu[0], 0, 0, size + 1, &hNetUpdatesLeft[0], &hNetUpdatesRight[0],
+                        &huNetUpdatesLeft[0], &huNetUpdatesRight[0], maxEdgeSpeed);
+                T dt = 0.4 * cellSize / maxEdgeSpeed;
+                T dtOverCellSize = dt / cellSize;
+#pragma omp parallel for schedule(static)
+                for (long i = 1; i <= (long) size; i++)
+                {
+                    h[i] -= dtOverCellSize * (hNetUpdatesRight[i - 1] + hNetUpdatesLeft[i]);
+                    hu[i] -= dtOverCellSize * (huNetUpdatesRight[i - 1] + huNetUpdatesLeft[i]);
+                }
+            }
+            sink = h[size / 2];
+        }
+    }
+    double sequentialSeconds = now() - start;
+    report.add("ensemble", "sequential/ShockShock", size, sequentialSeconds, cellUpdates, "cellUpdatesPerSecond", 18 * sizeof(T));
+
+    start = now();
+    {
+        Ensemble ensemble(&scenarios[0], members, size);
+        for (unsigned int step = 0; step < steps; step++)
+            ensemble.simulateTimeStep();
+        sink = ensemble.getHeight(0, size / 2);
+    }
+    double ensembleSeconds = now() - start;
+    report.add("ensemble", "interleaved/ShockShock", size, ensembleSeconds, cellUpdates, "cellUpdatesPerSecond", 18 * sizeof(T));
+    report.begin("ensemble", "speedup/ShockShock", size).value("members", members)
+            .value("speedup", sequentialSeconds / ensembleSeconds).end();
+}
+
+/**
+ * Runs time steps of one wave propagation until the time is up.
+ *
+ * @return The number of time steps per second
+ */
+double measureTimeSteps(PolicyWavePropagation &wavePropagation, double seconds, unsigned long &steps, double &elapsed)
+{
+    steps = 0;
+    double start = now();
+    do
+    {
+        wavePropagation.simulateTimeStep();
+        steps++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    return steps / elapsed;
+}
+
+/**
+ * Measures one specialization on a copy of the initial state and reports its speedup over the generic path.
+ */
+template <typename Bathymetry, typename Wetting, typename BoundaryConditions>
+void benchmarkSpecialization(Report &report, const char *name, std::vector<T> h, std::vector<T> hu, const std::vector<T> &b,
+        unsigned long size, T cellSize, double seconds, double genericStepsPerSecond)
+{
+    SpecializedWavePropagation<Bathymetry, Wetting, BoundaryConditions> wavePropagation(&h[0], &hu[0], &b[0], size, cellSize);
+    unsigned long steps;
+    double elapsed;
+    double stepsPerSecond = measureTimeSteps(wavePropagation, seconds, steps, elapsed);
+    std::string variant = wavePropagation.getName() + "/" + name;
+    report.add("policies", variant, size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    report.begin("policies", "speedup/" + variant, size).value("speedup", stepsPerSecond / genericStepsPerSecond).end();
+}
+
+/**
+ * Compares the specialized wave propagations with the generic path, which takes the flat bathymetry,
+ * the wet-dry handling and the boundary conditions into account at runtime. Every specialization which is
+ * valid for the wet scenario is measured, the flat ones only if the bathymetry is flat.
+ *
+ * @param [in] name The name of the scenario
+ * @param [in] scenario A scenario without dry cells
+ * @param [in] size The number of cells
+ * @param [in] seconds The minimal duration of each measurement
+ */
+void benchmarkPolicies(Report &report, const char *name, scenarios::Scenario<T> &scenario, unsigned long size, double seconds)
+{
+    std::vector<T> h0(size + 2), hu0(size + 2), b(size + 2);
+    scenario.fill(&h0[0], &hu0[0], &b[0], 0, size + 2);
+    T cellSize = scenario.getCellSize();
+    bool flat = std::count(b.begin(), b.end(), b[0]) == (long) b.size();
+
+    std::vector<T> h = h0, hu = hu0;
+    std::vector<T> hNetUpdatesLeft(size + 1), hNetUpdatesRight(size + 1), huNetUpdatesLeft(size + 1), huNetUpdatesRight(size + 1);
+    solver::FWave<T> fwave;
+    const T *bathymetry = flat ? 0 : &b[0];
+    volatile bool reflecting = false;
+    unsigned long steps = 0;
+    double start = now(), elapsed;
+    do
+    {
+        T sign = reflecting ? -1 : 1;
+        h[0] = h[1];
+        hu[0] = sign * hu[1];
+        h[size + 1] = h[size];
+        hu[size + 1] = sign * hu[size];
+        T maxEdgeSpeed;
+        fwave.computeNetUpdates(&h[0], &hu[0], bathymetry, 0, size + 1, &hNetUpdatesLeft[0], &hNetUpdatesRight[0],
+                &huNetUpdatesLeft[0], &huNetUpdatesRight[0], maxEdgeSpeed);
+        T dt = 0.4 * cellSize / maxEdgeSpeed;
+        T dtOverCellSize = dt / cellSize;
+        for (unsigned long i = 1; i <= size; i++)
+        {
+            h[i] -= dtOverCellSize * (hNetUpdatesRight[i - 1] + hNetUpdatesLeft[i]);
+            hu[i] -= dtOverCellSize * (huNetUpdatesRight[i - 1] + huNetUpdatesLeft[i]);
+        }
+        steps++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    report.add("policies", std::string("generic/") + name, size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    double genericStepsPerSecond = steps / elapsed;
+
+    if (flat)
+    {
+        benchmarkSpecialization<solver::FlatBathymetry, solver::WetOnly, OutflowBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+        benchmarkSpecialization<solver::FlatBathymetry, solver::WetOnly, ReflectingBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+        benchmarkSpecialization<solver::FlatBathymetry, solver::WetDry, OutflowBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+        benchmarkSpecialization<solver::FlatBathymetry, solver::WetDry, ReflectingBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+    }
+    benchmarkSpecialization<solver::VariableBathymetry, solver::WetOnly, OutflowBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+    benchmarkSpecialization<solver::VariableBathymetry, solver::WetOnly, ReflectingBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+    benchmarkSpecialization<solver::VariableBathymetry, solver::WetDry, OutflowBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+    benchmarkSpecialization<solver::VariableBathymetry, solver::WetDry, ReflectingBoundary>(report, name, h0, hu0, b, size, cellSize, seconds, genericStepsPerSecond);
+}
+
+/**
+ * One time step with outflow boundaries, either with the f-wave solver or with the hybrid solver.
+ *
+ * @param [in,out] statistics The statistics of the hybrid solver or NULL for the f-wave solver
+ * @param [in] maxTimeStep The time step is clipped to this value
+ * @return The time step
+ */
+T simulateHybridTimeStep(const solver::FWave<T> &fwave, std::vector<T> &h, std::vector<T> &hu, const T *b, unsigned long size, T cellSize,
+        std::vector<T> *netUpdates, solver::HybridStatistics *statistics, double maxTimeStep)
+{
+    h[0] = h[1];
+    hu[0] = hu[1];
+    h[size + 1] = h[size];
+    hu[size + 1] = hu[size];
+    T maxEdgeSpeed;
+    if (statistics)
+        fwave.computeNetUpdatesHybrid(&h[0], &hu[0], b, 0, size + 1, &netUpdates[0][0], &netUpdates[1][0], &netUpdates[2][0], &netUpdates[3][0],
+                maxEdgeSpeed, *statistics);
+    else
+        fwave.computeNetUpdates(&h[0], &hu[0], b, 0, size + 1, &netUpdates[0][0], &netUpdates[1][0], &netUpdates[2][0], &netUpdates[3][0],
+                maxEdgeSpeed);
+    T dt = std::min<double>(0.4 * cellSize / maxEdgeSpeed, maxTimeStep);
+    T dtOverCellSize = dt / cellSize;
+    for (unsigned long i = 1; i <= size; i++)
+    {
+        h[i] -= dtOverCellSize * (netUpdates[1][i - 1] + netUpdates[0][i]);
+        hu[i] -= dtOverCellSize * (netUpdates[3][i - 1] + netUpdates[2][i]);
+    }
+    return dt;
+}
+
+/**
+ * Compares the hybrid solver with the f-wave solver on a scenario. The f-wave solver runs a fixed number of
+ * time steps, the hybrid solver runs until the same simulated time. Reports the throughput of both, the
+ * fractions of the edges per solver and the difference of the heights: the maximum and the L1 norm relative
+ * to the L1 norm of the change of the heights computed by the f-wave solver.
+ *
+ * @param [in] name The name of the scenario
+ * @param [in] steps The number of time steps of the f-wave solver
+ */
+void benchmarkHybrid(Report &report, const char *name, scenarios::Scenario<T> &scenario, unsigned long size, unsigned int steps)
+{
+    std::vector<T> h0(size + 2), hu0(size + 2), b(size + 2);
+    scenario.fill(&h0[0], &hu0[0], &b[0], 0, size + 2);
+    const T *bathymetry = std::count(b.begin(), b.end(), b[0]) == (long) b.size() ? 0 : &b[0];
+    T cellSize = scenario.getCellSize();
+    std::vector<T> netUpdates[4];
+    for (int i = 0; i < 4; i++)
+        netUpdates[i].resize(size + 1);
+    solver::FWave<T> fwave;
+
+    std::vector<T> h = h0, hu = hu0;
+    double endTime = 0;
+    double start = now();
+    for (unsigned int step = 0; step < steps; step++)
+        endTime += simulateHybridTimeStep(fwave, h, hu, bathymetry, size, cellSize, netUpdates, 0, std::numeric_limits<double>::max());
+    double seconds = now() - start;
+    report.add("hybrid", std::string("fwave/") + name, size, seconds, (double) steps * size, "cellUpdatesPerSecond");
+
+    std::vector<T> hHybrid = h0, huHybrid = hu0;
+    solver::HybridStatistics statistics;
+    unsigned long hybridSteps = 0;
+    double time = 0;
+    start = now();
+    for (; time < endTime && hybridSteps < 2ul * steps; hybridSteps++)
+        time += simulateHybridTimeStep(fwave, hHybrid, huHybrid, bathymetry, size, cellSize, netUpdates, &statistics, endTime - time);
+    double hybridSeconds = now() - start;
+    report.add("hybrid", std::string("hybrid/") + name, size, hybridSeconds, (double) hybridSteps * size, "cellUpdatesPerSecond");
+
+    double maxError = 0, error = 0, change = 0;
+    for (unsigned long i = 1; i <= size; i++)
+    {
+        maxError = std::max(maxError, (double) std::fabs(hHybrid[i] - h[i]));
+        error += std::fabs(hHybrid[i] - h[i]);
+        change += std::fabs(h[i] - h0[i]);
+    }
+    double edges = statistics.linearizedEdges + statistics.wetEdges + statistics.wetDryEdges;
+    report.begin("hybrid", std::string("accuracy/") + name, size).value("linearized", statistics.linearizedEdges / edges)
+            .value("wet", statistics.wetEdges / edges).value("wetDry", statistics.wetDryEdges / edges)
+            .value("speedup", (hybridSteps / hybridSeconds) / (steps / seconds)).value("maxError", maxError)
+            .value("relativeL1Error", change > 0 ? error / change : 0).end();
+}
+
+/**
+ * Measures the overhead of sampling tide gauges after every time step, once with the gauges and once without them.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] numberOfGauges The number of gauges, spread evenly over the domain
+ * @param [in] seconds The minimal duration of each measurement
+ */
+void benchmarkGauges(Report &report, scenarios::Scenario<T> &scenario, unsigned long size, unsigned int numberOfGauges, double seconds)
+{
+    const char *fileName = "benchmark_gauges.swe";
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    T cellSize = scenario.getCellSize();
+    std::vector<double> positions(numberOfGauges);
+    for (unsigned int gauge = 0; gauge < numberOfGauges; gauge++)
+        positions[gauge] = (gauge + 0.5) * size * cellSize / numberOfGauges;
+
+    PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, PolicyWavePropagation::OUTFLOW);
+    unsigned long steps;
+    double elapsed;
+    double stepsPerSecond = measureTimeSteps(*wavePropagation, seconds, steps, elapsed);
+    report.add("gauges", "without", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    double gaugeStepsPerSecond;
+    {
+        io::GaugeWriter gauges(fileName, positions, size, cellSize);
+        wavePropagation->setGauges(&gauges);
+        gaugeStepsPerSecond = measureTimeSteps(*wavePropagation, seconds, steps, elapsed);
+        wavePropagation->setGauges(0);
+    }
+    report.add("gauges", "with", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    report.begin("gauges", "overhead", size).value("gauges", numberOfGauges).value("overhead", stepsPerSecond / gaugeStepsPerSecond - 1)
+            .end();
+    delete wavePropagation;
+    std::remove(fileName);
+}
+
+/**
+ * The diagnostics of PolicyWavePropagation in a separate pass over the unknowns, as they would be computed without
+ * the fused update. Only used as the baseline of the diagnostics benchmark.
+ */
+double computeDiagnostics(const std::vector<T> &h, const std::vector<T> &hu, const std::vector<T> &b, unsigned long size, T cellSize)
+{
+    double mass = 0, momentum = 0, energy = 0;
+    T maxSurface = -std::numeric_limits<T>::max(), maxVelocity = 0;
+    for (unsigned long i = 1; i <= size; i++)
+    {
+        T u = h[i] > 0 ? hu[i] / h[i] : 0;
+        mass += h[i];
+        momentum += hu[i];
+        energy += 0.5 * hu[i] * u + 0.5 * g * h[i] * h[i] + g * h[i] * b[i];
+        if (h[i] > 0)
+            maxSurface = std::max(maxSurface, h[i] + b[i]);
+        maxVelocity = std::max(maxVelocity, std::abs(u));
+    }
+    return (mass + momentum + energy + maxSurface + maxVelocity) * cellSize;
+}
+
+/**
+ * Compares time steps without diagnostics, with the diagnostics of the update sweep and with a separate pass.
+ */
+void benchmarkDiagnostics(Report &report, scenarios::Scenario<T> &scenario, unsigned long size, double seconds)
+{
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    T cellSize = scenario.getCellSize();
+    PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, PolicyWavePropagation::REFLECTING);
+
+    unsigned long steps;
+    double elapsed;
+    double stepsPerSecond = measureTimeSteps(*wavePropagation, seconds, steps, elapsed);
+    report.add("diagnostics", "without", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+
+    wavePropagation->setDiagnostics(true);
+    double fusedStepsPerSecond = measureTimeSteps(*wavePropagation, seconds, steps, elapsed);
+    report.add("diagnostics", "fused", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    wavePropagation->setDiagnostics(false);
+
+    // keeps the compiler from dropping the separate pass
+    volatile double sink = 0;
+    double start = now();
+    steps = 0;
+    do
+    {
+        wavePropagation->simulateTimeStep();
+        sink += computeDiagnostics(h, hu, b, size, cellSize);
+        steps++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    double separateStepsPerSecond = steps / elapsed;
+    report.add("diagnostics", "separate", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+    report.begin("diagnostics", "overhead", size).value("fused", stepsPerSecond / fusedStepsPerSecond - 1)
+            .value("separate", stepsPerSecond / separateStepsPerSecond - 1).end();
+    delete wavePropagation;
+}
+
+/**
+ * Writes a snapshot every 10 steps in the lossless and the lossy mode and reports the compression ratio,
+ * the throughput of one encoding thread and the slowdown of the time steps.
+ */
+void benchmarkCompression(Report &report, scenarios::Scenario<T> &scenario, unsigned long size, double seconds)
+{
+    const char *fileName = "benchmark_compression.swe";
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    T cellSize = scenario.getCellSize();
+    PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size, cellSize, PolicyWavePropagation::OUTFLOW);
+
+    unsigned long steps;
+    double elapsed;
+    double stepsPerSecond = measureTimeSteps(*wavePropagation, seconds, steps, elapsed);
+    report.add("compression", "without", size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+
+    const char *names[] = {"lossless", "lossy"};
+    for (unsigned int mode = 0; mode < 2; mode++)
+    {
+        io::SnapshotCompression compression;
+        compression.lossy = mode == 1;
+        compression.heightTolerance = 1e-3;
+        compression.momentumTolerance = 1e-3;
+        io::CompressedSnapshotWriter writer(fileName, size, cellSize, compression, 10);
+        steps = 0;
+        double start = now();
+        do
+        {
+            wavePropagation->simulateTimeStep();
+            steps++;
+            writer.write(&h[1], &hu[1], steps, wavePropagation->getTime());
+            elapsed = now() - start;
+        } while (elapsed < seconds);
+        writer.close();
+        report.add("compression", names[mode], size, elapsed, (double) steps * size, "cellUpdatesPerSecond");
+        report.begin("compression", std::string(names[mode]) + "/ratio", size).value("snapshots", writer.getNumberOfSnapshots())
+                .value("ratio", writer.getCompressionRatio()).value("bytesPerSecond", writer.getThroughput())
+                .value("overhead", stepsPerSecond / (steps / elapsed) - 1).end();
+    }
+    delete wavePropagation;
+    std::remove(fileName);
+}
+
+/**
+ * Simulates a scenario on a uniform grid until the end time with the net updates of the two phase scheme.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] endTime The simulated time, the last time step is shortened to reach it
+ * @param [out] h The heights of the cells after the last step
+ * @param [out] edgeUpdates The number of computed edges
+ * @return The wall time
+ */
+double simulateUniform(scenarios::Scenario<T> &scenario, unsigned long size, double endTime, std::vector<T> &h, unsigned long &edgeUpdates)
+{
+    ReferenceWavePropagation reference(scenario, size);
+    double start = now();
+    edgeUpdates = reference.simulateUntil(endTime) * (size + 1);
+    double seconds = now() - start;
+    h = reference.getHeights();
+    return seconds;
+}
+
+/**
+ * Compares the adaptive grid with the uniform grids of its coarsest and its finest level at the same simulated time.
+ * The errors are the L1 errors of h relative to the uniform grid of the finest level.
+ *
+ * @param [in] name The name of the scenario
+ * @param [in] coarseScenario The scenario with size cells
+ * @param [in] fineScenario The same scenario with size * 2^maxLevel cells
+ * @param [in] size The number of cells of the coarsest level
+ * @param [in] maxLevel The finest level
+ * @param [in] steps The number of macro steps of the adaptive grid
+ */
+void benchmarkAdaptive(Report &report, const char *name, scenarios::Scenario<T> &coarseScenario, scenarios::Scenario<T> &fineScenario,
+        unsigned long size, unsigned int maxLevel, unsigned int steps)
+{
+    const unsigned long fineSize = size << maxLevel;
+    double start = now();
+    AdaptiveWavePropagation adaptive(coarseScenario, 16, maxLevel);
+    double time = 0, cells = 0;
+    for (unsigned int step = 0; step < steps; step++)
+    {
+        time += adaptive.simulateMacroStep();
+        cells += adaptive.getNumberOfCells();
+    }
+    double adaptiveSeconds = now() - start;
+    report.add("adaptive", std::string("adaptive/") + name, size, adaptiveSeconds, (double) adaptive.getEdgeUpdates(), "edgesPerSecond");
+
+    std::vector<T> hFine, hCoarse, h(fineSize), hu(fineSize);
+    unsigned long fineEdgeUpdates, coarseEdgeUpdates;
+    double fineSeconds = simulateUniform(fineScenario, fineSize, time, hFine, fineEdgeUpdates);
+    report.add("adaptive", std::string("uniformFine/") + name, fineSize, fineSeconds, (double) fineEdgeUpdates, "edgesPerSecond");
+    simulateUniform(coarseScenario, size, time, hCoarse, coarseEdgeUpdates);
+
+    adaptive.sample(fineSize, &h[0], &hu[0]);
+    double adaptiveError = 0, coarseError = 0, norm = 0;
+    for (unsigned long i = 0; i < fineSize; i++)
+    {
+        adaptiveError += std::fabs(h[i] - hFine[i + 1]);
+        coarseError += std::fabs(hCoarse[1 + (i >> maxLevel)] - hFine[i + 1]);
+        norm += std::fabs(hFine[i + 1]);
+    }
+    report.begin("adaptive", std::string("accuracy/") + name, size).value("maxLevel", maxLevel).value("averageCells", cells / steps)
+            .value("uniformCells", fineSize).value("edgeUpdateRatio", (double) fineEdgeUpdates / adaptive.getEdgeUpdates())
+            .value("speedup", fineSeconds / adaptiveSeconds).value("adaptiveL1Error", adaptiveError / norm)
+            .value("coarseL1Error", coarseError / norm).end();
+}
+
+/**
+ * Runs threaded two phase time steps, the edges and the cells are distributed over the threads in
+ * the chunks of Scenario::fill.
+ *
+ * @param [in,out] h The heights including the ghost cells
+ * @param [in,out] hu The momentums including the ghost cells
+ * @param [in] netUpdates The four net update arrays
+ * @param [in] size The number of cells
+ * @param [in] cellSize The size of a cell
+ * @param [in] seconds The minimal duration
+ * @param [out] steps The number of time steps
+ * @return The wall time
+ */
+double simulateThreaded(T *h, T *hu, T *netUpdates[4], unsigned long size, T cellSize, double seconds, unsigned long &steps)
+{
+    const unsigned long chunkSize = scenarios::Scenario<T>::CELLS_PER_CHUNK;
+    const long numberOfChunks = (size + chunkSize - 1) / chunkSize;
+    solver::FWave<T> fwave;
+    steps = 0;
+    double start = now(), elapsed;
+    do
+    {
+        h[0] = h[1];
+        hu[0] = hu[1];
+        h[size + 1] = h[size];
+        hu[size + 1] = hu[size];
+        T maxEdgeSpeed;
+        fwave.computeNetUpdatesParallel(h, hu, 0, 0, size + 1, netUpdates[0], netUpdates[1], netUpdates[2], netUpdates[3], maxEdgeSpeed);
+        T dtOverCellSize = 0.4 / maxEdgeSpeed;
+#pragma omp parallel for schedule(static)
+        for (long chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned long end = std::min((chunk + 1) * chunkSize, size);
+            for (unsigned long i = chunk * chunkSize + 1; i <= end; i++)
+            {
+                h[i] -= dtOverCellSize * (netUpdates[1][i - 1] + netUpdates[0][i]);
+                hu[i] -= dtOverCellSize * (netUpdates[3][i - 1] + netUpdates[2][i]);
+            }
+        }
+        steps++;
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+    sink = h[size / 2] + cellSize;
+    return elapsed;
+}
+
+/**
+ * Compares the placement of a driver which allocates and fills the unknowns with a single thread
+ * against NUMA-aware placement: untouched huge page fields, pinned threads and a first touch with
+ * the chunks of the edge sweep. The local fraction is the share of the pages of h which lies on the
+ * node of the thread computing on them.
+ *
+ * @param [in] scenario The scenario
+ * @param [in] size The number of cells
+ * @param [in] seconds The minimal duration of each measurement
+ * @param [in] pinning The pinning of the threads in the NUMA-aware placement
+ */
+void benchmarkPlacement(Report &report, scenarios::Scenario<T> &scenario, unsigned long size, double seconds, numa::Pinning pinning)
+{
+    unsigned long steps;
+    T cellSize = scenario.getCellSize();
+    T *netUpdates[4];
+
+    // every page is first touched by the main thread
+    double defaultSeconds, defaultLocalFraction;
+    {
+        std::vector<T> h(size + 2), hu(size + 2);
+        for (unsigned long i = 0; i < size + 2; i++)
+        {
+            h[i] = scenario.getHeight(i);
+            hu[i] = scenario.getMomentum(i);
+        }
+        std::vector<T> updates[4];
+        for (int i = 0; i < 4; i++)
+        {
+            updates[i].resize(size + 1);
+            netUpdates[i] = &updates[i][0];
+        }
+        numa::pinThreads(pinning);
+        defaultSeconds = simulateThreaded(&h[0], &hu[0], netUpdates, size, cellSize, seconds, steps);
+        defaultLocalFraction = numa::getLocalFraction(&h[0], size + 2);
+        report.add("placement", "default/ExtendedDamBreak", size, defaultSeconds, (double) steps * size, "cellUpdatesPerSecond",
+                18 * sizeof(T));
+    }
+    double defaultRate = steps / defaultSeconds;
+
+    T *h = numa::allocateField(size + 2);
+    T *hu = numa::allocateField(size + 2);
+    scenario.fill(h, hu, 0, 0, size + 2);
+    for (int i = 0; i < 4; i++)
+    {
+        netUpdates[i] = numa::allocateField(size + 1);
+        numa::firstTouch(netUpdates[i], size + 1);
+    }
+    double numaSeconds = simulateThreaded(h, hu, netUpdates, size, cellSize, seconds, steps);
+    double numaLocalFraction = numa::getLocalFraction(h, size + 2);
+    report.add("placement", "numa/ExtendedDamBreak", size, numaSeconds, (double) steps * size, "cellUpdatesPerSecond", 18 * sizeof(T));
+    numa::freeField(h);
+    numa::freeField(hu);
+    for (int i = 0; i < 4; i++)
+        numa::freeField(netUpdates[i]);
+    numa::pinThreads(numa::PIN_NONE);
+
+    report.begin("placement", "speedup/ExtendedDamBreak", size).value("nodes", numa::getNumberOfNodes())
+            .value("defaultLocalFraction", defaultLocalFraction).value("numaLocalFraction", numaLocalFraction)
+            .value("speedup", (steps / numaSeconds) / defaultRate).end();
+}
+
+/**
+ * Measures the 2D wave propagation on a radial dam break, whose front only covers a part of the tiles,
+ * and reports how well the tile scheduler balances the threads.
+ *
+ * @param [in] size The number of cells in each direction
+ * @param [in] steps The number of time steps
+ */
+void benchmarkTileScheduler(Report &report, unsigned int size, unsigned int steps)
+{
+    scenarios::RadialDamBreak scenario(size);
+    WavePropagation2D wavePropagation(scenario, size, size);
+    double loadImbalance = 0, activeTiles = 0;
+    unsigned long stolenTiles = 0;
+    double start = now();
+    for (unsigned int step = 0; step < steps; step++)
+    {
+        activeTiles += wavePropagation.getActiveTiles();
+        wavePropagation.simulateTimeStep();
+        loadImbalance += wavePropagation.getLoadImbalance();
+        stolenTiles += wavePropagation.getStolenTiles();
+    }
+    double seconds = now() - start;
+    report.add("tileScheduler", "twoDimensional/RadialDamBreak", (unsigned long) size * size, seconds, (double) steps * size * size,
+            "cellUpdatesPerSecond");
+    unsigned int tiles = (size + WavePropagation2D::TILE_SIZE - 1) / WavePropagation2D::TILE_SIZE;
+    report.begin("tileScheduler", "balance/RadialDamBreak", (unsigned long) size * size)
+            .value("activeTileFraction", activeTiles / steps / (tiles * tiles)).value("loadImbalance", loadImbalance / steps)
+            .value("stolenTilesPerStep", (double) stolenTiles / steps).end();
+}
+
+/**
+ * Measures the 1D wave propagation on a shelf dam break whose right half is dry land, whose skipped chunks of edges
+ * the tile scheduler balances, and reports the same load imbalance as benchmarkTileScheduler().
+ *
+ * @param [in] size The number of cells
+ * @param [in] steps The number of time steps
+ */
+void benchmarkChunkScheduler(Report &report, unsigned long size, unsigned int steps)
+{
+    scenarios::ShelfDamBreak scenario(size);
+    std::vector<T> h(size + 2), hu(size + 2), b(size + 2);
+    scenario.fill(&h[0], &hu[0], &b[0], 0, size + 2);
+    std::fill(h.begin() + size / 2, h.end(), (T) 0);
+    std::fill(hu.begin() + size / 2, hu.end(), (T) 0);
+    PolicyWavePropagation *wavePropagation = PolicyWavePropagation::create(&h[0], &hu[0], &b[0], size,
+            scenario.getCellSize(), PolicyWavePropagation::OUTFLOW);
+    double loadImbalance = 0;
+    unsigned long stolenChunks = 0;
+    double start = now();
+    for (unsigned int step = 0; step < steps; step++)
+    {
+        wavePropagation->simulateTimeStep();
+        loadImbalance += wavePropagation->getLoadImbalance();
+        stolenChunks += wavePropagation->getStolenChunks();
+    }
+    double seconds = now() - start;
+    report.add("tileScheduler", "oneDimensional/ShelfDamBreak", size, seconds, (double) steps * size, "cellUpdatesPerSecond");
+    report.begin("tileScheduler", "balance/ShelfDamBreak", size).value("loadImbalance", loadImbalance / steps)
+            .value("stolenChunksPerStep", (double) stolenChunks / steps).end();
+    delete wavePropagation;
+}
+
+/**
+ * Measures the time steps from domains which fit into the caches up to memory-bound domains.
+ *
+ * @param [in] maxCells The largest number of cells
+ * @param [in] seconds The minimal duration of each measurement
+ */
+void benchmarkWavePropagation(Report &report, unsigned long maxCells, double seconds)
+{
+    for (unsigned long size = 1000; size <= maxCells; size *= 10)
+    {
+        scenarios::ShockShock shockShock(size);
+        benchmarkTimeSteps(report, "ShockShock", shockShock, size, seconds);
+        scenarios::RareRare rareRare(size);
+        benchmarkTimeSteps(report, "RareRare", rareRare, size, seconds);
+        scenarios::ExtendedDamBreak extendedDamBreak(size);
+        benchmarkTimeSteps(report, "ExtendedDamBreak", extendedDamBreak, size, seconds);
+    }
+}
+
+/**
+ * Runs the benchmarks of the features of the 1D wave propagation. Each one uses a single size which suits what it
+ * measures, limited by maxCells.
+ *
+ * @param [in] maxCells The largest number of cells
+ * @param [in] seconds The minimal duration of each measurement
+ * @param [in] pinning The pinning of the threads of the placement benchmark
+ */
+void benchmarkFeatures(Report &report, unsigned long maxCells, double seconds, numa::Pinning pinning)
+{
+    // the first touch and the placement only matter once the fields are much larger than the caches
+    const unsigned long memorySize = std::min(maxCells, 10000000ul);
+    scenarios::ExtendedDamBreak memoryDamBreak(memorySize);
+    benchmarkInitialization(report, "ExtendedDamBreak", memoryDamBreak, memorySize, seconds);
+    benchmarkPlacement(report, memoryDamBreak, memorySize, seconds, pinning);
+
+    // the overheads are relative to the time step of a domain which does not fit into the caches
+    const unsigned long overheadSize = std::min(maxCells, 1000000ul);
+    scenarios::ShockShock overheadShockShock(overheadSize);
+    benchmarkPolicies(report, "ShockShock", overheadShockShock, overheadSize, seconds);
+    scenarios::ShelfDamBreak overheadShelf(overheadSize);
+    benchmarkPolicies(report, "ShelfDamBreak", overheadShelf, overheadSize, seconds);
+    benchmarkGauges(report, overheadShelf, overheadSize, 500, seconds);
+    benchmarkDiagnostics(report, overheadShelf, overheadSize, seconds);
+    benchmarkCompression(report, overheadShelf, overheadSize, seconds);
+
+    // the runs over a fixed number of time steps compare the results, their duration grows with the size
+    const unsigned long accuracySize = std::min(maxCells, 100000ul);
+    benchmarkLocalTimeStepping(report, accuracySize, 4);
+    scenarios::ShockShock shockShock(accuracySize);
+    scenarios::RareRare rareRare(accuracySize);
+    scenarios::ExtendedDamBreak extendedDamBreak(accuracySize);
+    scenarios::ShelfDamBreak shelfDamBreak(accuracySize);
+    benchmarkPrecision(report, extendedDamBreak, accuracySize);
+    benchmarkHybrid(report, "ShockShock", shockShock, accuracySize, 100);
+    benchmarkHybrid(report, "RareRare", rareRare, accuracySize, 100);
+    benchmarkHybrid(report, "ExtendedDamBreak", extendedDamBreak, accuracySize, 100);
+    benchmarkHybrid(report, "ShelfDamBreak", shelfDamBreak, accuracySize, 100);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long maxCells = argc > 1 ? std::strtoul(argv[1], 0, 10) : 100000000ul;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 1.0;
+    numa::Pinning pinning = numa::PIN_COMPACT;
+    if (argc > 3 && !numa::parsePinning(argv[3], pinning))
+    {
+        std::cerr << "Unknown pinning " << argv[3] << ", use none, compact or spread" << std::endl;
+        return 1;
+    }
+
+    Report report;
+    benchmarkSolver(report, seconds);
+    benchmarkWavePropagation(report, maxCells, seconds);
+    benchmarkFeatures(report, maxCells, seconds, pinning);
+    // ensembles are meant for sweeps over many small domains
+    for (unsigned long size = 100; size <= std::min(maxCells, 1000ul); size *= 10)
+        benchmarkEnsemble(report, 64, size, 200);
+    for (unsigned int size = 1024; (unsigned long) size * size <= maxCells && size <= 4096; size *= 2)
+        benchmarkTileScheduler(report, size, 50);
+    for (unsigned long size = 100000; size <= std::min(maxCells, 10000000ul); size *= 10)
+        benchmarkChunkScheduler(report, size, 50);
+    // the uniform reference of the adaptive grid has 16 times more cells
+    for (unsigned long size = 1024; size <= std::min(maxCells, 10240ul); size *= 10)
+    {
+        scenarios::ShockShock shockShock(size), fineShockShock(size << 4);
+        benchmarkAdaptive(report, "ShockShock", shockShock, fineShockShock, size, 4, 100);
+        scenarios::ExtendedDamBreak extendedDamBreak(size), fineExtendedDamBreak(size << 4);
+        benchmarkAdaptive(report, "ExtendedDamBreak", extendedDamBreak, fineExtendedDamBreak, size, 4, 100);
+    }
+    report.finish();
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * File:   ScalingBenchmark.cpp
+ *
+ * Strong and weak scaling of the distributed wave propagation.
+ * Rank 0 writes the results as one JSON document to stdout.
+ *
+ * Usage: mpirun -np N scaling [strongCells] [weakCellsPerRank] [timeSteps]
+ */
+
+#include <mpi.h>
+
+#include "../types.h"
+#include "../scenarios/scenario.h"
+#include "../scenarios/shockshock.h"
+#include "../scenarios/shelfdambreak.h"
+#include "../DistributedWavePropagation.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+
+/**
+ * Runs a number of time steps on a scenario distributed over all ranks.
+ *
+ * @param [in] name The name of the run (strong or weak)
+ * @param [in] scenario The scenario, e.g. ShelfDamBreak to include the bathymetry in the checksum
+ * @param [in] size The number of cells of the global domain
+ * @param [in] timeSteps The number of time steps
+ * @param [in] first True if this is the first result which is printed
+ * @return False if the domain could not be distributed, nothing is printed then
+ */
+bool run(const char *name, scenarios::Scenario<T> &scenario, unsigned long size, unsigned int timeSteps, bool first)
+{
+    int rank, numberOfRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numberOfRanks);
+
+    DistributedWavePropagation wavePropagation(scenario, size);
+    if (!wavePropagation.isValid())
+        return false;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (unsigned int step = 0; step < timeSteps; step++)
+        wavePropagation.simulateTimeStep();
+    MPI_Barrier(MPI_COMM_WORLD);
+    double seconds = MPI_Wtime() - start;
+
+    // the checksums have to be the same for any number of ranks, the mass is conserved by any bathymetry,
+    // the first moment of the heights depends on where the waves are
+    double localChecksums[2] = {0, 0}, checksums[2];
+    for (unsigned int i = 1; i <= wavePropagation.getLocalSize(); i++)
+    {
+        localChecksums[0] += wavePropagation.getHeight()[i];
+        localChecksums[1] += (double) (wavePropagation.getOffset() + i - 1) / size * wavePropagation.getHeight()[i];
+    }
+    MPI_Reduce(localChecksums, checksums, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        std::printf("%s    {\"benchmark\": \"%s\", \"scenario\": \"%s\", \"ranks\": %d, \"cells\": %lu, \"timeSteps\": %u, "
+                "\"seconds\": %.6f, \"cellUpdatesPerSecond\": %.6e, \"mass\": %.10e, \"moment\": %.10e}", first ? "" : ",\n", name,
+                scenario.getName(), numberOfRanks, size, timeSteps, seconds, (double) size * timeSteps / seconds,
+                checksums[0], checksums[1]);
+        std::fflush(stdout);
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, numberOfRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numberOfRanks);
+
+    unsigned long strongCells = argc > 1 ? std::strtoul(argv[1], 0, 10) : 10000000ul;
+    unsigned long weakCellsPerRank = argc > 2 ? std::strtoul(argv[2], 0, 10) : 1000000ul;
+    unsigned int timeSteps = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    if (rank == 0)
+        std::printf("{\n  \"type\": \"%s\",\n  \"results\": [\n", sizeof(T) == sizeof(float) ? "float" : "double");
+    scenarios::ShockShock strong(strongCells);
+    bool printed = run("strong", strong, strongCells, timeSteps, true);
+    scenarios::ShockShock weak(weakCellsPerRank * numberOfRanks);
+    printed = run("weak", weak, weakCellsPerRank * numberOfRanks, timeSteps, !printed) || printed;
+    // the continental shelf checks that the bathymetry is distributed with the cells
+    scenarios::ShelfDamBreak shelf(strongCells);
+    run("strong", shelf, strongCells, timeSteps, !printed);
+    if (rank == 0)
+        std::printf("\n  ]\n}\n");
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Runs the strong and weak scaling benchmark on 1 to 16 local ranks.
+# Build it first with "scons mpi=1 scaling".
+#
+# Usage: benchmarks/scaling.sh [strongCells] [weakCellsPerRank] [timeSteps]
+
+for ranks in 1 2 4 8 16
+do
+    OMP_NUM_THREADS=1 mpirun --oversubscribe -np $ranks build/scaling "$@"
+done
@@ -0,0 +1,162 @@
+/*
+ * File:   Checkpoint.cpp
+ *
+ * Checkpoint/restart of a running simulation.
+ */
+
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    /** Writes the whole buffer, retrying on partial writes */
+    bool writeAll(int file, const void *data, std::size_t length) {
+        const char *buffer = static_cast<const char*> (data);
+        while (length > 0) {
+            ssize_t written = ::write(file, buffer, length);
+            if (written <= 0)
+                return false;
+            buffer += written;
+            length -= written;
+        }
+        return true;
+    }
+
+}
+
+io::CheckpointWriter::CheckpointWriter(const std::string &fileName, unsigned long stepInterval, double wallClockInterval)
+    : m_fileName(fileName), m_stepInterval(stepInterval), m_wallClockInterval(wallClockInterval),
+      m_lastCheckpoint(std::chrono::steady_clock::now())
+{
+}
+
+bool io::CheckpointWriter::checkpoint(const SimulationState &state, const scenarios::Scenario<T> &scenario) {
+    bool stepReached = m_stepInterval > 0 && state.step % m_stepInterval == 0;
+    bool wallClockReached = m_wallClockInterval > 0
+            && std::chrono::duration<double>(std::chrono::steady_clock::now() - m_lastCheckpoint).count() >= m_wallClockInterval;
+    if (!stepReached && !wallClockReached)
+        return false;
+    return write(state, scenario);
+}
+
+bool io::CheckpointWriter::write(const SimulationState &state, const scenarios::Scenario<T> &scenario) {
+    std::vector<char> header(CHECKPOINT_ALIGNMENT, 0);
+    CheckpointHeader *checkpointHeader = reinterpret_cast<CheckpointHeader*> (&header[0]);
+    std::memcpy(checkpointHeader->magic, "SWECKPT", 8);
+    checkpointHeader->version = CHECKPOINT_VERSION;
+    checkpointHeader->bytesPerValue = sizeof(T);
+    checkpointHeader->cellCount = state.cellCount;
+    checkpointHeader->numberOfFields = state.b ? 3 : 2;
+    checkpointHeader->cellSize = state.cellSize;
+    checkpointHeader->time = state.time;
+    checkpointHeader->step = state.step;
+    checkpointHeader->maxEdgeSpeed = state.maxEdgeSpeed;
+    checkpointHeader->scenarioSize = scenario.getSize();
+    std::strncpy(checkpointHeader->scenarioName, scenario.getName(), CHECKPOINT_SCENARIO_NAME_LENGTH - 1);
+    checkpointHeader->numberOfScenarioParameters = scenario.getParameters(checkpointHeader->scenarioParameters);
+
+    std::string temporaryFileName = m_fileName + ".tmp";
+    int file = open(temporaryFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        std::cerr << "Could not create checkpoint file " << temporaryFileName << std::endl;
+        return false;
+    }
+
+    bool success = writeAll(file, &header[0], header.size());
+    const T *fields[3] = {state.h, state.hu, state.b};
+    std::vector<char> padding(CHECKPOINT_ALIGNMENT, 0);
+    for (unsigned int field = 0; success && field < checkpointHeader->numberOfFields; field++) {
+        std::size_t fieldLength = state.cellCount * sizeof(T);
+        std::size_t paddedLength = checkpointFieldOffset(state.cellCount, sizeof(T), field + 1) - checkpointFieldOffset(state.cellCount, sizeof(T), field);
+        success = writeAll(file, fields[field], fieldLength) && writeAll(file, &padding[0], paddedLength - fieldLength);
+    }
+    // the data has to be on the disk before the rename makes it visible
+    success = success && fsync(file) == 0;
+    success = close(file) == 0 && success;
+    success = success && std::rename(temporaryFileName.c_str(), m_fileName.c_str()) == 0;
+    if (!success) {
+        std::cerr << "Could not write checkpoint file " << m_fileName << std::endl;
+        std::remove(temporaryFileName.c_str());
+        return false;
+    }
+    m_lastCheckpoint = std::chrono::steady_clock::now();
+    return true;
+}
+
+io::CheckpointReader::CheckpointReader(const std::string &fileName)
+    : m_mapping(MAP_FAILED), m_length(0), m_header(0)
+{
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Could not open checkpoint file " << fileName << std::endl;
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) CHECKPOINT_ALIGNMENT) {
+        m_length = status.st_size;
+        m_mapping = mmap(0, m_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (m_mapping == MAP_FAILED) {
+        std::cerr << "Could not map checkpoint file " << fileName << std::endl;
+        return;
+    }
+
+    const CheckpointHeader *header = static_cast<const CheckpointHeader*> (m_mapping);
+    if (std::memcmp(header->magic, "SWECKPT", 8) != 0 || header->version != CHECKPOINT_VERSION
+            || header->bytesPerValue != sizeof(T)
+            || header->numberOfScenarioParameters > CHECKPOINT_SCENARIO_PARAMETERS
+            || header->scenarioName[CHECKPOINT_SCENARIO_NAME_LENGTH - 1] != 0
+            || checkpointFieldOffset(header->cellCount, sizeof(T), header->numberOfFields) > m_length) {
+        std::cerr << "Invalid checkpoint file " << fileName << std::endl;
+        return;
+    }
+    m_header = header;
+}
+
+io::CheckpointReader::~CheckpointReader() {
+    if (m_mapping != MAP_FAILED)
+        munmap(m_mapping, m_length);
+}
+
+io::SimulationState io::CheckpointReader::getState() const {
+    char *begin = static_cast<char*> (m_mapping);
+    SimulationState state;
+    state.h = reinterpret_cast<T*> (begin + checkpointFieldOffset(m_header->cellCount, sizeof(T), 0));
+    state.hu = reinterpret_cast<T*> (begin + checkpointFieldOffset(m_header->cellCount, sizeof(T), 1));
+    state.b = m_header->numberOfFields == 3 ? reinterpret_cast<T*> (begin + checkpointFieldOffset(m_header->cellCount, sizeof(T), 2)) : 0;
+    state.cellCount = m_header->cellCount;
+    state.cellSize = m_header->cellSize;
+    state.time = m_header->time;
+    state.step = m_header->step;
+    state.maxEdgeSpeed = m_header->maxEdgeSpeed;
+    return state;
+}
+
+unsigned int io::CheckpointReader::getScenarioParameters(double parameters[CHECKPOINT_SCENARIO_PARAMETERS]) const {
+    for (unsigned int i = 0; i < m_header->numberOfScenarioParameters; i++)
+        parameters[i] = m_header->scenarioParameters[i];
+    return m_header->numberOfScenarioParameters;
+}
+
+bool io::CheckpointReader::matchesScenario(const scenarios::Scenario<T> &scenario) const {
+    double parameters[CHECKPOINT_SCENARIO_PARAMETERS];
+    unsigned int numberOfParameters = scenario.getParameters(parameters);
+    if (getScenarioName() != scenario.getName() || m_header->scenarioSize != scenario.getSize()
+            || numberOfParameters != m_header->numberOfScenarioParameters)
+        return false;
+    for (unsigned int i = 0; i < numberOfParameters; i++) {
+        if (parameters[i] != m_header->scenarioParameters[i])
+            return false;
+    }
+    return true;
+}
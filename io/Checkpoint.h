@@ -0,0 +1,141 @@
+/*
+ * File:   Checkpoint.h
+ *
+ * Checkpoint/restart of a running simulation.
+ */
+
+#ifndef _CHECKPOINT_H
+#define	_CHECKPOINT_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "../types.h"
+#include "../scenarios/scenario.h"
+#include "CheckpointFormat.h"
+
+namespace io {
+
+    /**
+     * The complete state of a simulation which is needed to continue it bit for bit.
+     * The arrays belong to the caller (e.g. the arrays passed to WavePropagation), see
+     * PolicyWavePropagation::restore() to continue a wave propagation.
+     */
+    struct SimulationState {
+        /** The heights including the ghost cells */
+        T *h;
+        /** The momentums including the ghost cells */
+        T *hu;
+        /** The bathymetry including the ghost cells or NULL */
+        T *b;
+        /** The number of values in each array */
+        unsigned long cellCount;
+        T cellSize;
+        double time;
+        unsigned long step;
+        /** Maximum edge speed of the last step, only needed by the fused sweep */
+        T maxEdgeSpeed;
+    };
+
+    /**
+     * Writes checkpoints at a configurable step or wall-clock interval.
+     *
+     * Every checkpoint is first written to a temporary file which is renamed to the final name once it
+     * is complete and synced to the disk, so the file always contains either the old or the new
+     * checkpoint, even if the process is killed while writing.
+     */
+    class CheckpointWriter {
+    public:
+
+        /**
+         * @param [in] fileName The name of the checkpoint file
+         * @param [in] stepInterval A checkpoint is written every stepInterval steps, 0 disables this criterion
+         * @param [in] wallClockInterval A checkpoint is written every wallClockInterval seconds of wall-clock time, 0 disables this criterion
+         */
+        CheckpointWriter(const std::string &fileName, unsigned long stepInterval, double wallClockInterval = 0);
+
+        /**
+         * Writes a checkpoint if the step or the wall-clock interval is reached.
+         *
+         * @param [in] state The state of the simulation
+         * @param [in] scenario The scenario of the simulation
+         * @return True if a checkpoint was written
+         */
+        bool checkpoint(const SimulationState &state, const scenarios::Scenario<T> &scenario);
+
+        /**
+         * Writes a checkpoint unconditionally.
+         *
+         * @param [in] state The state of the simulation
+         * @param [in] scenario The scenario of the simulation
+         * @return False if the checkpoint could not be written, the previous checkpoint is still intact in that case
+         */
+        bool write(const SimulationState &state, const scenarios::Scenario<T> &scenario);
+
+    private:
+
+        std::string m_fileName;
+        unsigned long m_stepInterval;
+        double m_wallClockInterval;
+        std::chrono::steady_clock::time_point m_lastCheckpoint;
+    };
+
+    /**
+     * Maps a checkpoint file to restart a simulation.
+     *
+     * The file is mapped privately and writable, so the fields can be used directly as the arrays of the
+     * restarted simulation: the pages are read on first access and modifications never reach the file.
+     * Restarting therefore does not read the whole file up front.
+     */
+    class CheckpointReader {
+    public:
+
+        CheckpointReader(const std::string &fileName);
+
+        ~CheckpointReader();
+
+        /** @return False if the file could not be mapped or is no checkpoint of type T */
+        bool isValid() const {
+            return m_header != 0;
+        }
+
+        /**
+         * @return The state of the checkpoint, the arrays point into the mapping and stay valid as long as the reader exists
+         */
+        SimulationState getState() const;
+
+        /** @return The number of cells of the scenario */
+        unsigned long getScenarioSize() const {
+            return m_header->scenarioSize;
+        }
+
+        /** @return The name of the scenario */
+        std::string getScenarioName() const {
+            return m_header->scenarioName;
+        }
+
+        /**
+         * @param [out] parameters The parameters of the scenario, see Scenario::getParameters()
+         * @return The number of parameters
+         */
+        unsigned int getScenarioParameters(double parameters[CHECKPOINT_SCENARIO_PARAMETERS]) const;
+
+        /**
+         * Checks whether a simulation can be restarted from this checkpoint with a scenario.
+         *
+         * @param [in] scenario The scenario of the restarted simulation
+         * @return True if the name, the size and all parameters of the scenario match the checkpoint
+         */
+        bool matchesScenario(const scenarios::Scenario<T> &scenario) const;
+
+    private:
+
+        void *m_mapping;
+        std::size_t m_length;
+        const CheckpointHeader *m_header;
+    };
+
+}
+
+#endif	/* _CHECKPOINT_H */
@@ -0,0 +1,65 @@
+/*
+ * File:   CheckpointFormat.h
+ *
+ * Layout of the binary checkpoint files.
+ */
+
+#ifndef _CHECKPOINTFORMAT_H
+#define	_CHECKPOINTFORMAT_H
+
+#include <stdint.h>
+
+namespace io {
+
+    /**
+     * A checkpoint file consists of one CheckpointHeader followed by the fields h, hu (and b) with
+     * cellCount values each. Every field starts at a multiple of CHECKPOINT_ALIGNMENT bytes, so the
+     * fields of a memory-mapped checkpoint can be used directly as the arrays of the simulation.
+     */
+    const unsigned int CHECKPOINT_ALIGNMENT = 4096;
+
+    /** Version of the file format, incremented on incompatible changes */
+    const uint32_t CHECKPOINT_VERSION = 2;
+
+    /** The maximum length of the name of the scenario including the terminating zero */
+    const unsigned int CHECKPOINT_SCENARIO_NAME_LENGTH = 32;
+
+    /** The maximum number of parameters of the scenario */
+    const unsigned int CHECKPOINT_SCENARIO_PARAMETERS = 8;
+
+    struct CheckpointHeader {
+        /** "SWECKPT" */
+        char magic[8];
+        uint32_t version;
+        /** sizeof(T) of the stored values */
+        uint32_t bytesPerValue;
+        /** Number of values per field, including ghost cells */
+        uint64_t cellCount;
+        /** 2 (h, hu) or 3 (h, hu, b) */
+        uint32_t numberOfFields;
+        uint32_t reserved;
+        double cellSize;
+        double time;
+        uint64_t step;
+        /** Maximum edge speed of the last step, needed to continue the fused sweep */
+        double maxEdgeSpeed;
+        /** Number of cells of the scenario */
+        uint64_t scenarioSize;
+        /** Name of the scenario, zero terminated */
+        char scenarioName[CHECKPOINT_SCENARIO_NAME_LENGTH];
+        /** Number of valid values in scenarioParameters */
+        uint32_t numberOfScenarioParameters;
+        uint32_t reserved2;
+        /** The parameters of the scenario, see Scenario::getParameters() */
+        double scenarioParameters[CHECKPOINT_SCENARIO_PARAMETERS];
+    };
+
+    /** @return The offset of a field from the beginning of the file */
+    inline uint64_t checkpointFieldOffset(uint64_t cellCount, uint32_t bytesPerValue, unsigned int field) {
+        uint64_t fieldSize = (cellCount * bytesPerValue + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+        return CHECKPOINT_ALIGNMENT + field * fieldSize;
+    }
+
+}
+
+#endif	/* _CHECKPOINTFORMAT_H */
@@ -0,0 +1,91 @@
+/*
+ * File:   CompressedSnapshotFormat.h
+ *
+ * Layout of the compressed snapshot files.
+ */
+
+#ifndef _COMPRESSEDSNAPSHOTFORMAT_H
+#define	_COMPRESSEDSNAPSHOTFORMAT_H
+
+#include <stdint.h>
+
+#include "SnapshotFormat.h"
+
+namespace io {
+
+    /**
+     * A compressed snapshot file is append-only and consists of
+     * <ul>
+     *  <li>one CompressedSnapshotFileHeader,</li>
+     *  <li>one chunk per snapshot: a CompressedChunkHeader, the encoded size of every block as uint32_t and
+     *      the encoded blocks (all blocks of h, then all blocks of hu), padded to a multiple of
+     *      COMPRESSED_CHUNK_ALIGNMENT bytes,</li>
+     *  <li>the index: one SnapshotIndexEntry per chunk,</li>
+     *  <li>one SnapshotFileFooter at the very end of the file.</li>
+     * </ul>
+     * Only the cells firstCell, firstCell + cellStride, ... before endCell are stored. Each field is split into
+     * blocks of blockSize cells which are encoded independently (see SnapshotCodec.h). Keyframes can be decoded
+     * on their own, all other snapshots are stored as the difference to the previous snapshot.
+     * Values are stored in the native byte order.
+     */
+    const uint32_t COMPRESSED_SNAPSHOT_VERSION = 1;
+
+    /** Keeps the chunk headers, the index and the footer aligned */
+    const unsigned int COMPRESSED_CHUNK_ALIGNMENT = 8;
+
+    /** Stores the exact bit patterns of the values */
+    const uint32_t COMPRESSION_LOSSLESS = 0;
+    /** Stores the values quantized to the tolerance of the field */
+    const uint32_t COMPRESSION_LOSSY = 1;
+
+    struct CompressedSnapshotFileHeader {
+        /** "SWECSNP" */
+        char magic[8];
+        uint32_t version;
+        /** sizeof(T) of the stored values */
+        uint32_t bytesPerValue;
+        /** COMPRESSION_LOSSLESS or COMPRESSION_LOSSY */
+        uint32_t mode;
+        /** The number of cells per block */
+        uint32_t blockSize;
+        /** The number of cells of the simulation */
+        uint64_t originalCellCount;
+        /** The number of stored cells per snapshot and field */
+        uint64_t cellCount;
+        uint64_t firstCell;
+        uint64_t cellStride;
+        double cellSize;
+        /** The maximum error of h and hu in the lossy mode */
+        double heightTolerance;
+        double momentumTolerance;
+        /** Every keyframeInterval-th snapshot is a keyframe */
+        uint32_t keyframeInterval;
+        char padding[SNAPSHOT_ALIGNMENT * 2 - 84];
+    };
+
+    struct CompressedChunkHeader {
+        /** "CCHUNK" */
+        char magic[8];
+        uint64_t step;
+        double time;
+        /** 1 if the snapshot does not depend on the previous one */
+        uint32_t keyframe;
+        uint32_t numberOfBlocks;
+        /** The number of bytes of the block sizes and the encoded blocks without the padding */
+        uint64_t payloadSize;
+    };
+
+    /** @return The number of bytes of a chunk including the header and the padding */
+    inline uint64_t compressedChunkSize(uint64_t payloadSize) {
+        uint64_t size = sizeof(CompressedChunkHeader) + payloadSize;
+        return (size + COMPRESSED_CHUNK_ALIGNMENT - 1) / COMPRESSED_CHUNK_ALIGNMENT * COMPRESSED_CHUNK_ALIGNMENT;
+    }
+
+    /** @return The number of stored cells of a selection */
+    inline uint64_t compressedCellCount(uint64_t firstCell, uint64_t endCell, uint64_t cellStride) {
+        return endCell > firstCell ? (endCell - firstCell + cellStride - 1) / cellStride : 0;
+    }
+
+}
+
+#endif	/* _COMPRESSEDSNAPSHOTFORMAT_H */
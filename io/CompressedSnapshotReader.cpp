@@ -0,0 +1,128 @@
+/*
+ * File:   CompressedSnapshotReader.cpp
+ *
+ * Decoding of the snapshots of a finished compressed snapshot file.
+ */
+
+#include "CompressedSnapshotReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+io::CompressedSnapshotReader::CompressedSnapshotReader(const std::string &fileName)
+    : m_mapping(MAP_FAILED), m_length(0), m_header(0), m_index(0), m_footer(0), m_codec(false), m_decoded(0)
+{
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Could not open snapshot file " << fileName << std::endl;
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) (sizeof(CompressedSnapshotFileHeader) + sizeof(SnapshotFileFooter))) {
+        m_length = status.st_size;
+        m_mapping = mmap(0, m_length, PROT_READ, MAP_SHARED, file, 0);
+    }
+    ::close(file);
+    if (m_mapping == MAP_FAILED) {
+        std::cerr << "Could not map snapshot file " << fileName << std::endl;
+        return;
+    }
+
+    const char *begin = static_cast<const char*> (m_mapping);
+    const CompressedSnapshotFileHeader *header = reinterpret_cast<const CompressedSnapshotFileHeader*> (begin);
+    const SnapshotFileFooter *footer = reinterpret_cast<const SnapshotFileFooter*> (begin + m_length - sizeof(SnapshotFileFooter));
+    // a file without footer was not closed properly
+    if (std::memcmp(header->magic, "SWECSNP", 8) != 0 || header->version != COMPRESSED_SNAPSHOT_VERSION
+            || header->bytesPerValue != sizeof(T) || header->mode > COMPRESSION_LOSSY || header->blockSize == 0
+            || std::memcmp(footer->magic, "SWEINDX", 8) != 0
+            || footer->indexOffset + footer->numberOfSnapshots * sizeof(SnapshotIndexEntry) + sizeof(SnapshotFileFooter) != m_length) {
+        std::cerr << "Invalid snapshot file " << fileName << std::endl;
+        return;
+    }
+    m_header = header;
+    m_footer = footer;
+    m_index = reinterpret_cast<const SnapshotIndexEntry*> (begin + footer->indexOffset);
+    m_codec = SnapshotCodec(isLossy());
+    m_reference.resize(2 * header->cellCount);
+    m_values.resize(2 * header->cellCount);
+    m_decoded = footer->numberOfSnapshots;
+}
+
+io::CompressedSnapshotReader::~CompressedSnapshotReader() {
+    if (m_mapping != MAP_FAILED)
+        munmap(m_mapping, m_length);
+}
+
+bool io::CompressedSnapshotReader::read(unsigned long snapshot, T *h, T *hu) {
+    if (snapshot >= getNumberOfSnapshots())
+        return false;
+    if (snapshot != m_decoded) {
+        // go back to the last keyframe unless the snapshot follows the decoded one
+        unsigned long first = snapshot - snapshot % m_header->keyframeInterval;
+        if (m_decoded < snapshot && m_decoded >= first)
+            first = m_decoded + 1;
+        for (unsigned long i = first; i <= snapshot; i++)
+            if (!decode(i)) {
+                m_decoded = getNumberOfSnapshots();
+                return false;
+            }
+    }
+    std::copy(m_values.begin(), m_values.begin() + getNumberOfCells(), h);
+    std::copy(m_values.begin() + getNumberOfCells(), m_values.end(), hu);
+    return true;
+}
+
+bool io::CompressedSnapshotReader::decode(unsigned long snapshot) {
+    const unsigned char *chunk = static_cast<const unsigned char*> (m_mapping) + m_index[snapshot].offset;
+    const CompressedChunkHeader *header = reinterpret_cast<const CompressedChunkHeader*> (chunk);
+    const unsigned long cellCount = getNumberOfCells();
+    const unsigned int numberOfBlocks = (cellCount + m_header->blockSize - 1) / m_header->blockSize;
+    if (m_index[snapshot].offset + sizeof(CompressedChunkHeader) > m_footer->indexOffset
+            || std::memcmp(header->magic, "CCHUNK", 7) != 0 || header->numberOfBlocks != numberOfBlocks
+            || m_index[snapshot].offset + sizeof(CompressedChunkHeader) + header->payloadSize > m_footer->indexOffset
+            || header->payloadSize < 2 * numberOfBlocks * sizeof(uint32_t))
+        return false;
+    // a snapshot which is not a keyframe needs the snapshot before it
+    if (!header->keyframe && m_decoded + 1 != snapshot)
+        return false;
+
+    const unsigned char *sizes = chunk + sizeof(CompressedChunkHeader);
+    const unsigned char *block = sizes + 2 * numberOfBlocks * sizeof(uint32_t);
+    const unsigned char *end = chunk + sizeof(CompressedChunkHeader) + header->payloadSize;
+    for (unsigned int i = 0; i < 2 * numberOfBlocks; i++) {
+        uint32_t size;
+        std::memcpy(&size, sizes + i * sizeof(uint32_t), sizeof(uint32_t));
+        if (size > (std::size_t) (end - block))
+            return false;
+        unsigned int field = i / numberOfBlocks;
+        unsigned long begin = (unsigned long) (i % numberOfBlocks) * m_header->blockSize;
+        unsigned long count = std::min<unsigned long>(m_header->blockSize, cellCount - begin);
+        unsigned long offset = field * cellCount + begin;
+        if (!m_codec.decode(block, size, count, field == 0 ? m_header->heightTolerance : m_header->momentumTolerance,
+                header->keyframe, &m_reference[offset], &m_values[offset]))
+            return false;
+        block += size;
+    }
+    m_decoded = snapshot;
+    return true;
+}
+
+unsigned long io::CompressedSnapshotReader::findSnapshot(double time) const {
+    // the snapshots are sorted by time, find the last one with a time <= the given time
+    unsigned long first = 0, count = getNumberOfSnapshots();
+    while (count > 0) {
+        unsigned long step = count / 2;
+        if (m_index[first + step].time <= time) {
+            first += step + 1;
+            count -= step + 1;
+        } else
+            count = step;
+    }
+    return first > 0 ? first - 1 : 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * File:   CompressedSnapshotReader.h
+ *
+ * Decoding of the snapshots of a finished compressed snapshot file.
+ */
+
+#ifndef _COMPRESSEDSNAPSHOTREADER_H
+#define	_COMPRESSEDSNAPSHOTREADER_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../types.h"
+#include "CompressedSnapshotFormat.h"
+#include "SnapshotCodec.h"
+
+namespace io {
+
+    /**
+     * Memory-maps a snapshot file written by CompressedSnapshotWriter and decodes its snapshots.
+     *
+     * A snapshot which is not a keyframe is decoded from the last keyframe before it. The reader keeps the
+     * last decoded snapshot, so reading the snapshots in order decodes every snapshot only once.
+     */
+    class CompressedSnapshotReader {
+    public:
+
+        /**
+         * Maps the file and checks the header and the footer.
+         *
+         * @param [in] fileName The name of the file
+         */
+        CompressedSnapshotReader(const std::string &fileName);
+
+        ~CompressedSnapshotReader();
+
+        /** @return False if the file could not be mapped or is no complete compressed snapshot file of type T */
+        bool isValid() const {
+            return m_header != 0;
+        }
+
+        unsigned long getNumberOfSnapshots() const {
+            return m_footer->numberOfSnapshots;
+        }
+
+        /** @return The number of stored cells per snapshot */
+        unsigned long getNumberOfCells() const {
+            return m_header->cellCount;
+        }
+
+        /** @return The number of cells of the simulation */
+        unsigned long getNumberOfOriginalCells() const {
+            return m_header->originalCellCount;
+        }
+
+        /** @return The simulation cell of the first stored cell */
+        unsigned long getFirstCell() const {
+            return m_header->firstCell;
+        }
+
+        /** @return The number of simulation cells between two stored cells */
+        unsigned long getCellStride() const {
+            return m_header->cellStride;
+        }
+
+        T getCellSize() const {
+            return m_header->cellSize;
+        }
+
+        bool isLossy() const {
+            return m_header->mode == COMPRESSION_LOSSY;
+        }
+
+        unsigned long getStep(unsigned long snapshot) const {
+            return m_index[snapshot].step;
+        }
+
+        double getTime(unsigned long snapshot) const {
+            return m_index[snapshot].time;
+        }
+
+        /**
+         * Decodes a snapshot.
+         *
+         * @param [in] snapshot The number of the snapshot
+         * @param [out] h The heights of the stored cells
+         * @param [out] hu The momentums of the stored cells
+         * @return False if the snapshot is corrupt
+         */
+        bool read(unsigned long snapshot, T *h, T *hu);
+
+        /**
+         * @param [in] time A simulated time
+         * @return The last snapshot taken at or before the given time, 0 if there is none
+         */
+        unsigned long findSnapshot(double time) const;
+
+    private:
+
+        /** Decodes a snapshot into m_values, the previous snapshot must be in m_reference unless it is a keyframe */
+        bool decode(unsigned long snapshot);
+
+        void *m_mapping;
+        std::size_t m_length;
+
+        const CompressedSnapshotFileHeader *m_header;
+        const SnapshotIndexEntry *m_index;
+        const SnapshotFileFooter *m_footer;
+
+        SnapshotCodec m_codec;
+        /** The integers of the last decoded snapshot (see SnapshotCodec::decode) */
+        std::vector<uint64_t> m_reference;
+        /** The values of the last decoded snapshot, h followed by hu */
+        std::vector<T> m_values;
+        /** The last decoded snapshot or getNumberOfSnapshots() if there is none */
+        unsigned long m_decoded;
+    };
+
+}
+
+#endif	/* _COMPRESSEDSNAPSHOTREADER_H */
@@ -0,0 +1,280 @@
+/*
+ * File:   CompressedSnapshotWriter.cpp
+ *
+ * Asynchronous writer for compressed time series of h and hu.
+ */
+
+#include "CompressedSnapshotWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "SnapshotCodec.h"
+
+io::CompressedSnapshotWriter::CompressedSnapshotWriter(const std::string &fileName, unsigned long size, T cellSize,
+        const SnapshotCompression &compression, unsigned int stepInterval, double timeInterval, unsigned int numberOfThreads,
+        unsigned int numberOfBuffers)
+    : m_file(0), m_size(size), m_compression(compression), m_cellCount(0), m_numberOfBlocks(0), m_stepInterval(stepInterval),
+      m_timeInterval(timeInterval), m_nextTime(0), m_numberOfSnapshots(0), m_offset(0), m_writtenSnapshots(0),
+      m_compressedBytes(0), m_encodedBytes(0), m_encodingTime(0), m_buffers(std::max(numberOfBuffers, 2u)), m_lastBuffer(0),
+      m_closing(false), m_failed(false)
+{
+    if (m_compression.endCell == 0 || m_compression.endCell > size)
+        m_compression.endCell = size;
+    m_compression.cellStride = std::max(m_compression.cellStride, 1ul);
+    m_compression.blockSize = std::max(m_compression.blockSize, 1u);
+    m_compression.keyframeInterval = std::max(m_compression.keyframeInterval, 1u);
+    m_cellCount = compressedCellCount(m_compression.firstCell, m_compression.endCell, m_compression.cellStride);
+    m_numberOfBlocks = (m_cellCount + m_compression.blockSize - 1) / m_compression.blockSize;
+    if (m_cellCount == 0 || (m_compression.lossy && (m_compression.heightTolerance <= 0 || m_compression.momentumTolerance <= 0))) {
+        std::cerr << "Invalid compression of the snapshot file " << fileName << std::endl;
+        m_failed = true;
+        return;
+    }
+
+    m_file = std::fopen(fileName.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Could not create snapshot file " << fileName << std::endl;
+        m_failed = true;
+        return;
+    }
+
+    CompressedSnapshotFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SWECSNP", 8);
+    header.version = COMPRESSED_SNAPSHOT_VERSION;
+    header.bytesPerValue = sizeof(T);
+    header.mode = m_compression.lossy ? COMPRESSION_LOSSY : COMPRESSION_LOSSLESS;
+    header.blockSize = m_compression.blockSize;
+    header.originalCellCount = size;
+    header.cellCount = m_cellCount;
+    header.firstCell = m_compression.firstCell;
+    header.cellStride = m_compression.cellStride;
+    header.cellSize = cellSize;
+    header.heightTolerance = m_compression.heightTolerance;
+    header.momentumTolerance = m_compression.momentumTolerance;
+    header.keyframeInterval = m_compression.keyframeInterval;
+    writeToFile(&header, sizeof(header), 1);
+    m_offset = sizeof(header);
+
+    for (unsigned int i = 0; i < m_buffers.size(); i++) {
+        m_buffers[i].data.resize(2 * m_cellCount);
+        m_buffers[i].blocks.resize(2 * m_numberOfBlocks);
+        m_freeBuffers.push_back(&m_buffers[i]);
+    }
+    for (unsigned int i = 0; i < std::max(numberOfThreads, 1u); i++)
+        m_encoders.push_back(std::thread(&CompressedSnapshotWriter::encodeBlocks, this));
+    m_thread = std::thread(&CompressedSnapshotWriter::writeBuffers, this);
+}
+
+io::CompressedSnapshotWriter::~CompressedSnapshotWriter() {
+    close();
+}
+
+bool io::CompressedSnapshotWriter::write(const T *h, const T *hu, unsigned long step, double time) {
+    if (!isOpen())
+        return false;
+    bool stepReached = m_stepInterval > 0 && step % m_stepInterval == 0;
+    bool timeReached = m_timeInterval > 0 && time >= m_nextTime;
+    if (!stepReached && !timeReached)
+        return false;
+    if (timeReached)
+        m_nextTime = (std::floor(time / m_timeInterval) + 1) * m_timeInterval;
+
+    Buffer *buffer;
+    {
+        // back-pressure: wait until a snapshot was written and the next one does not need it anymore
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return !m_freeBuffers.empty(); });
+        buffer = m_freeBuffers.front();
+        m_freeBuffers.pop_front();
+    }
+
+    const T *first = h + m_compression.firstCell;
+    const unsigned long stride = m_compression.cellStride;
+    for (unsigned long i = 0; i < m_cellCount; i++)
+        buffer->data[i] = first[i * stride];
+    first = hu + m_compression.firstCell;
+    for (unsigned long i = 0; i < m_cellCount; i++)
+        buffer->data[m_cellCount + i] = first[i * stride];
+    buffer->step = step;
+    buffer->time = time;
+    buffer->keyframe = m_numberOfSnapshots % m_compression.keyframeInterval == 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // the reference to the last snapshot is handed over to the encoding of this one
+        buffer->previous = buffer->keyframe ? 0 : m_lastBuffer;
+        if (buffer->keyframe && m_lastBuffer)
+            release(m_lastBuffer);
+        m_lastBuffer = buffer;
+        buffer->users = 2;
+        buffer->remainingBlocks = 2 * m_numberOfBlocks;
+        for (unsigned int block = 0; block < 2 * m_numberOfBlocks; block++) {
+            Task task = {buffer, block};
+            m_tasks.push_back(task);
+        }
+        m_pendingBuffers.push_back(buffer);
+    }
+    m_condition.notify_all();
+    m_numberOfSnapshots++;
+    return true;
+}
+
+void io::CompressedSnapshotWriter::release(Buffer *buffer) {
+    if (--buffer->users == 0)
+        m_freeBuffers.push_back(buffer);
+}
+
+void io::CompressedSnapshotWriter::encodeBlocks() {
+    SnapshotCodec codec(m_compression.lossy);
+
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_closing || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+            task = m_tasks.front();
+            m_tasks.pop_front();
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Buffer *buffer = task.buffer;
+        unsigned int field = task.block / m_numberOfBlocks;
+        unsigned long begin = (unsigned long) (task.block % m_numberOfBlocks) * m_compression.blockSize;
+        unsigned long count = std::min<unsigned long>(m_compression.blockSize, m_cellCount - begin);
+        unsigned long offset = field * m_cellCount + begin;
+        std::vector<unsigned char> &out = buffer->blocks[task.block];
+        out.clear();
+        codec.encode(&buffer->data[offset], buffer->previous ? &buffer->previous->data[offset] : 0, count,
+                field == 0 ? m_compression.heightTolerance : m_compression.momentumTolerance, out);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        bool encoded;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_encodedBytes += count * sizeof(T);
+            m_encodingTime += seconds;
+            encoded = --buffer->remainingBlocks == 0;
+            if (encoded && buffer->previous)
+                release(buffer->previous);
+        }
+        if (encoded)
+            m_condition.notify_all();
+    }
+}
+
+void io::CompressedSnapshotWriter::writeBuffers() {
+    static const char padding[COMPRESSED_CHUNK_ALIGNMENT] = {0};
+    std::vector<uint32_t> sizes(2 * m_numberOfBlocks);
+
+    for (;;) {
+        Buffer *buffer;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] {
+                return (m_closing && m_pendingBuffers.empty())
+                        || (!m_pendingBuffers.empty() && m_pendingBuffers.front()->remainingBlocks == 0);
+            });
+            if (m_pendingBuffers.empty())
+                return;
+            buffer = m_pendingBuffers.front();
+            m_pendingBuffers.pop_front();
+        }
+
+        CompressedChunkHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "CCHUNK", 7);
+        header.step = buffer->step;
+        header.time = buffer->time;
+        header.keyframe = buffer->keyframe;
+        header.numberOfBlocks = m_numberOfBlocks;
+        header.payloadSize = sizes.size() * sizeof(uint32_t);
+        for (unsigned int block = 0; block < sizes.size(); block++) {
+            sizes[block] = buffer->blocks[block].size();
+            header.payloadSize += sizes[block];
+        }
+        // after a failure, the remaining snapshots are only released, so write() does not wait forever
+        uint64_t chunkSize = compressedChunkSize(header.payloadSize);
+        bool written = !m_failed && writeToFile(&header, sizeof(header), 1) && writeToFile(&sizes[0], sizeof(uint32_t), sizes.size());
+        for (unsigned int block = 0; written && block < sizes.size(); block++)
+            written = writeToFile(buffer->blocks[block].data(), 1, sizes[block]);
+        if (written && writeToFile(padding, 1, chunkSize - sizeof(header) - header.payloadSize)) {
+            SnapshotIndexEntry entry = {buffer->step, buffer->time, m_offset};
+            m_index.push_back(entry);
+            m_offset += chunkSize;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_failed) {
+                m_writtenSnapshots++;
+                m_compressedBytes += chunkSize;
+            }
+            release(buffer);
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool io::CompressedSnapshotWriter::writeToFile(const void *data, std::size_t size, std::size_t count) {
+    if (std::fwrite(data, size, count, m_file) == count)
+        return true;
+    if (!m_failed.exchange(true))
+        std::cerr << "Could not write the snapshot file" << std::endl;
+    return false;
+}
+
+bool io::CompressedSnapshotWriter::close() {
+    if (!m_file)
+        return !m_failed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+        if (m_lastBuffer)
+            release(m_lastBuffer);
+        m_lastBuffer = 0;
+    }
+    m_condition.notify_all();
+    for (unsigned int i = 0; i < m_encoders.size(); i++)
+        m_encoders[i].join();
+    m_thread.join();
+
+    SnapshotFileFooter footer;
+    std::memset(&footer, 0, sizeof(footer));
+    footer.numberOfSnapshots = m_index.size();
+    footer.indexOffset = m_offset;
+    std::memcpy(footer.magic, "SWEINDX", 8);
+    // a file with a failed write has no valid index
+    if (!m_failed && (m_index.empty() || writeToFile(&m_index[0], sizeof(SnapshotIndexEntry), m_index.size())))
+        writeToFile(&footer, sizeof(footer), 1);
+    if (std::fclose(m_file) != 0 && !m_failed.exchange(true))
+        std::cerr << "Could not write the snapshot file" << std::endl;
+    m_file = 0;
+    return !m_failed;
+}
+
+double io::CompressedSnapshotWriter::getUncompressedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (double) m_writtenSnapshots * 2 * m_size * sizeof(T);
+}
+
+double io::CompressedSnapshotWriter::getCompressedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_compressedBytes;
+}
+
+double io::CompressedSnapshotWriter::getCompressionRatio() const {
+    double compressedBytes = getCompressedBytes();
+    return compressedBytes > 0 ? getUncompressedBytes() / compressedBytes : 0;
+}
+
+double io::CompressedSnapshotWriter::getThroughput() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_encodingTime > 0 ? m_encodedBytes / m_encodingTime : 0;
+}
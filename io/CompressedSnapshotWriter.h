@@ -0,0 +1,207 @@
+/*
+ * File:   CompressedSnapshotWriter.h
+ *
+ * Asynchronous writer for compressed time series of h and hu.
+ */
+
+#ifndef _COMPRESSEDSNAPSHOTWRITER_H
+#define	_COMPRESSEDSNAPSHOTWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../types.h"
+#include "CompressedSnapshotFormat.h"
+
+namespace io {
+
+    /**
+     * What and how a CompressedSnapshotWriter stores.
+     */
+    struct SnapshotCompression {
+        /** False stores the exact values, true quantizes them to the tolerances */
+        bool lossy;
+        /** The maximum error of h in the lossy mode */
+        double heightTolerance;
+        /** The maximum error of hu in the lossy mode */
+        double momentumTolerance;
+        /** The first stored cell */
+        unsigned long firstCell;
+        /** The end of the stored cells, 0 stores all cells up to the end of the domain */
+        unsigned long endCell;
+        /** Only every cellStride-th cell is stored */
+        unsigned long cellStride;
+        /** The number of stored cells which are encoded at once by a thread */
+        unsigned int blockSize;
+        /** Every keyframeInterval-th snapshot can be decoded without the previous ones */
+        unsigned int keyframeInterval;
+
+        SnapshotCompression()
+            : lossy(false), heightTolerance(0), momentumTolerance(0), firstCell(0), endCell(0), cellStride(1),
+              blockSize(65536), keyframeInterval(16) {
+        }
+    };
+
+    /**
+     * Writes compressed snapshots of h and hu to a file in the format described in CompressedSnapshotFormat.h
+     * without stalling the solver.
+     *
+     * write() only copies the stored cells into a free buffer and returns. The blocks of the buffer are encoded
+     * by a pool of threads (see SnapshotCodec.h) and written to the file in order by an I/O thread. A snapshot
+     * which is not a keyframe is encoded against the previous one, so a buffer is released when it is written
+     * and the next snapshot is encoded. If no buffer is free, write() blocks (back-pressure).
+     *
+     * Like SnapshotWriter, a failed write stops the I/O thread from writing. isOpen() becomes false and close()
+     * reports the failure.
+     */
+    class CompressedSnapshotWriter {
+    public:
+
+        /**
+         * Creates the file, writes the file header and starts the threads.
+         *
+         * @param [in] fileName The name of the file
+         * @param [in] size The number of cells which are passed to write() (usually without the ghost cells)
+         * @param [in] cellSize The size of one cell
+         * @param [in] compression The stored cells and the compression mode
+         * @param [in] stepInterval A snapshot is written every stepInterval steps, 0 disables this criterion
+         * @param [in] timeInterval A snapshot is written every timeInterval seconds of simulated time, 0 disables this criterion
+         * @param [in] numberOfThreads The number of threads which encode the blocks
+         * @param [in] numberOfBuffers The number of snapshots which can be pending at the same time (at least 2)
+         */
+        CompressedSnapshotWriter(const std::string &fileName, unsigned long size, T cellSize,
+                const SnapshotCompression &compression = SnapshotCompression(), unsigned int stepInterval = 1,
+                double timeInterval = 0, unsigned int numberOfThreads = 2, unsigned int numberOfBuffers = 4);
+
+        /** Waits for all pending snapshots and closes the file */
+        ~CompressedSnapshotWriter();
+
+        /** @return False if the file could not be created or written, the compression is invalid or the file is closed */
+        bool isOpen() const {
+            return m_file != 0 && !m_failed;
+        }
+
+        /** @return True if the compression is invalid, the file could not be created or a part of it could not be written */
+        bool hasFailed() const {
+            return m_failed;
+        }
+
+        /**
+         * Hands a snapshot to the threads if the step or the time interval is reached.
+         *
+         * @param [in] h The heights of the size cells
+         * @param [in] hu The momentums of the size cells
+         * @param [in] step The number of the time step
+         * @param [in] time The simulated time
+         * @return True if a snapshot was taken
+         */
+        bool write(const T *h, const T *hu, unsigned long step, double time);
+
+        /**
+         * Waits for all pending snapshots, appends the index and closes the file.
+         *
+         * @return False if the writer has failed, see hasFailed()
+         */
+        bool close();
+
+        /** @return The number of snapshots handed to the threads so far */
+        unsigned long getNumberOfSnapshots() const {
+            return m_numberOfSnapshots;
+        }
+
+        /** @return The number of bytes the written snapshots would take with all cells and without compression */
+        double getUncompressedBytes() const;
+
+        /** @return The number of bytes of the written snapshots */
+        double getCompressedBytes() const;
+
+        /** @return The uncompressed bytes of the full fields per compressed byte */
+        double getCompressionRatio() const;
+
+        /** @return The stored cells in bytes which are encoded per second by one thread */
+        double getThroughput() const;
+
+    private:
+
+        struct Buffer {
+            /** The stored cells of h followed by the stored cells of hu */
+            std::vector<T> data;
+            unsigned long step;
+            double time;
+            bool keyframe;
+            /** The snapshot the buffer is encoded against or NULL for a keyframe */
+            Buffer *previous;
+            /** One encoded block per field and block */
+            std::vector<std::vector<unsigned char> > blocks;
+            unsigned int remainingBlocks;
+            /** The number of pending uses: written to the file, encoding the next snapshot */
+            unsigned int users;
+        };
+
+        struct Task {
+            Buffer *buffer;
+            unsigned int block;
+        };
+
+        /** Main loop of the encoding threads */
+        void encodeBlocks();
+
+        /** Main loop of the I/O thread */
+        void writeBuffers();
+
+        /** Releases one use of a buffer, the lock must be held */
+        void release(Buffer *buffer);
+
+        /**
+         * Writes to the file and records a failure.
+         *
+         * @return False if the write failed
+         */
+        bool writeToFile(const void *data, std::size_t size, std::size_t count);
+
+        std::FILE *m_file;
+        unsigned long m_size;
+        SnapshotCompression m_compression;
+        unsigned long m_cellCount;
+        unsigned int m_numberOfBlocks;
+        unsigned int m_stepInterval;
+        double m_timeInterval;
+        double m_nextTime;
+        unsigned long m_numberOfSnapshots;
+
+        /** Current end of the file */
+        uint64_t m_offset;
+        std::vector<SnapshotIndexEntry> m_index;
+        unsigned long m_writtenSnapshots;
+        double m_compressedBytes;
+        /** The stored cells in bytes which were encoded and the seconds the threads needed for them */
+        double m_encodedBytes;
+        double m_encodingTime;
+
+        std::vector<Buffer> m_buffers;
+        /** Buffers which can be filled by write() */
+        std::deque<Buffer*> m_freeBuffers;
+        /** Buffers in the order in which they are written to the file */
+        std::deque<Buffer*> m_pendingBuffers;
+        /** Blocks which wait for an encoding thread */
+        std::deque<Task> m_tasks;
+        /** The last snapshot, the next one is encoded against it */
+        Buffer *m_lastBuffer;
+        bool m_closing;
+        /** Set by any thread which fails to write to the file */
+        std::atomic<bool> m_failed;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::vector<std::thread> m_encoders;
+        std::thread m_thread;
+    };
+
+}
+
+#endif	/* _COMPRESSEDSNAPSHOTWRITER_H */
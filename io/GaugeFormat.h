@@ -0,0 +1,72 @@
+/*
+ * File:   GaugeFormat.h
+ *
+ * Layout of the binary tide gauge files.
+ */
+
+#ifndef _GAUGEFORMAT_H
+#define	_GAUGEFORMAT_H
+
+#include <stdint.h>
+
+namespace io {
+
+    /**
+     * A gauge file is append-only and consists of
+     * <ul>
+     *  <li>one GaugeFileHeader,</li>
+     *  <li>the positions of the gauges as doubles, padded to a multiple of GAUGE_ALIGNMENT bytes,</li>
+     *  <li>blocks of blockLength samples: a GaugeBlockHeader, the times of the samples as doubles and then
+     *      h, hu and the free surface of every gauge with blockLength values each, padded to a multiple of
+     *      GAUGE_ALIGNMENT bytes.</li>
+     * </ul>
+     * All blocks have the same size, only the last one may contain less than blockLength samples. A sample
+     * of a gauge can therefore be located without an index, and the file of an aborted run stays readable up
+     * to its last complete block. Values are stored in the native byte order.
+     */
+    const unsigned int GAUGE_ALIGNMENT = 64;
+
+    /** Version of the file format, incremented on incompatible changes */
+    const uint32_t GAUGE_VERSION = 1;
+
+    /** Number of values per gauge and sample: h, hu and the free surface h + b */
+    const unsigned int GAUGE_FIELDS = 3;
+
+    struct GaugeFileHeader {
+        /** "SWEGAUG" */
+        char magic[8];
+        uint32_t version;
+        /** sizeof(T) of the stored values */
+        uint32_t bytesPerValue;
+        uint32_t numberOfGauges;
+        uint32_t blockLength;
+        uint64_t cellCount;
+        double cellSize;
+        char padding[GAUGE_ALIGNMENT - 40];
+    };
+
+    struct GaugeBlockHeader {
+        /** "BLOCK" */
+        char magic[8];
+        /** Number of the first sample of the block */
+        uint64_t firstSample;
+        uint64_t sampleCount;
+        char padding[GAUGE_ALIGNMENT - 24];
+    };
+
+    /** @return Offset of the first block from the beginning of the file */
+    inline uint64_t gaugeDataOffset(uint32_t numberOfGauges) {
+        uint64_t size = sizeof(GaugeFileHeader) + numberOfGauges * sizeof(double);
+        return (size + GAUGE_ALIGNMENT - 1) / GAUGE_ALIGNMENT * GAUGE_ALIGNMENT;
+    }
+
+    /** @return The number of bytes of one block including its header and the padding */
+    inline uint64_t gaugeBlockSize(uint32_t numberOfGauges, uint32_t blockLength, uint32_t bytesPerValue) {
+        uint64_t size = sizeof(GaugeBlockHeader) + blockLength * sizeof(double)
+                + (uint64_t) numberOfGauges * GAUGE_FIELDS * blockLength * bytesPerValue;
+        return (size + GAUGE_ALIGNMENT - 1) / GAUGE_ALIGNMENT * GAUGE_ALIGNMENT;
+    }
+
+}
+
+#endif	/* _GAUGEFORMAT_H */
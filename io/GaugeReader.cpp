@@ -0,0 +1,64 @@
+/*
+ * File:   GaugeReader.cpp
+ *
+ * Random access to the time series of a gauge file.
+ */
+
+#include "GaugeReader.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+io::GaugeReader::GaugeReader(const std::string &fileName)
+    : m_mapping(MAP_FAILED), m_length(0), m_header(0), m_positions(0), m_data(0), m_blockSize(0), m_numberOfSamples(0)
+{
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Could not open gauge file " << fileName << std::endl;
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) sizeof(GaugeFileHeader)) {
+        m_length = status.st_size;
+        m_mapping = mmap(0, m_length, PROT_READ, MAP_SHARED, file, 0);
+    }
+    ::close(file);
+    if (m_mapping == MAP_FAILED) {
+        std::cerr << "Could not map gauge file " << fileName << std::endl;
+        return;
+    }
+
+    const char *begin = static_cast<const char*> (m_mapping);
+    const GaugeFileHeader *header = reinterpret_cast<const GaugeFileHeader*> (begin);
+    if (std::memcmp(header->magic, "SWEGAUG", 8) != 0 || header->version != GAUGE_VERSION
+            || header->bytesPerValue != sizeof(T) || header->blockLength == 0
+            || gaugeDataOffset(header->numberOfGauges) > m_length) {
+        std::cerr << "Invalid gauge file " << fileName << std::endl;
+        return;
+    }
+    m_positions = reinterpret_cast<const double*> (begin + sizeof(GaugeFileHeader));
+    m_data = begin + gaugeDataOffset(header->numberOfGauges);
+    m_blockSize = gaugeBlockSize(header->numberOfGauges, header->blockLength, sizeof(T));
+
+    // an incomplete block at the end was cut off while it was written
+    uint64_t numberOfBlocks = (m_length - gaugeDataOffset(header->numberOfGauges)) / m_blockSize;
+    if (numberOfBlocks > 0) {
+        const GaugeBlockHeader *last = reinterpret_cast<const GaugeBlockHeader*> (m_data + (numberOfBlocks - 1) * m_blockSize);
+        if (std::memcmp(last->magic, "BLOCK", 6) != 0 || last->sampleCount > header->blockLength) {
+            std::cerr << "Invalid gauge file " << fileName << std::endl;
+            return;
+        }
+        m_numberOfSamples = (numberOfBlocks - 1) * header->blockLength + last->sampleCount;
+    }
+    m_header = header;
+}
+
+io::GaugeReader::~GaugeReader() {
+    if (m_mapping != MAP_FAILED)
+        munmap(m_mapping, m_length);
+}
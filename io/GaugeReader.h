@@ -0,0 +1,106 @@
+/*
+ * File:   GaugeReader.h
+ *
+ * Random access to the time series of a gauge file.
+ */
+
+#ifndef _GAUGEREADER_H
+#define	_GAUGEREADER_H
+
+#include <cstddef>
+#include <string>
+
+#include "../types.h"
+#include "GaugeFormat.h"
+
+namespace io {
+
+    /**
+     * Memory-maps a gauge file written by GaugeWriter.
+     *
+     * The values of one gauge are stored in one series per block, so reading the time series of a
+     * single gauge only reads its own pages from the disk. Files of aborted runs can be read up to their
+     * last complete block.
+     */
+    class GaugeReader {
+    public:
+
+        /**
+         * Maps the file and checks the header.
+         *
+         * @param [in] fileName The name of the file
+         */
+        GaugeReader(const std::string &fileName);
+
+        ~GaugeReader();
+
+        /** @return False if the file could not be mapped or is no gauge file of type T */
+        bool isValid() const {
+            return m_header != 0;
+        }
+
+        unsigned int getNumberOfGauges() const {
+            return m_header->numberOfGauges;
+        }
+
+        /** @return The position of a gauge, measured from the left end of the domain */
+        double getPosition(unsigned int gauge) const {
+            return m_positions[gauge];
+        }
+
+        unsigned long getNumberOfCells() const {
+            return m_header->cellCount;
+        }
+
+        T getCellSize() const {
+            return m_header->cellSize;
+        }
+
+        unsigned long getNumberOfSamples() const {
+            return m_numberOfSamples;
+        }
+
+        double getTime(unsigned long sample) const {
+            return reinterpret_cast<const double*> (getBlock(sample) + sizeof(GaugeBlockHeader))[sample % m_header->blockLength];
+        }
+
+        T getHeight(unsigned int gauge, unsigned long sample) const {
+            return getValue(gauge, 0, sample);
+        }
+
+        T getMomentum(unsigned int gauge, unsigned long sample) const {
+            return getValue(gauge, 1, sample);
+        }
+
+        /** @return The free surface h + b */
+        T getSurface(unsigned int gauge, unsigned long sample) const {
+            return getValue(gauge, 2, sample);
+        }
+
+    private:
+
+        /** @return The beginning of the block which contains a sample */
+        const char *getBlock(unsigned long sample) const {
+            return m_data + sample / m_header->blockLength * m_blockSize;
+        }
+
+        T getValue(unsigned int gauge, unsigned int field, unsigned long sample) const {
+            const unsigned long blockLength = m_header->blockLength;
+            const T *series = reinterpret_cast<const T*> (getBlock(sample) + sizeof(GaugeBlockHeader) + blockLength * sizeof(double));
+            return series[(gauge * GAUGE_FIELDS + field) * blockLength + sample % blockLength];
+        }
+
+        void *m_mapping;
+        std::size_t m_length;
+
+        const GaugeFileHeader *m_header;
+        const double *m_positions;
+        /** The first block */
+        const char *m_data;
+        uint64_t m_blockSize;
+        unsigned long m_numberOfSamples;
+    };
+
+}
+
+#endif	/* _GAUGEREADER_H */
@@ -0,0 +1,172 @@
+/*
+ * File:   GaugeWriter.cpp
+ *
+ * Asynchronous writer for the time series of tide gauges.
+ */
+
+#include "GaugeWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+io::GaugeWriter::GaugeWriter(const std::string &fileName, const std::vector<double> &positions, unsigned int size, T cellSize,
+        unsigned int blockLength, unsigned int numberOfBlocks)
+    : m_blockLength(std::max(blockLength, 1u)), m_numberOfBlocks(std::max(numberOfBlocks, 2u)),
+      m_cells(positions.size()), m_weights(positions.size()), m_seriesStride(0), m_numberOfSamples(0), m_completedBlocks(0),
+      m_writtenBlocks(0), m_closing(false), m_failed(false)
+{
+    m_file = std::fopen(fileName.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Could not create gauge file " << fileName << std::endl;
+        m_failed = true;
+        return;
+    }
+
+    GaugeFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SWEGAUG", 8);
+    header.version = GAUGE_VERSION;
+    header.bytesPerValue = sizeof(T);
+    header.numberOfGauges = positions.size();
+    header.blockLength = m_blockLength;
+    header.cellCount = size;
+    header.cellSize = cellSize;
+    static const char padding[GAUGE_ALIGNMENT] = {0};
+    if (writeToFile(&header, sizeof(header), 1) && (positions.empty() || writeToFile(&positions[0], sizeof(double), positions.size())))
+        writeToFile(padding, 1, gaugeDataOffset(positions.size()) - sizeof(header) - positions.size() * sizeof(double));
+
+    // the center of cell i is at (i - 0.5) * cellSize, cell 0 is the left ghost cell
+    for (std::size_t gauge = 0; gauge < positions.size(); gauge++) {
+        double cell = positions[gauge] / cellSize + 0.5;
+        unsigned int left = std::min<double>(std::max<double>(std::floor(cell), 1), std::max(size, 2u) - 1);
+        m_cells[gauge] = left;
+        m_weights[gauge] = std::min<double>(std::max<double>(cell - left, 0), 1);
+    }
+
+    // write() stores one value in every series, with a power of two distance they all map to the same cache sets
+    m_seriesStride = ((m_blockLength * sizeof(T) + GAUGE_ALIGNMENT - 1) / GAUGE_ALIGNMENT | 1) * GAUGE_ALIGNMENT / sizeof(T);
+    m_samples.resize((std::size_t) m_numberOfBlocks * m_seriesStride * GAUGE_FIELDS * positions.size());
+    m_times.resize((std::size_t) m_numberOfBlocks * m_blockLength);
+    m_thread = std::thread(&GaugeWriter::writeBlocks, this);
+}
+
+io::GaugeWriter::~GaugeWriter() {
+    close();
+}
+
+template <typename Storage> bool io::GaugeWriter::write(const Storage *h, const Storage *hu, const Storage *b, double time) {
+    if (!isOpen())
+        return false;
+    unsigned long block = m_numberOfSamples / m_blockLength;
+    if (m_numberOfSamples % m_blockLength == 0 && block >= m_numberOfBlocks) {
+        // back-pressure: wait until the I/O thread has written the block which is reused
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this, block] { return m_writtenBlocks + m_numberOfBlocks > block; });
+    }
+
+    const std::size_t sample = m_numberOfSamples % m_blockLength;
+    const std::size_t numberOfGauges = m_cells.size();
+    const unsigned int *cells = m_cells.data();
+    const T *weights = m_weights.data();
+    T *series = m_samples.data() + (block % m_numberOfBlocks) * GAUGE_FIELDS * numberOfGauges * m_seriesStride + sample;
+    const std::size_t stride = m_seriesStride;
+    for (std::size_t gauge = 0; gauge < numberOfGauges; gauge++) {
+        const unsigned int i = cells[gauge];
+        const T weight = weights[gauge];
+        const T height = (T) h[i] + weight * ((T) h[i + 1] - (T) h[i]);
+        T *values = series + GAUGE_FIELDS * gauge * stride;
+        values[0] = height;
+        values[stride] = (T) hu[i] + weight * ((T) hu[i + 1] - (T) hu[i]);
+        values[2 * stride] = b ? height + (T) b[i] + weight * ((T) b[i + 1] - (T) b[i]) : height;
+    }
+    m_times[(block % m_numberOfBlocks) * m_blockLength + sample] = time;
+
+    m_numberOfSamples++;
+    if (m_numberOfSamples % m_blockLength == 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completedBlocks++;
+        }
+        m_condition.notify_all();
+    }
+    return true;
+}
+
+template bool io::GaugeWriter::write<float>(const float *h, const float *hu, const float *b, double time);
+template bool io::GaugeWriter::write<double>(const double *h, const double *hu, const double *b, double time);
+
+void io::GaugeWriter::writeBlocks() {
+    for (;;) {
+        unsigned long block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_closing || m_completedBlocks > m_writtenBlocks; });
+            if (m_completedBlocks == m_writtenBlocks)
+                return;
+            block = m_writtenBlocks;
+        }
+
+        writeBlock(block, m_blockLength);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writtenBlocks++;
+        }
+        m_condition.notify_all();
+    }
+}
+
+void io::GaugeWriter::writeBlock(unsigned long block, unsigned int sampleCount) {
+    if (m_failed)
+        return;
+    static const char padding[GAUGE_ALIGNMENT] = {0};
+    const std::size_t valuesPerSample = GAUGE_FIELDS * m_cells.size();
+    double *times = &m_times[(block % m_numberOfBlocks) * m_blockLength];
+    T *series = m_samples.data() + (block % m_numberOfBlocks) * valuesPerSample * m_seriesStride;
+    // unused samples of the last block are written as 0
+    if (sampleCount < m_blockLength) {
+        std::fill(times + sampleCount, times + m_blockLength, 0.);
+        for (std::size_t value = 0; value < valuesPerSample; value++)
+            std::fill(series + value * m_seriesStride + sampleCount, series + value * m_seriesStride + m_blockLength, (T) 0);
+    }
+
+    GaugeBlockHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "BLOCK", 6);
+    header.firstSample = block * m_blockLength;
+    header.sampleCount = sampleCount;
+    bool written = writeToFile(&header, sizeof(header), 1) && writeToFile(times, sizeof(double), m_blockLength);
+    for (std::size_t value = 0; written && value < valuesPerSample; value++)
+        written = writeToFile(series + value * m_seriesStride, sizeof(T), m_blockLength);
+    uint64_t size = sizeof(header) + m_blockLength * sizeof(double) + valuesPerSample * m_blockLength * sizeof(T);
+    if (written)
+        writeToFile(padding, 1, gaugeBlockSize(m_cells.size(), m_blockLength, sizeof(T)) - size);
+}
+
+bool io::GaugeWriter::writeToFile(const void *data, std::size_t size, std::size_t count) {
+    if (std::fwrite(data, size, count, m_file) == count)
+        return true;
+    if (!m_failed.exchange(true))
+        std::cerr << "Could not write the gauge file" << std::endl;
+    return false;
+}
+
+bool io::GaugeWriter::close() {
+    if (!m_file)
+        return !m_failed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    if (m_numberOfSamples % m_blockLength > 0)
+        writeBlock(m_numberOfSamples / m_blockLength, m_numberOfSamples % m_blockLength);
+    if (std::fclose(m_file) != 0 && !m_failed.exchange(true))
+        std::cerr << "Could not write the gauge file" << std::endl;
+    m_file = 0;
+    return !m_failed;
+}
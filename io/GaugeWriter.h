@@ -0,0 +1,139 @@
+/*
+ * File:   GaugeWriter.h
+ *
+ * Asynchronous writer for the time series of tide gauges.
+ */
+
+#ifndef _GAUGEWRITER_H
+#define	_GAUGEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../types.h"
+#include "GaugeFormat.h"
+
+namespace io {
+
+    /**
+     * Samples h, hu and the free surface at a set of gauge positions and writes the time series to a file
+     * in the format described in GaugeFormat.h.
+     *
+     * The positions are converted into a cell and an interpolation weight once, so write() only interpolates
+     * between two neighboring cell centers per gauge. Every gauge has a preallocated ring buffer of
+     * numberOfBlocks blocks per field, and the blocks of all rings are laid out like the blocks of the file
+     * (apart from the padding between the series), so the I/O thread writes them without rearranging the
+     * values. The solver thread only takes the lock once per block; if all blocks are still waiting for the
+     * I/O thread, write() blocks until one becomes free again.
+     *
+     * A failed write stops the I/O thread from writing, the blocks are still released. isOpen() becomes false
+     * and close() reports the failure.
+     */
+    class GaugeWriter {
+    public:
+
+        /**
+         * Creates the file and writes the file header and the gauge positions.
+         *
+         * @param [in] fileName The name of the file
+         * @param [in] positions The positions of the gauges, measured from the left end of the domain; positions
+         *  between the outermost cell centers and the boundary get the value of the outermost cell
+         * @param [in] size The number of cells without the ghost cells
+         * @param [in] cellSize The size of one cell
+         * @param [in] blockLength The number of samples which are written at once
+         * @param [in] numberOfBlocks The number of blocks in the ring, at least 2 to write and sample at the same time
+         */
+        GaugeWriter(const std::string &fileName, const std::vector<double> &positions, unsigned int size, T cellSize,
+                unsigned int blockLength = 256, unsigned int numberOfBlocks = 4);
+
+        /** Writes the remaining samples and closes the file */
+        ~GaugeWriter();
+
+        /** @return False if the file could not be created or written or is closed */
+        bool isOpen() const {
+            return m_file != 0 && !m_failed;
+        }
+
+        /** @return True if the file could not be created or a part of it could not be written */
+        bool hasFailed() const {
+            return m_failed;
+        }
+
+        /**
+         * Samples all gauges. The arrays may be stored in float or double, the samples are stored as T.
+         *
+         * @param [in] h The heights of the water columns including one ghost cell on each side
+         * @param [in] hu The momentums of the water columns including the ghost cells
+         * @param [in] b The bathymetry including the ghost cells or NULL for a bathymetry of 0
+         * @param [in] time The simulated time
+         * @return False if the file is not open
+         */
+        template <typename Storage> bool write(const Storage *h, const Storage *hu, const Storage *b, double time);
+
+        /**
+         * Writes all pending blocks and the incomplete last block and closes the file.
+         *
+         * @return False if the writer has failed, see hasFailed()
+         */
+        bool close();
+
+        unsigned int getNumberOfGauges() const {
+            return m_cells.size();
+        }
+
+        /** @return The number of samples taken so far */
+        unsigned long getNumberOfSamples() const {
+            return m_numberOfSamples;
+        }
+
+    private:
+
+        /** Main loop of the I/O thread */
+        void writeBlocks();
+
+        /** Writes the first sampleCount samples of a block, nothing after a failure */
+        void writeBlock(unsigned long block, unsigned int sampleCount);
+
+        /**
+         * Writes to the file and records a failure.
+         *
+         * @return False if the write failed
+         */
+        bool writeToFile(const void *data, std::size_t size, std::size_t count);
+
+        std::FILE *m_file;
+        unsigned int m_blockLength;
+        unsigned int m_numberOfBlocks;
+
+        /** Left cell of every gauge, including the ghost cell */
+        std::vector<unsigned int> m_cells;
+        /** Weight of the right cell of every gauge */
+        std::vector<T> m_weights;
+
+        /** The ring buffers: per block the series of blockLength values of every gauge and field */
+        std::vector<T> m_samples;
+        /** Distance between two series in the ring buffers, an odd number of cache lines */
+        std::size_t m_seriesStride;
+        std::vector<double> m_times;
+        unsigned long m_numberOfSamples;
+
+        /** Blocks which are complete, including the ones already written */
+        unsigned long m_completedBlocks;
+        /** Blocks which are written and can be filled again */
+        unsigned long m_writtenBlocks;
+        bool m_closing;
+        /** Set by the I/O thread or close() if a write fails */
+        std::atomic<bool> m_failed;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_thread;
+    };
+
+}
+
+#endif	/* _GAUGEWRITER_H */
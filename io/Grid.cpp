@@ -0,0 +1,256 @@
+/*
+ * File:   Grid.cpp
+ *
+ * Memory-mapped bathymetry and displacement grids.
+ */
+
+#include "Grid.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    /** Writes the whole buffer, retrying on partial writes */
+    bool writeAll(int file, const void *data, std::size_t length) {
+        const char *buffer = static_cast<const char*> (data);
+        while (length > 0) {
+            ssize_t written = ::write(file, buffer, length);
+            if (written <= 0)
+                return false;
+            buffer += written;
+            length -= written;
+        }
+        return true;
+    }
+
+    /** An opened ESRI ASCII grid whose header has been parsed */
+    struct AsciiGrid {
+        std::FILE *file;
+        unsigned long ncols;
+        unsigned long nrows;
+        /** Position of the south west node */
+        double originX;
+        double originY;
+        double cellSize;
+        bool hasNoData;
+        double noData;
+        /** The first value of the grid, which was read while looking for the optional header lines */
+        double firstValue;
+    };
+
+    /**
+     * Opens an ASCII grid and parses its header.
+     *
+     * @return False if the file could not be opened or the header is incomplete
+     */
+    bool openAsciiGrid(const std::string &fileName, AsciiGrid &grid) {
+        grid.file = std::fopen(fileName.c_str(), "r");
+        if (!grid.file) {
+            std::cerr << "Could not open ASCII grid " << fileName << std::endl;
+            return false;
+        }
+        grid.ncols = grid.nrows = 0;
+        grid.cellSize = 0;
+        grid.hasNoData = false;
+        bool cornerX = true, cornerY = true, hasX = false, hasY = false;
+        char key[64];
+        while (std::fscanf(grid.file, "%63s", key) == 1) {
+            for (char *c = key; *c; c++)
+                *c = std::tolower(*c);
+            // the first token which is no keyword is the first value
+            char *end;
+            double value = std::strtod(key, &end);
+            if (*end == '\0' && end != key) {
+                grid.firstValue = value;
+                if (grid.ncols > 0 && grid.nrows > 0 && grid.cellSize > 0 && hasX && hasY) {
+                    // the values belong to the centers of the cells
+                    grid.originX += cornerX ? grid.cellSize / 2 : 0;
+                    grid.originY += cornerY ? grid.cellSize / 2 : 0;
+                    return true;
+                }
+                break;
+            }
+            if (std::fscanf(grid.file, "%lf", &value) != 1)
+                break;
+            if (std::strcmp(key, "ncols") == 0)
+                grid.ncols = value;
+            else if (std::strcmp(key, "nrows") == 0)
+                grid.nrows = value;
+            else if (std::strcmp(key, "xllcorner") == 0 || std::strcmp(key, "xllcenter") == 0) {
+                grid.originX = value;
+                cornerX = key[4] == 'o';
+                hasX = true;
+            } else if (std::strcmp(key, "yllcorner") == 0 || std::strcmp(key, "yllcenter") == 0) {
+                grid.originY = value;
+                cornerY = key[4] == 'o';
+                hasY = true;
+            } else if (std::strcmp(key, "cellsize") == 0)
+                grid.cellSize = value;
+            else if (std::strcmp(key, "nodata_value") == 0) {
+                grid.noData = value;
+                grid.hasNoData = true;
+            }
+        }
+        std::cerr << "Invalid ASCII grid header in " << fileName << std::endl;
+        std::fclose(grid.file);
+        return false;
+    }
+
+    /**
+     * Parses the values of an ASCII grid into a field of the grid file.
+     * The ASCII rows go from north to south, the rows of the field from south to north.
+     */
+    bool readAsciiValues(AsciiGrid &grid, float *field) {
+        double value = grid.firstValue;
+        for (unsigned long row = 0; row < grid.nrows; row++) {
+            float *fieldRow = field + (grid.nrows - 1 - row) * grid.ncols;
+            for (unsigned long i = 0; i < grid.ncols; i++) {
+                if ((row > 0 || i > 0) && std::fscanf(grid.file, "%lf", &value) != 1)
+                    return false;
+                fieldRow[i] = grid.hasNoData && value == grid.noData ? 0 : value;
+            }
+        }
+        return true;
+    }
+
+}
+
+io::GridReader::GridReader(const std::string &fileName)
+    : m_mapping(MAP_FAILED), m_length(0), m_header(0)
+{
+    m_fields[0] = m_fields[1] = 0;
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Could not open grid file " << fileName << std::endl;
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) GRID_ALIGNMENT) {
+        m_length = status.st_size;
+        m_mapping = mmap(0, m_length, PROT_READ, MAP_SHARED, file, 0);
+    }
+    close(file);
+    if (m_mapping == MAP_FAILED) {
+        std::cerr << "Could not map grid file " << fileName << std::endl;
+        return;
+    }
+
+    const GridHeader *header = static_cast<const GridHeader*> (m_mapping);
+    if (std::memcmp(header->magic, "SWEGRID", 8) != 0 || header->version != GRID_VERSION
+            || (header->bytesPerValue != sizeof(float) && header->bytesPerValue != sizeof(double))
+            || header->nx == 0 || header->ny == 0 || header->numberOfFields < 1 || header->numberOfFields > 2
+            || gridFieldOffset(header->nx, header->ny, header->bytesPerValue, header->numberOfFields) > m_length) {
+        std::cerr << "Invalid grid file " << fileName << std::endl;
+        return;
+    }
+    m_header = header;
+    for (unsigned int field = 0; field < header->numberOfFields; field++)
+        m_fields[field] = static_cast<const char*> (m_mapping) + gridFieldOffset(header->nx, header->ny, header->bytesPerValue, field);
+}
+
+io::GridReader::~GridReader() {
+    if (m_mapping != MAP_FAILED)
+        munmap(m_mapping, m_length);
+}
+
+bool io::writeGrid(const std::string &fileName, unsigned long nx, unsigned long ny, double originX, double originY,
+        double dx, double dy, const T *bathymetry, const T *displacement) {
+    std::vector<char> header(GRID_ALIGNMENT, 0);
+    GridHeader *gridHeader = reinterpret_cast<GridHeader*> (&header[0]);
+    std::memcpy(gridHeader->magic, "SWEGRID", 8);
+    gridHeader->version = GRID_VERSION;
+    gridHeader->bytesPerValue = sizeof(T);
+    gridHeader->nx = nx;
+    gridHeader->ny = ny;
+    gridHeader->originX = originX;
+    gridHeader->originY = originY;
+    gridHeader->dx = dx;
+    gridHeader->dy = dy;
+    gridHeader->numberOfFields = displacement ? 2 : 1;
+
+    int file = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        std::cerr << "Could not create grid file " << fileName << std::endl;
+        return false;
+    }
+    bool success = writeAll(file, &header[0], header.size());
+    const T *fields[2] = {bathymetry, displacement};
+    std::vector<char> padding(GRID_ALIGNMENT, 0);
+    for (unsigned int field = 0; success && field < gridHeader->numberOfFields; field++) {
+        std::size_t fieldLength = nx * ny * sizeof(T);
+        std::size_t paddedLength = gridFieldOffset(nx, ny, sizeof(T), field + 1) - gridFieldOffset(nx, ny, sizeof(T), field);
+        success = writeAll(file, fields[field], fieldLength) && writeAll(file, &padding[0], paddedLength - fieldLength);
+    }
+    success = close(file) == 0 && success;
+    if (!success) {
+        std::cerr << "Could not write grid file " << fileName << std::endl;
+        std::remove(fileName.c_str());
+    }
+    return success;
+}
+
+bool io::importAsciiGrid(const std::string &bathymetryFile, const std::string &displacementFile, const std::string &gridFile) {
+    AsciiGrid grids[2];
+    unsigned int numberOfFields = displacementFile.empty() ? 1 : 2;
+    if (!openAsciiGrid(bathymetryFile, grids[0]))
+        return false;
+    if (numberOfFields == 2) {
+        if (!openAsciiGrid(displacementFile, grids[1])) {
+            std::fclose(grids[0].file);
+            return false;
+        }
+        if (grids[1].ncols != grids[0].ncols || grids[1].nrows != grids[0].nrows) {
+            std::cerr << "The ASCII grids " << bathymetryFile << " and " << displacementFile << " differ in size" << std::endl;
+            std::fclose(grids[0].file);
+            std::fclose(grids[1].file);
+            return false;
+        }
+    }
+
+    const unsigned long nx = grids[0].ncols, ny = grids[0].nrows;
+    std::size_t length = gridFieldOffset(nx, ny, sizeof(float), numberOfFields);
+    void *mapping = MAP_FAILED;
+    int file = open(gridFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file >= 0 && ftruncate(file, length) == 0)
+        mapping = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+    bool success = mapping != MAP_FAILED;
+    if (success) {
+        GridHeader *header = static_cast<GridHeader*> (mapping);
+        std::memcpy(header->magic, "SWEGRID", 8);
+        header->version = GRID_VERSION;
+        header->bytesPerValue = sizeof(float);
+        header->nx = nx;
+        header->ny = ny;
+        header->originX = grids[0].originX;
+        header->originY = grids[0].originY;
+        header->dx = header->dy = grids[0].cellSize;
+        header->numberOfFields = numberOfFields;
+        for (unsigned int field = 0; success && field < numberOfFields; field++) {
+            float *values = reinterpret_cast<float*> (static_cast<char*> (mapping) + gridFieldOffset(nx, ny, sizeof(float), field));
+            success = readAsciiValues(grids[field], values);
+            if (!success)
+                std::cerr << "Invalid ASCII grid " << (field == 0 ? bathymetryFile : displacementFile) << std::endl;
+        }
+        munmap(mapping, length);
+    }
+    for (unsigned int field = 0; field < numberOfFields; field++)
+        std::fclose(grids[field].file);
+    if (file >= 0)
+        success = close(file) == 0 && success;
+    if (!success) {
+        std::cerr << "Could not import the ASCII grid into " << gridFile << std::endl;
+        std::remove(gridFile.c_str());
+    }
+    return success;
+}
@@ -0,0 +1,159 @@
+/*
+ * File:   Grid.h
+ *
+ * Memory-mapped bathymetry and displacement grids.
+ */
+
+#ifndef _GRID_H
+#define	_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "../types.h"
+#include "GridFormat.h"
+
+namespace io {
+
+    /**
+     * Maps a grid file read-only.
+     *
+     * The values are read directly from the mapping, so only the pages of the nodes which are
+     * actually sampled are read from the disk. Resampling a multi-GB grid to a coarse simulation
+     * therefore touches only a small part of the file.
+     */
+    class GridReader {
+    public:
+
+        enum Field {
+            BATHYMETRY = 0,
+            DISPLACEMENT = 1
+        };
+
+        /**
+         * Maps the file and checks the header.
+         *
+         * @param [in] fileName The name of the file
+         */
+        GridReader(const std::string &fileName);
+
+        ~GridReader();
+
+        /** @return False if the file could not be mapped or is no grid file */
+        bool isValid() const {
+            return m_header != 0;
+        }
+
+        unsigned long getNx() const {
+            return m_header->nx;
+        }
+
+        unsigned long getNy() const {
+            return m_header->ny;
+        }
+
+        double getOriginX() const {
+            return m_header->originX;
+        }
+
+        double getOriginY() const {
+            return m_header->originY;
+        }
+
+        double getDx() const {
+            return m_header->dx;
+        }
+
+        double getDy() const {
+            return m_header->dy;
+        }
+
+        bool hasDisplacement() const {
+            return m_header->numberOfFields == 2;
+        }
+
+        /**
+         * @param [in] field The field
+         * @param [in] i The column of the node
+         * @param [in] j The row of the node
+         * @return The value of the node, 0 for the displacement if the file contains none
+         */
+        double getValue(Field field, unsigned long i, unsigned long j) const {
+            if ((unsigned int) field >= m_header->numberOfFields)
+                return 0;
+            unsigned long index = j * m_header->nx + i;
+            if (m_header->bytesPerValue == sizeof(float))
+                return static_cast<const float*> (m_fields[field])[index];
+            return static_cast<const double*> (m_fields[field])[index];
+        }
+
+        /**
+         * Interpolates a field bilinearly. Positions outside of the grid are clamped to its boundary.
+         *
+         * @param [in] field The field
+         * @param [in] x The x coordinate
+         * @param [in] y The y coordinate
+         * @return The interpolated value
+         */
+        double sample(Field field, double x, double y) const {
+            unsigned long i, j;
+            double wx, wy;
+            locate((x - m_header->originX) / m_header->dx, m_header->nx, i, wx);
+            locate((y - m_header->originY) / m_header->dy, m_header->ny, j, wy);
+            unsigned long i1 = std::min<unsigned long>(i + 1, m_header->nx - 1);
+            unsigned long j1 = std::min<unsigned long>(j + 1, m_header->ny - 1);
+            double south = (1 - wx) * getValue(field, i, j) + wx * getValue(field, i1, j);
+            double north = (1 - wx) * getValue(field, i, j1) + wx * getValue(field, i1, j1);
+            return (1 - wy) * south + wy * north;
+        }
+
+    private:
+
+        /** Splits a grid coordinate into the index of the node to the left and the interpolation weight */
+        static void locate(double coordinate, unsigned long n, unsigned long &index, double &weight) {
+            coordinate = std::min(std::max(coordinate, 0.), (double) (n - 1));
+            index = std::min<unsigned long>(std::floor(coordinate), n > 1 ? n - 2 : 0);
+            weight = coordinate - index;
+        }
+
+        void *m_mapping;
+        std::size_t m_length;
+        const GridHeader *m_header;
+        const void *m_fields[2];
+    };
+
+    /**
+     * Writes a grid file.
+     *
+     * @param [in] fileName The name of the file
+     * @param [in] nx The number of nodes in x direction
+     * @param [in] ny The number of nodes in y direction
+     * @param [in] originX The x coordinate of the node (0, 0)
+     * @param [in] originY The y coordinate of the node (0, 0)
+     * @param [in] dx The distance of the nodes in x direction
+     * @param [in] dy The distance of the nodes in y direction
+     * @param [in] bathymetry The bathymetry, row by row from south to north
+     * @param [in] displacement The displacement, row by row from south to north, or NULL
+     * @return False if the file could not be written
+     */
+    bool writeGrid(const std::string &fileName, unsigned long nx, unsigned long ny, double originX, double originY,
+            double dx, double dy, const T *bathymetry, const T *displacement = 0);
+
+    /**
+     * Converts ESRI ASCII grids (ncols, nrows, xllcorner or xllcenter, yllcorner or yllcenter, cellsize
+     * and an optional NODATA_value, followed by the rows from north to south) to a grid file with float values.
+     * The values are parsed directly into a mapping of the new file, so the whole grid is never held in
+     * heap memory. NODATA values are replaced by 0.
+     *
+     * @param [in] bathymetryFile The ASCII grid of the bathymetry
+     * @param [in] displacementFile The ASCII grid of the displacement with the same dimensions, or an empty string
+     * @param [in] gridFile The name of the new grid file
+     * @return False if an ASCII grid could not be parsed or the grid file could not be written
+     */
+    bool importAsciiGrid(const std::string &bathymetryFile, const std::string &displacementFile, const std::string &gridFile);
+
+}
+
+#endif	/* _GRID_H */
@@ -0,0 +1,52 @@
+/*
+ * File:   GridFormat.h
+ *
+ * Layout of the binary bathymetry and displacement grid files.
+ */
+
+#ifndef _GRIDFORMAT_H
+#define	_GRIDFORMAT_H
+
+#include <stdint.h>
+
+namespace io {
+
+    /**
+     * A grid file consists of one GridHeader followed by the fields bathymetry (and displacement) with
+     * nx * ny values each. The values of a field are stored row by row from south to north, so the
+     * value of the node (i, j) at the position (originX + i * dx, originY + j * dy) is value j * nx + i.
+     * Every field starts at a multiple of GRID_ALIGNMENT bytes. Values are float or double in the native
+     * byte order, the bathymetry is the elevation of the ground (negative below the sea level) and the
+     * displacement is the initial elevation of the sea surface.
+     */
+    const unsigned int GRID_ALIGNMENT = 4096;
+
+    /** Version of the file format, incremented on incompatible changes */
+    const uint32_t GRID_VERSION = 1;
+
+    struct GridHeader {
+        /** "SWEGRID" */
+        char magic[8];
+        uint32_t version;
+        /** 4 (float) or 8 (double) */
+        uint32_t bytesPerValue;
+        uint64_t nx;
+        uint64_t ny;
+        double originX;
+        double originY;
+        double dx;
+        double dy;
+        /** 1 (bathymetry) or 2 (bathymetry, displacement) */
+        uint32_t numberOfFields;
+        uint32_t reserved;
+    };
+
+    /** @return The offset of a field from the beginning of the file */
+    inline uint64_t gridFieldOffset(uint64_t nx, uint64_t ny, uint32_t bytesPerValue, unsigned int field) {
+        uint64_t fieldSize = (nx * ny * bytesPerValue + GRID_ALIGNMENT - 1) / GRID_ALIGNMENT * GRID_ALIGNMENT;
+        return GRID_ALIGNMENT + field * fieldSize;
+    }
+
+}
+
+#endif	/* _GRIDFORMAT_H */
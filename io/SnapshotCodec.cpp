@@ -0,0 +1,258 @@
+/*
+ * File:   SnapshotCodec.cpp
+ *
+ * Encoding of blocks of a field for the compressed snapshot files.
+ */
+
+#include "SnapshotCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+    /** The frequencies of the rANS coder sum up to 2^SCALE_BITS */
+    const unsigned int SCALE_BITS = 12;
+    const uint32_t SCALE = 1u << SCALE_BITS;
+    /** Lower bound of the coder state, it is renormalized byte by byte */
+    const uint32_t LOWER_BOUND = 1u << 23;
+
+    /** Stream modes of encodeBytes() */
+    const unsigned char RAW = 0;
+    const unsigned char CONSTANT = 1;
+    const unsigned char RANS = 2;
+
+    /**
+     * Scales the counts of the symbols to frequencies which sum up to SCALE,
+     * every symbol which occurs keeps a frequency of at least 1.
+     */
+    void normalize(const uint32_t *counts, std::size_t total, uint32_t *frequencies) {
+        uint32_t sum = 0;
+        unsigned int largest = 0;
+        for (unsigned int symbol = 0; symbol < 256; symbol++) {
+            frequencies[symbol] = counts[symbol] ? std::max<uint32_t>(1, (uint64_t) counts[symbol] * SCALE / total) : 0;
+            sum += frequencies[symbol];
+            if (frequencies[symbol] > frequencies[largest])
+                largest = symbol;
+        }
+        if (sum < SCALE)
+            frequencies[largest] += SCALE - sum;
+        // the rare symbols which were rounded up to 1 are taken from the most frequent ones
+        while (sum > SCALE) {
+            for (unsigned int symbol = 0; symbol < 256; symbol++)
+                if (frequencies[symbol] > frequencies[largest])
+                    largest = symbol;
+            uint32_t decrement = std::min(sum - SCALE, frequencies[largest] / 2);
+            frequencies[largest] -= decrement;
+            sum -= decrement;
+        }
+    }
+
+    uint64_t wordMask(unsigned int wordSize) {
+        return wordSize == sizeof(uint64_t) ? ~(uint64_t) 0 : ((uint64_t) 1 << (8 * wordSize)) - 1;
+    }
+
+}
+
+uint64_t io::SnapshotCodec::toInteger(T value, double step) const {
+    if (m_lossy)
+        return (uint64_t) std::llround(value / step);
+    uint64_t integer = 0;
+    std::memcpy(&integer, &value, sizeof(T));
+    return integer;
+}
+
+T io::SnapshotCodec::toValue(uint64_t integer, double step) const {
+    if (m_lossy)
+        return (int64_t) integer * step;
+    T value;
+    std::memcpy(&value, &integer, sizeof(T));
+    return value;
+}
+
+void io::SnapshotCodec::encode(const T *values, const T *previous, std::size_t count, double tolerance,
+        std::vector<unsigned char> &out) {
+    const unsigned int size = wordSize();
+    const unsigned int shift = 64 - 8 * size;
+    const uint64_t mask = wordMask(size);
+    const double step = 2 * tolerance;
+    m_planes.resize(count * size);
+    unsigned char *planes = m_planes.data();
+
+    uint64_t reference = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        uint64_t integer = toInteger(values[i], step);
+        if (previous)
+            reference = toInteger(previous[i], step);
+        // the difference modulo 2^(8 size) as a signed number, zigzag encoded
+        int64_t difference = (int64_t) (((integer - reference) & mask) << shift) >> shift;
+        uint64_t word = ((uint64_t) difference << 1) ^ (uint64_t) (difference >> 63);
+        for (unsigned int byte = 0; byte < size; byte++)
+            planes[byte * count + i] = (unsigned char) (word >> (8 * byte));
+        reference = integer;
+    }
+    for (unsigned int byte = 0; byte < size; byte++)
+        encodeBytes(planes + byte * count, count, out);
+}
+
+bool io::SnapshotCodec::decode(const unsigned char *in, std::size_t size, std::size_t count, double tolerance, bool keyframe,
+        uint64_t *reference, T *values) {
+    const unsigned int bytes = wordSize();
+    const uint64_t mask = wordMask(bytes);
+    const double step = 2 * tolerance;
+    m_planes.resize(count * bytes);
+    unsigned char *planes = m_planes.data();
+
+    const unsigned char *end = in + size;
+    for (unsigned int byte = 0; byte < bytes; byte++) {
+        in = decodeBytes(in, end, count, planes + byte * count);
+        if (!in)
+            return false;
+    }
+
+    uint64_t previous = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        uint64_t word = 0;
+        for (unsigned int byte = 0; byte < bytes; byte++)
+            word |= (uint64_t) planes[byte * count + i] << (8 * byte);
+        uint64_t difference = (word >> 1) ^ (~(word & 1) + 1);
+        if (!keyframe)
+            previous = reference[i];
+        uint64_t integer = (previous + difference) & mask;
+        reference[i] = integer;
+        values[i] = toValue(integer, step);
+        previous = integer;
+    }
+    return true;
+}
+
+void io::SnapshotCodec::encodeBytes(const unsigned char *in, std::size_t count, std::vector<unsigned char> &out) {
+    if (count == 0)
+        return;
+    uint32_t counts[256] = {0};
+    for (std::size_t i = 0; i < count; i++)
+        counts[in[i]]++;
+    if (counts[in[0]] == count) {
+        out.push_back(CONSTANT);
+        out.push_back(in[0]);
+        return;
+    }
+
+    uint32_t frequencies[256], starts[256];
+    normalize(counts, count, frequencies);
+    unsigned int numberOfSymbols = 0;
+    for (unsigned int symbol = 0, start = 0; symbol < 256; symbol++) {
+        starts[symbol] = start;
+        start += frequencies[symbol];
+        numberOfSymbols += frequencies[symbol] > 0;
+    }
+
+    // a symbol takes at most SCALE_BITS bits, the symbols are encoded backwards so the decoder reads forwards
+    m_stream.resize(2 * count + 8);
+    unsigned char *end = m_stream.data() + m_stream.size();
+    unsigned char *pointer = end;
+    uint32_t state = LOWER_BOUND;
+    for (std::size_t i = count; i-- > 0;) {
+        uint32_t frequency = frequencies[in[i]];
+        uint32_t maxState = ((LOWER_BOUND >> SCALE_BITS) << 8) * frequency;
+        while (state >= maxState) {
+            *--pointer = (unsigned char) state;
+            state >>= 8;
+        }
+        state = ((state / frequency) << SCALE_BITS) + state % frequency + starts[in[i]];
+    }
+    pointer -= 4;
+    for (unsigned int byte = 0; byte < 4; byte++)
+        pointer[byte] = (unsigned char) (state >> (8 * byte));
+    uint32_t streamSize = end - pointer;
+
+    if (32 + 2 * numberOfSymbols + 4 + streamSize >= count) {
+        out.push_back(RAW);
+        out.insert(out.end(), in, in + count);
+        return;
+    }
+    out.push_back(RANS);
+    unsigned char present[32] = {0};
+    for (unsigned int symbol = 0; symbol < 256; symbol++)
+        if (frequencies[symbol])
+            present[symbol / 8] |= 1 << (symbol % 8);
+    out.insert(out.end(), present, present + 32);
+    for (unsigned int symbol = 0; symbol < 256; symbol++)
+        if (frequencies[symbol]) {
+            // the frequencies are at most SCALE, so 16 bits are enough
+            out.push_back((unsigned char) frequencies[symbol]);
+            out.push_back((unsigned char) (frequencies[symbol] >> 8));
+        }
+    for (unsigned int byte = 0; byte < 4; byte++)
+        out.push_back((unsigned char) (streamSize >> (8 * byte)));
+    out.insert(out.end(), pointer, end);
+}
+
+const unsigned char *io::SnapshotCodec::decodeBytes(const unsigned char *in, const unsigned char *end, std::size_t count,
+        unsigned char *out) {
+    if (count == 0)
+        return in;
+    if (in >= end)
+        return 0;
+    switch (*in++) {
+        case RAW:
+            if ((std::size_t) (end - in) < count)
+                return 0;
+            std::memcpy(out, in, count);
+            return in + count;
+        case CONSTANT:
+            if (in >= end)
+                return 0;
+            std::memset(out, *in, count);
+            return in + 1;
+        case RANS:
+            break;
+        default:
+            return 0;
+    }
+
+    if (end - in < 32)
+        return 0;
+    const unsigned char *present = in;
+    in += 32;
+    uint32_t frequencies[256], starts[256];
+    unsigned char symbols[SCALE];
+    uint32_t start = 0;
+    for (unsigned int symbol = 0; symbol < 256; symbol++) {
+        frequencies[symbol] = 0;
+        if (present[symbol / 8] & (1 << (symbol % 8))) {
+            if (end - in < 2)
+                return 0;
+            frequencies[symbol] = in[0] | (in[1] << 8);
+            in += 2;
+        }
+        starts[symbol] = start;
+        if (frequencies[symbol] > SCALE - start)
+            return 0;
+        std::memset(symbols + start, symbol, frequencies[symbol]);
+        start += frequencies[symbol];
+    }
+    if (start != SCALE || end - in < 4)
+        return 0;
+    uint32_t streamSize = in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t) in[3] << 24);
+    in += 4;
+    if ((std::size_t) (end - in) < streamSize || streamSize < 4)
+        return 0;
+    const unsigned char *streamEnd = in + streamSize;
+
+    uint32_t state = in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t) in[3] << 24);
+    in += 4;
+    for (std::size_t i = 0; i < count; i++) {
+        uint32_t slot = state & (SCALE - 1);
+        unsigned char symbol = symbols[slot];
+        out[i] = symbol;
+        state = frequencies[symbol] * (state >> SCALE_BITS) + slot - starts[symbol];
+        while (state < LOWER_BOUND) {
+            if (in >= streamEnd)
+                return 0;
+            state = (state << 8) | *in++;
+        }
+    }
+    return streamEnd;
+}
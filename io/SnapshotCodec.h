@@ -0,0 +1,105 @@
+/*
+ * File:   SnapshotCodec.h
+ *
+ * Encoding of blocks of a field for the compressed snapshot files.
+ */
+
+#ifndef _SNAPSHOTCODEC_H
+#define	_SNAPSHOTCODEC_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "../types.h"
+
+namespace io {
+
+    /**
+     * Encodes the values of a block of cells in four steps:
+     * <ol>
+     *  <li>Every value is mapped to an integer: its bit pattern in the lossless mode or the value divided by
+     *      twice the tolerance and rounded in the lossy mode, so the error of the decoded values is at most the
+     *      tolerance (plus the rounding to T).</li>
+     *  <li>The difference to the integer of the same cell in the previous snapshot is taken, or to the
+     *      previous cell in a keyframe. The differences are zigzag encoded, so small negative differences
+     *      become small positive numbers.</li>
+     *  <li>The bytes are shuffled: all lowest bytes first, then all second bytes and so on. Smooth fields
+     *      and cells which did not change give planes which are (almost) only zeros.</li>
+     *  <li>Every byte plane is entropy coded on its own by an order-0 rANS coder, a constant plane takes two
+     *      bytes and a plane which cannot be compressed is stored raw.</li>
+     * </ol>
+     *
+     * A codec keeps its scratch buffers between the calls and must not be shared between threads.
+     */
+    class SnapshotCodec {
+    public:
+
+        /**
+         * @param [in] lossy True for the error-bounded lossy mode
+         */
+        SnapshotCodec(bool lossy)
+            : m_lossy(lossy) {
+        }
+
+        /**
+         * Appends the encoded block to out.
+         *
+         * @param [in] values The values of the block
+         * @param [in] previous The values of the same cells in the previous snapshot or NULL for a keyframe
+         * @param [in] count The number of values
+         * @param [in] tolerance The maximum error in the lossy mode, ignored in the lossless mode
+         * @param [in,out] out The buffer to which the encoded block is appended
+         */
+        void encode(const T *values, const T *previous, std::size_t count, double tolerance, std::vector<unsigned char> &out);
+
+        /**
+         * Decodes a block.
+         *
+         * @param [in] in The encoded block
+         * @param [in] size The number of bytes of the encoded block
+         * @param [in] count The number of values
+         * @param [in] tolerance The tolerance which was used by encode()
+         * @param [in] keyframe True if the block was encoded without the previous snapshot
+         * @param [in,out] reference The integers of the previous snapshot, replaced by the integers of this one
+         * @param [out] values The decoded values
+         * @return False if the block is corrupt
+         */
+        bool decode(const unsigned char *in, std::size_t size, std::size_t count, double tolerance, bool keyframe,
+                uint64_t *reference, T *values);
+
+        /**
+         * Entropy codes a byte stream and appends it to out.
+         */
+        void encodeBytes(const unsigned char *in, std::size_t count, std::vector<unsigned char> &out);
+
+        /**
+         * Decodes count bytes of a stream written by encodeBytes().
+         *
+         * @return The end of the stream or NULL if it is corrupt
+         */
+        static const unsigned char *decodeBytes(const unsigned char *in, const unsigned char *end, std::size_t count,
+                unsigned char *out);
+
+    private:
+
+        /** @return The number of bytes of the integers */
+        unsigned int wordSize() const {
+            return m_lossy ? sizeof(uint64_t) : sizeof(T);
+        }
+
+        /** @return The integer of a value */
+        uint64_t toInteger(T value, double step) const;
+
+        /** @return The value of an integer */
+        T toValue(uint64_t integer, double step) const;
+
+        bool m_lossy;
+
+        std::vector<unsigned char> m_planes;
+        std::vector<unsigned char> m_stream;
+    };
+
+}
+
+#endif	/* _SNAPSHOTCODEC_H */
@@ -0,0 +1,76 @@
+/*
+ * File:   SnapshotFormat.h
+ *
+ * Layout of the binary snapshot files.
+ */
+
+#ifndef _SNAPSHOTFORMAT_H
+#define	_SNAPSHOTFORMAT_H
+
+#include <stdint.h>
+
+namespace io {
+
+    /**
+     * A snapshot file is append-only and consists of
+     * <ul>
+     *  <li>one SnapshotFileHeader,</li>
+     *  <li>one chunk per snapshot: a SnapshotChunkHeader followed by the fields h, hu (and b) with
+     *      cellCount values each, padded to a multiple of SNAPSHOT_ALIGNMENT bytes,</li>
+     *  <li>the index: one SnapshotIndexEntry per chunk,</li>
+     *  <li>one SnapshotFileFooter at the very end of the file.</li>
+     * </ul>
+     * All headers are SNAPSHOT_ALIGNMENT bytes long, so the fields of a memory-mapped file are properly aligned.
+     * Values are stored in the native byte order.
+     */
+    const unsigned int SNAPSHOT_ALIGNMENT = 64;
+
+    /** Version of the file format, incremented on incompatible changes */
+    const uint32_t SNAPSHOT_VERSION = 1;
+
+    struct SnapshotFileHeader {
+        /** "SWESNAP" */
+        char magic[8];
+        uint32_t version;
+        /** sizeof(T) of the stored values */
+        uint32_t bytesPerValue;
+        uint64_t cellCount;
+        double cellSize;
+        /** 2 (h, hu) or 3 (h, hu, b) */
+        uint32_t numberOfFields;
+        char padding[SNAPSHOT_ALIGNMENT - 36];
+    };
+
+    struct SnapshotChunkHeader {
+        /** "CHUNK" */
+        char magic[8];
+        uint64_t step;
+        double time;
+        uint64_t cellCount;
+        char padding[SNAPSHOT_ALIGNMENT - 32];
+    };
+
+    struct SnapshotIndexEntry {
+        uint64_t step;
+        double time;
+        /** Offset of the SnapshotChunkHeader from the beginning of the file */
+        uint64_t offset;
+    };
+
+    struct SnapshotFileFooter {
+        uint64_t numberOfSnapshots;
+        /** Offset of the first SnapshotIndexEntry from the beginning of the file */
+        uint64_t indexOffset;
+        /** "SWEINDX" */
+        char magic[8];
+    };
+
+    /** @return The number of bytes of the fields of one chunk including the padding */
+    inline uint64_t snapshotPayloadSize(uint64_t cellCount, uint32_t numberOfFields, uint32_t bytesPerValue) {
+        uint64_t size = cellCount * numberOfFields * bytesPerValue;
+        return (size + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+    }
+
+}
+
+#endif	/* _SNAPSHOTFORMAT_H */
@@ -0,0 +1,73 @@
+/*
+ * File:   SnapshotReader.cpp
+ *
+ * Random access to the snapshots of a finished snapshot file.
+ */
+
+#include "SnapshotReader.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+io::SnapshotReader::SnapshotReader(const std::string &fileName)
+    : m_mapping(MAP_FAILED), m_length(0), m_header(0), m_index(0), m_footer(0)
+{
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Could not open snapshot file " << fileName << std::endl;
+        return;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) (sizeof(SnapshotFileHeader) + sizeof(SnapshotFileFooter))) {
+        m_length = status.st_size;
+        m_mapping = mmap(0, m_length, PROT_READ, MAP_SHARED, file, 0);
+    }
+    ::close(file);
+    if (m_mapping == MAP_FAILED) {
+        std::cerr << "Could not map snapshot file " << fileName << std::endl;
+        return;
+    }
+
+    const char *begin = static_cast<const char*> (m_mapping);
+    const SnapshotFileHeader *header = reinterpret_cast<const SnapshotFileHeader*> (begin);
+    const SnapshotFileFooter *footer = reinterpret_cast<const SnapshotFileFooter*> (begin + m_length - sizeof(SnapshotFileFooter));
+    // a file without footer was not closed properly
+    if (std::memcmp(header->magic, "SWESNAP", 8) != 0 || header->version != SNAPSHOT_VERSION
+            || header->bytesPerValue != sizeof(T) || std::memcmp(footer->magic, "SWEINDX", 8) != 0
+            || footer->indexOffset + footer->numberOfSnapshots * sizeof(SnapshotIndexEntry) + sizeof(SnapshotFileFooter) != m_length) {
+        std::cerr << "Invalid snapshot file " << fileName << std::endl;
+        return;
+    }
+    m_header = header;
+    m_footer = footer;
+    m_index = reinterpret_cast<const SnapshotIndexEntry*> (begin + footer->indexOffset);
+}
+
+io::SnapshotReader::~SnapshotReader() {
+    if (m_mapping != MAP_FAILED)
+        munmap(m_mapping, m_length);
+}
+
+unsigned long io::SnapshotReader::findSnapshot(double time) const {
+    // the snapshots are sorted by time, find the last one with a time <= the given time
+    unsigned long first = 0, count = getNumberOfSnapshots();
+    while (count > 0) {
+        unsigned long step = count / 2;
+        if (m_index[first + step].time <= time) {
+            first += step + 1;
+            count -= step + 1;
+        } else
+            count = step;
+    }
+    return first > 0 ? first - 1 : 0;
+}
+
+const T *io::SnapshotReader::getField(unsigned long snapshot, unsigned int field) const {
+    const char *chunk = static_cast<const char*> (m_mapping) + m_index[snapshot].offset;
+    return reinterpret_cast<const T*> (chunk + sizeof(SnapshotChunkHeader)) + field * m_header->cellCount;
+}
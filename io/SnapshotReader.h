@@ -0,0 +1,100 @@
+/*
+ * File:   SnapshotReader.h
+ *
+ * Random access to the snapshots of a finished snapshot file.
+ */
+
+#ifndef _SNAPSHOTREADER_H
+#define	_SNAPSHOTREADER_H
+
+#include <cstddef>
+#include <string>
+
+#include "../types.h"
+#include "SnapshotFormat.h"
+
+namespace io {
+
+    /**
+     * Memory-maps a snapshot file written by SnapshotWriter.
+     *
+     * The fields are returned as pointers into the mapping, so only the pages of the snapshots which
+     * are actually accessed are read from the disk.
+     */
+    class SnapshotReader {
+    public:
+
+        /**
+         * Maps the file and checks the header and the footer.
+         *
+         * @param [in] fileName The name of the file
+         */
+        SnapshotReader(const std::string &fileName);
+
+        ~SnapshotReader();
+
+        /** @return False if the file could not be mapped or is no complete snapshot file of type T */
+        bool isValid() const {
+            return m_header != 0;
+        }
+
+        unsigned long getNumberOfSnapshots() const {
+            return m_footer->numberOfSnapshots;
+        }
+
+        unsigned long getNumberOfCells() const {
+            return m_header->cellCount;
+        }
+
+        T getCellSize() const {
+            return m_header->cellSize;
+        }
+
+        bool hasBathymetry() const {
+            return m_header->numberOfFields == 3;
+        }
+
+        unsigned long getStep(unsigned long snapshot) const {
+            return m_index[snapshot].step;
+        }
+
+        double getTime(unsigned long snapshot) const {
+            return m_index[snapshot].time;
+        }
+
+        /** @return The heights of a snapshot */
+        const T *getHeight(unsigned long snapshot) const {
+            return getField(snapshot, 0);
+        }
+
+        /** @return The momentums of a snapshot */
+        const T *getMomentum(unsigned long snapshot) const {
+            return getField(snapshot, 1);
+        }
+
+        /** @return The bathymetry of a snapshot or NULL if the file contains no bathymetry */
+        const T *getBathymetry(unsigned long snapshot) const {
+            return hasBathymetry() ? getField(snapshot, 2) : 0;
+        }
+
+        /**
+         * @param [in] time A simulated time
+         * @return The last snapshot taken at or before the given time, 0 if there is none
+         */
+        unsigned long findSnapshot(double time) const;
+
+    private:
+
+        const T *getField(unsigned long snapshot, unsigned int field) const;
+
+        void *m_mapping;
+        std::size_t m_length;
+
+        const SnapshotFileHeader *m_header;
+        const SnapshotIndexEntry *m_index;
+        const SnapshotFileFooter *m_footer;
+    };
+
+}
+
+#endif	/* _SNAPSHOTREADER_H */
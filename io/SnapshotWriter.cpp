@@ -0,0 +1,153 @@
+/*
+ * File:   SnapshotWriter.cpp
+ *
+ * Asynchronous writer for time series of h, hu and the bathymetry.
+ */
+
+#include "SnapshotWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+io::SnapshotWriter::SnapshotWriter(const std::string &fileName, unsigned long size, T cellSize, bool withBathymetry,
+        unsigned int stepInterval, double timeInterval, unsigned int numberOfBuffers)
+    : m_size(size), m_numberOfFields(withBathymetry ? 3 : 2), m_stepInterval(stepInterval), m_timeInterval(timeInterval),
+      m_nextTime(0), m_numberOfSnapshots(0), m_offset(0), m_buffers(std::max(numberOfBuffers, 1u)), m_closing(false),
+      m_failed(false)
+{
+    m_file = std::fopen(fileName.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Could not create snapshot file " << fileName << std::endl;
+        m_failed = true;
+        return;
+    }
+
+    SnapshotFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SWESNAP", 8);
+    header.version = SNAPSHOT_VERSION;
+    header.bytesPerValue = sizeof(T);
+    header.cellCount = size;
+    header.cellSize = cellSize;
+    header.numberOfFields = m_numberOfFields;
+    writeToFile(&header, sizeof(header), 1);
+    m_offset = sizeof(header);
+
+    for (unsigned int i = 0; i < m_buffers.size(); i++) {
+        m_buffers[i].data.resize(m_numberOfFields * size);
+        m_freeBuffers.push_back(&m_buffers[i]);
+    }
+    m_thread = std::thread(&SnapshotWriter::writeBuffers, this);
+}
+
+io::SnapshotWriter::~SnapshotWriter() {
+    close();
+}
+
+bool io::SnapshotWriter::write(const T *h, const T *hu, const T *b, unsigned long step, double time) {
+    if (!isOpen())
+        return false;
+    bool stepReached = m_stepInterval > 0 && step % m_stepInterval == 0;
+    bool timeReached = m_timeInterval > 0 && time >= m_nextTime;
+    if (!stepReached && !timeReached)
+        return false;
+    if (timeReached)
+        m_nextTime = (std::floor(time / m_timeInterval) + 1) * m_timeInterval;
+
+    Buffer *buffer;
+    {
+        // back-pressure: wait until the I/O thread has released a buffer
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return !m_freeBuffers.empty(); });
+        buffer = m_freeBuffers.front();
+        m_freeBuffers.pop_front();
+    }
+
+    std::copy(h, h + m_size, buffer->data.begin());
+    std::copy(hu, hu + m_size, buffer->data.begin() + m_size);
+    if (m_numberOfFields == 3)
+        std::copy(b, b + m_size, buffer->data.begin() + 2 * m_size);
+    buffer->step = step;
+    buffer->time = time;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingBuffers.push_back(buffer);
+    }
+    m_condition.notify_all();
+    m_numberOfSnapshots++;
+    return true;
+}
+
+void io::SnapshotWriter::writeBuffers() {
+    static const char padding[SNAPSHOT_ALIGNMENT] = {0};
+    uint64_t payloadSize = snapshotPayloadSize(m_size, m_numberOfFields, sizeof(T));
+
+    for (;;) {
+        Buffer *buffer;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_closing || !m_pendingBuffers.empty(); });
+            if (m_pendingBuffers.empty())
+                return;
+            buffer = m_pendingBuffers.front();
+            m_pendingBuffers.pop_front();
+        }
+
+        // after a failure, the remaining snapshots are only released, so write() does not wait forever
+        if (!m_failed) {
+            SnapshotChunkHeader header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "CHUNK", 6);
+            header.step = buffer->step;
+            header.time = buffer->time;
+            header.cellCount = m_size;
+            if (writeToFile(&header, sizeof(header), 1) && writeToFile(&buffer->data[0], sizeof(T), buffer->data.size())
+                    && writeToFile(padding, 1, payloadSize - buffer->data.size() * sizeof(T))) {
+                SnapshotIndexEntry entry = {buffer->step, buffer->time, m_offset};
+                m_index.push_back(entry);
+                m_offset += sizeof(header) + payloadSize;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeBuffers.push_back(buffer);
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool io::SnapshotWriter::writeToFile(const void *data, std::size_t size, std::size_t count) {
+    if (std::fwrite(data, size, count, m_file) == count)
+        return true;
+    if (!m_failed.exchange(true))
+        std::cerr << "Could not write the snapshot file" << std::endl;
+    return false;
+}
+
+bool io::SnapshotWriter::close() {
+    if (!m_file)
+        return !m_failed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    SnapshotFileFooter footer;
+    std::memset(&footer, 0, sizeof(footer));
+    footer.numberOfSnapshots = m_index.size();
+    footer.indexOffset = m_offset;
+    std::memcpy(footer.magic, "SWEINDX", 8);
+    // a file with a failed write has no valid index
+    if (!m_failed && (m_index.empty() || writeToFile(&m_index[0], sizeof(SnapshotIndexEntry), m_index.size())))
+        writeToFile(&footer, sizeof(footer), 1);
+    if (std::fclose(m_file) != 0 && !m_failed.exchange(true))
+        std::cerr << "Could not write the snapshot file" << std::endl;
+    m_file = 0;
+    return !m_failed;
+}
@@ -0,0 +1,134 @@
+/*
+ * File:   SnapshotWriter.h
+ *
+ * Asynchronous writer for time series of h, hu and the bathymetry.
+ */
+
+#ifndef _SNAPSHOTWRITER_H
+#define	_SNAPSHOTWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../types.h"
+#include "SnapshotFormat.h"
+
+namespace io {
+
+    /**
+     * Writes snapshots of the unknowns to a file in the format described in SnapshotFormat.h without
+     * stalling the solver.
+     *
+     * write() only copies the fields into a free buffer and returns, a background thread writes the
+     * buffers to the file. If all buffers are still waiting for the I/O thread, write() blocks until one
+     * becomes free again (back-pressure), so the memory use is bounded by the number of buffers.
+     *
+     * If a write fails, e.g. on a full disk, the I/O thread stops writing and discards the pending snapshots.
+     * isOpen() becomes false, write() takes no more snapshots and close() reports the failure.
+     */
+    class SnapshotWriter {
+    public:
+
+        /**
+         * Creates the file and writes the file header.
+         *
+         * @param [in] fileName The name of the file
+         * @param [in] size The number of cells which are written per snapshot (usually without the ghost cells)
+         * @param [in] cellSize The size of one cell
+         * @param [in] withBathymetry True if the bathymetry is part of the snapshots
+         * @param [in] stepInterval A snapshot is written every stepInterval steps, 0 disables this criterion
+         * @param [in] timeInterval A snapshot is written every timeInterval seconds of simulated time, 0 disables this criterion
+         * @param [in] numberOfBuffers The number of snapshots which can be pending at the same time
+         */
+        SnapshotWriter(const std::string &fileName, unsigned long size, T cellSize, bool withBathymetry = false,
+                unsigned int stepInterval = 1, double timeInterval = 0, unsigned int numberOfBuffers = 2);
+
+        /** Waits for all pending snapshots and closes the file */
+        ~SnapshotWriter();
+
+        /** @return False if the file could not be created or written or is closed */
+        bool isOpen() const {
+            return m_file != 0 && !m_failed;
+        }
+
+        /** @return True if the file could not be created or a part of it could not be written */
+        bool hasFailed() const {
+            return m_failed;
+        }
+
+        /**
+         * Hands a snapshot to the I/O thread if the step or the time interval is reached.
+         *
+         * @param [in] h The heights of the size cells
+         * @param [in] hu The momentums of the size cells
+         * @param [in] b The bathymetry of the size cells, ignored if the writer was created without bathymetry
+         * @param [in] step The number of the time step
+         * @param [in] time The simulated time
+         * @return True if a snapshot was taken
+         */
+        bool write(const T *h, const T *hu, const T *b, unsigned long step, double time);
+
+        /**
+         * Waits for all pending snapshots, appends the index and closes the file.
+         *
+         * @return False if the file could not be created or any part of it could not be written
+         */
+        bool close();
+
+        /** @return The number of snapshots handed to the I/O thread so far */
+        unsigned long getNumberOfSnapshots() const {
+            return m_numberOfSnapshots;
+        }
+
+    private:
+
+        struct Buffer {
+            std::vector<T> data;
+            unsigned long step;
+            double time;
+        };
+
+        /** Main loop of the I/O thread */
+        void writeBuffers();
+
+        /**
+         * Writes to the file and records a failure.
+         *
+         * @return False if the write failed
+         */
+        bool writeToFile(const void *data, std::size_t size, std::size_t count);
+
+        std::FILE *m_file;
+        unsigned long m_size;
+        unsigned int m_numberOfFields;
+        unsigned int m_stepInterval;
+        double m_timeInterval;
+        double m_nextTime;
+        unsigned long m_numberOfSnapshots;
+
+        /** Current end of the file */
+        uint64_t m_offset;
+        std::vector<SnapshotIndexEntry> m_index;
+
+        std::vector<Buffer> m_buffers;
+        /** Buffers which can be filled by write() */
+        std::deque<Buffer*> m_freeBuffers;
+        /** Buffers which wait for the I/O thread */
+        std::deque<Buffer*> m_pendingBuffers;
+        bool m_closing;
+        /** Set by any thread which fails to write to the file */
+        std::atomic<bool> m_failed;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_thread;
+    };
+
+}
+
+#endif	/* _SNAPSHOTWRITER_H */
@@ -25,6 +25,27 @@ public:
      */
     ExtendedDamBreak(unsigned int size, const T hl, const T hr, const T hur) : Scenario(size, hl, hr, 0, hur) { }
 
+    const char *getName() const
+    {
+        return "ExtendedDamBreak";
+    }
+
+    unsigned int getParameters(double parameters[MAX_PARAMETERS]) const
+    {
+        parameters[0] = m_hl;
+        parameters[1] = m_hr;
+        parameters[2] = m_hur;
+        return 3;
+    }
+
+	// the fill of other storage types
+	using Scenario<T>::fill;
+
+	void fill(T *h, T *hu, T *b, unsigned int begin, unsigned int end)
+	{
+		fillPiecewise(h, hu, b, begin, end, m_hl, m_hr, 0, m_hur);
+	}
+
 	T getHeight(unsigned int pos)
 	{
 		if (pos <= m_size/2)
@@ -0,0 +1,135 @@
+#ifndef SCENARIOS_GRIDSCENARIO_H_
+#define SCENARIOS_GRIDSCENARIO_H_
+
+#include <algorithm>
+
+#include "scenario.h"
+#include "../io/Grid.h"
+
+namespace scenarios
+{
+
+/**
+ * A scenario which reads the bathymetry and the initial displacement of the sea surface from a
+ * memory-mapped grid file. The 1D domain is the transect through the grid along the x axis at a
+ * given y coordinate, it spans the whole grid in x direction.
+ *
+ * The grid is resampled lazily: every cell interpolates the nodes around its center when it is
+ * initialized, so only the pages of the two grid rows around the transect are read from the file.
+ * Cells whose ground lies below the sea level are filled up to the displaced sea surface, all
+ * other cells are dry.
+ */
+class GridScenario : public Scenario<T>
+{
+
+public:
+
+    /**
+     * Constructor which places the transect through the middle of the grid
+     * @param [in] grid The mapped grid, has to exist as long as the scenario
+     * @param [in] seaLevel The elevation of the sea surface at rest
+     */
+    GridScenario(const io::GridReader &grid, unsigned int size, const T seaLevel = 0) :
+        Scenario(size, seaLevel, seaLevel, 0, 0), m_grid(grid),
+        m_y(grid.getOriginY() + (grid.getNy() - 1) * grid.getDy() / 2) { }
+
+    /**
+     * Constructor which defines the transect
+     * @param [in] grid The mapped grid, has to exist as long as the scenario
+     * @param [in] y The y coordinate of the transect
+     * @param [in] seaLevel The elevation of the sea surface at rest
+     */
+    GridScenario(const io::GridReader &grid, unsigned int size, const double y, const T seaLevel) :
+        Scenario(size, seaLevel, seaLevel, 0, 0), m_grid(grid), m_y(y) { }
+
+    const char *getName() const
+    {
+        return "GridScenario";
+    }
+
+    /**
+     * The grid file itself cannot be stored, the parameters identify it by its geometry.
+     *
+     * @param [out] parameters y, seaLevel, the origin, the spacing and the number of nodes of the grid in x and y
+     */
+    unsigned int getParameters(double parameters[MAX_PARAMETERS]) const
+    {
+        parameters[0] = m_y;
+        parameters[1] = m_hl;
+        parameters[2] = m_grid.getOriginX();
+        parameters[3] = m_grid.getOriginY();
+        parameters[4] = m_grid.getDx();
+        parameters[5] = m_grid.getDy();
+        parameters[6] = m_grid.getNx();
+        parameters[7] = m_grid.getNy();
+        return 8;
+    }
+
+    // the fill of other storage types
+    using Scenario<T>::fill;
+
+    void fill(T *h, T *hu, T *b, unsigned int begin, unsigned int end)
+    {
+        const int numberOfChunks = end > begin ? (end - begin + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK : 0;
+#pragma omp parallel for schedule(static)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned int chunkBegin = begin + chunk * CELLS_PER_CHUNK;
+            unsigned int chunkEnd = std::min(chunkBegin + CELLS_PER_CHUNK, end);
+            for (unsigned int i = chunkBegin; i < chunkEnd; i++)
+            {
+                T bathymetry = getBathymetry(i);
+                h[i - begin] = getWaterHeight(i, bathymetry);
+                hu[i - begin] = 0;
+                if (b)
+                    b[i - begin] = bathymetry;
+            }
+        }
+    }
+
+    T getHeight(unsigned int pos)
+    {
+        return getWaterHeight(pos, getBathymetry(pos));
+    }
+
+    T getMomentum(unsigned int /*pos*/)
+    {
+        return 0;
+    }
+
+    T getBathymetry(unsigned int pos)
+    {
+        return m_grid.sample(io::GridReader::BATHYMETRY, getX(pos), m_y);
+    }
+
+    T getCellSize()
+    {
+        return (m_grid.getNx() - 1) * m_grid.getDx() / m_size;
+    }
+
+private:
+
+    /** @return The x coordinate of the center of a cell, the ghost cells lie outside of the grid and are clamped by the sampling */
+    double getX(unsigned int pos)
+    {
+        return m_grid.getOriginX() + ((double) pos - 0.5) * (m_grid.getNx() - 1) * m_grid.getDx() / m_size;
+    }
+
+    /** @return The water height of a cell with the given bathymetry */
+    T getWaterHeight(unsigned int pos, T bathymetry)
+    {
+        if (bathymetry >= m_hl)
+            return 0;
+        T displacement = m_grid.sample(io::GridReader::DISPLACEMENT, getX(pos), m_y);
+        return std::max<T>(m_hl + displacement - bathymetry, 0);
+    }
+
+    const io::GridReader &m_grid;
+
+    /** The y coordinate of the transect */
+    const double m_y;
+};
+
+}
+
+#endif /* SCENARIOS_GRIDSCENARIO_H_ */
@@ -0,0 +1,78 @@
+#ifndef SCENARIOS_RADIALDAMBREAK_H_
+#define SCENARIOS_RADIALDAMBREAK_H_
+
+#include "scenario.h"
+
+namespace scenarios
+{
+
+/**
+ * A column of water in the middle of the domain which collapses at the beginning of the simulation.
+ * On a 1D grid the column is a dam in the middle, on a 2D grid of size x size cells it is a cylinder.
+ */
+class RadialDamBreak : public Scenario<T>
+{
+
+public:
+
+    /**
+     * Constructor which will initialize the vector components using some default values.
+     */
+    RadialDamBreak(unsigned int size) : Scenario(size, 15, 10, 0, 0) { }
+
+    /**
+     * Constructor which defines the heights
+     * @param [in] hInside The height of the water column
+     * @param [in] hOutside The height of the water surrounding the column
+     */
+    RadialDamBreak(unsigned int size, const T hInside, const T hOutside) : Scenario(size, hInside, hOutside, 0, 0) { }
+
+    const char *getName() const
+    {
+        return "RadialDamBreak";
+    }
+
+    unsigned int getParameters(double parameters[MAX_PARAMETERS]) const
+    {
+        parameters[0] = m_hl;
+        parameters[1] = m_hr;
+        return 2;
+    }
+
+    T getHeight(unsigned int pos)
+    {
+        return isInside(pos, m_size / 2) ? m_hl : m_hr;
+    }
+
+    T getMomentum(unsigned int /*pos*/)
+    {
+        return 0;
+    }
+
+    T getHeight(unsigned int x, unsigned int y)
+    {
+        return isInside(x, y) ? m_hl : m_hr;
+    }
+
+    T getMomentumX(unsigned int /*x*/, unsigned int /*y*/)
+    {
+        return 0;
+    }
+
+private:
+
+    /**
+     * @return True if the position lies within a radius of size/8 cells around the center of the domain
+     */
+    bool isInside(unsigned int x, unsigned int y)
+    {
+        T dx = (T) x - (T) m_size / 2;
+        T dy = (T) y - (T) m_size / 2;
+        T radius = (T) m_size / 8;
+        return dx * dx + dy * dy < radius * radius;
+    }
+};
+
+}
+
+#endif /* SCENARIOS_RADIALDAMBREAK_H_ */
@@ -26,6 +26,26 @@ public:
     RareRare(unsigned int size, const T h, const T hu) :
         Scenario(size, h, h, hu >= 0 ? -hu : hu, hu >= 0 ? hu : -hu) { }
 
+    const char *getName() const
+    {
+        return "RareRare";
+    }
+
+    unsigned int getParameters(double parameters[MAX_PARAMETERS]) const
+    {
+        parameters[0] = m_hl;
+        parameters[1] = m_hur;
+        return 2;
+    }
+
+    // the fill of other storage types
+    using Scenario<T>::fill;
+
+    void fill(T *h, T *hu, T *b, unsigned int begin, unsigned int end)
+    {
+        fillPiecewise(h, hu, b, begin, end, m_hl, m_hr, m_hul, m_hur);
+    }
+
     T getHeight(unsigned int pos)
     {
         return m_hl;
@@ -1,6 +1,8 @@
 #ifndef SCENARIOS_SCENARIO_H_
 #define SCENARIOS_SCENARIO_H_
 
+#include <algorithm>
+
 namespace scenarios
 {
 
@@ -25,6 +27,36 @@ protected:
      * @param [in] hur THe momentum of the right wave vector
      */
     Scenario(unsigned int size, const T hl, const T hr, const T hul, const T hur) : m_size(size), m_hul(hul), m_hur(hur), m_hl(hl), m_hr(hr) {}
+
+    /**
+     * Fills the positions [begin, end) with the left state up to position size/2 and with the right
+     * state after it. Used by the scenarios which consist of two constant states.
+     */
+    void fillPiecewise(T *h, T *hu, T *b, unsigned int begin, unsigned int end, T hl, T hr, T hul, T hur)
+    {
+        const int numberOfChunks = end > begin ? (end - begin + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK : 0;
+        const unsigned int split = m_size / 2 + 1;
+#pragma omp parallel for schedule(static)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned int chunkBegin = begin + chunk * CELLS_PER_CHUNK;
+            unsigned int chunkEnd = std::min(chunkBegin + CELLS_PER_CHUNK, end);
+            unsigned int chunkSplit = std::min(std::max(split, chunkBegin), chunkEnd);
+            for (unsigned int i = chunkBegin; i < chunkSplit; i++)
+            {
+                h[i - begin] = hl;
+                hu[i - begin] = hul;
+            }
+            for (unsigned int i = chunkSplit; i < chunkEnd; i++)
+            {
+                h[i - begin] = hr;
+                hu[i - begin] = hur;
+            }
+            if (b)
+                std::fill(b + chunkBegin - begin, b + chunkEnd - begin, (T) 0);
+        }
+    }
+
     /** Number of cells */
     const unsigned int m_size;
     const T m_hul;
@@ -35,6 +67,15 @@ protected:
 public:
     //Scenario(unsigned int size) : m_size(size) { }
 
+    /**
+     * Number of cells which fill() initializes in one piece. Matches the chunks of
+     * FWave::computeNetUpdatesParallel, so every page is first touched by the thread which computes on it.
+     */
+    static const unsigned int CELLS_PER_CHUNK = 1024;
+
+    /** The maximum number of parameters of a scenario, see getParameters() */
+    static const unsigned int MAX_PARAMETERS = 8;
+
     /**
      * @return Initial water height at pos
      */
@@ -45,6 +86,123 @@ public:
      */
     virtual T getMomentum(unsigned int pos) = 0;
 
+    /**
+     * Extrudes the 1D scenario along the y axis, so every 1D scenario can be used on a 2D grid.
+     *
+     * @return Initial water height at the 2D position (x, y)
+     */
+    virtual T getHeight(unsigned int x, unsigned int /*y*/)
+    {
+        return getHeight(x);
+    }
+
+    /**
+     * @return Space time dependent momentum in x direction at the 2D position (x, y)
+     */
+    virtual T getMomentumX(unsigned int x, unsigned int /*y*/)
+    {
+        return getMomentum(x);
+    }
+
+    /**
+     * @return Space time dependent momentum in y direction at the 2D position (x, y)
+     */
+    virtual T getMomentumY(unsigned int /*x*/, unsigned int /*y*/)
+    {
+        return 0;
+    }
+
+    /**
+     * @return Bathymetry at pos, flat by default
+     */
+    virtual T getBathymetry(unsigned int /*pos*/)
+    {
+        return 0;
+    }
+
+    /**
+     * Initializes the positions [begin, end) in bulk, position begin goes to index 0 of the arrays.
+     *
+     * The positions are split into chunks of CELLS_PER_CHUNK cells which are distributed statically
+     * over the OpenMP threads. Called on freshly allocated arrays, the pages are first touched, and
+     * therefore placed on the NUMA node of, the thread which later computes on them with the same
+     * static schedule. The default implementation calls the per cell getters, the scenarios with
+     * two constant states fill their arrays with tight loops.
+     *
+     * @param [out] h The heights
+     * @param [out] hu The momentums
+     * @param [out] b The bathymetry or NULL if it is not needed
+     * @param [in] begin The first position
+     * @param [in] end One past the last position
+     */
+    virtual void fill(T *h, T *hu, T *b, unsigned int begin, unsigned int end)
+    {
+        const int numberOfChunks = end > begin ? (end - begin + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK : 0;
+#pragma omp parallel for schedule(static)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned int chunkBegin = begin + chunk * CELLS_PER_CHUNK;
+            unsigned int chunkEnd = std::min(chunkBegin + CELLS_PER_CHUNK, end);
+            for (unsigned int i = chunkBegin; i < chunkEnd; i++)
+            {
+                h[i - begin] = getHeight(i);
+                hu[i - begin] = getMomentum(i);
+                if (b)
+                    b[i - begin] = getBathymetry(i);
+            }
+        }
+    }
+
+    /**
+     * Same as fill(T*, T*, T*, unsigned int, unsigned int) for arrays which are stored in another type than T,
+     * e.g. the float arrays of solver::Precision<float, double>. Every value is converted from the per cell getters.
+     *
+     * @param [out] h The heights
+     * @param [out] hu The momentums
+     * @param [out] b The bathymetry or NULL if it is not needed
+     * @param [in] begin The first position
+     * @param [in] end One past the last position
+     */
+    template <typename Storage> void fill(Storage *h, Storage *hu, Storage *b, unsigned int begin, unsigned int end)
+    {
+        const int numberOfChunks = end > begin ? (end - begin + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK : 0;
+#pragma omp parallel for schedule(static)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++)
+        {
+            unsigned int chunkBegin = begin + chunk * CELLS_PER_CHUNK;
+            unsigned int chunkEnd = std::min(chunkBegin + CELLS_PER_CHUNK, end);
+            for (unsigned int i = chunkBegin; i < chunkEnd; i++)
+            {
+                h[i - begin] = getHeight(i);
+                hu[i - begin] = getMomentum(i);
+                if (b)
+                    b[i - begin] = getBathymetry(i);
+            }
+        }
+    }
+
+    /**
+     * @return Number of cells
+     */
+    unsigned int getSize() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @return The name of the scenario, e.g. to store it in a checkpoint
+     */
+    virtual const char *getName() const = 0;
+
+    /**
+     * Returns the parameters which define the initial values together with the name and the size, in the
+     * order of the arguments of the constructor of the scenario (without the size).
+     *
+     * @param [out] parameters The parameters
+     * @return The number of parameters, at most MAX_PARAMETERS
+     */
+    virtual unsigned int getParameters(double parameters[MAX_PARAMETERS]) const = 0;
+
     /**
      * @return Cell size of one cell (= domain size/number of cells)
      */
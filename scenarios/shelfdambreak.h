@@ -0,0 +1,75 @@
+#ifndef SCENARIOS_SHELFDAMBREAK_H_
+#define SCENARIOS_SHELFDAMBREAK_H_
+
+#include "scenario.h"
+
+namespace scenarios
+{
+
+/**
+ * A dam break like ExtendedDamBreak, but over a variable depth: a deep trench in the left
+ * three tenths of the domain rises linearly to a shallow shelf which covers the right six tenths.
+ * The surface is raised by 10 m in the left eighth of the domain and at rest everywhere else.
+ *
+ * The wave speeds in the trench and on the shelf differ by about sqrt(trenchDepth / shelfDepth),
+ * which makes this scenario a test case for local time stepping.
+ */
+class ShelfDamBreak : public Scenario<T>
+{
+
+public:
+
+    /**
+     * Constructor which will initialize the vector components using some default values.
+     */
+    ShelfDamBreak(unsigned int size) : Scenario(size, 4000, 50, 0, 0) { }
+
+    /**
+     * Constructor which defines the depths
+     * @param [in] trenchDepth The depth of the water at rest in the trench
+     * @param [in] shelfDepth The depth of the water at rest on the shelf
+     */
+    ShelfDamBreak(unsigned int size, const T trenchDepth, const T shelfDepth) : Scenario(size, trenchDepth, shelfDepth, 0, 0) { }
+
+    const char *getName() const
+    {
+        return "ShelfDamBreak";
+    }
+
+    unsigned int getParameters(double parameters[MAX_PARAMETERS]) const
+    {
+        parameters[0] = m_hl;
+        parameters[1] = m_hr;
+        return 2;
+    }
+
+    T getHeight(unsigned int pos)
+    {
+        T surface = pos <= m_size / 8 ? 10 : 0;
+        return surface - getBathymetry(pos);
+    }
+
+    T getMomentum(unsigned int /*pos*/)
+    {
+        return 0;
+    }
+
+    T getBathymetry(unsigned int pos)
+    {
+        T x = (T) pos / m_size;
+        if (x <= 0.3)
+            return -m_hl;
+        if (x >= 0.4)
+            return -m_hr;
+        return -m_hl + (m_hl - m_hr) * (x - 0.3) / 0.1;
+    }
+
+    T getCellSize()
+    {
+        return 300000.f / m_size;
+    }
+};
+
+}
+
+#endif /* SCENARIOS_SHELFDAMBREAK_H_ */